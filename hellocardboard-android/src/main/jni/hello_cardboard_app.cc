@@ -45,6 +45,10 @@ constexpr int kVelocityFilterCutoffFrequency = 6;
 
 constexpr uint64_t kPredictionTimeWithoutVsyncNanos = 50000000;
 
+// Pixel density of the eye textures relative to the one of the display at the
+// center of the lenses.
+constexpr float kRenderTargetQuality = 1.0f;
+
 // Angle threshold for determining whether the controller is pointing at the
 // object.
 constexpr float kAngleLimit = 0.2f;
@@ -89,6 +93,8 @@ HelloCardboardApp::HelloCardboardApp(JavaVM* vm, jobject obj,
       device_params_changed_(false),
       screen_width_(0),
       screen_height_(0),
+      eye_texture_width_(0),
+      eye_texture_height_(0),
       depthRenderBuffer_(0),
       framebuffer_(0),
       texture_(0),
@@ -196,8 +202,8 @@ void HelloCardboardApp::OnDrawFrame() {
 
   // Draw eyes views
   for (int eye = 0; eye < 2; ++eye) {
-    glViewport(eye == kLeft ? 0 : screen_width_ / 2, 0, screen_width_ / 2,
-               screen_height_);
+    glViewport(eye == kLeft ? 0 : eye_texture_width_, 0, eye_texture_width_,
+               eye_texture_height_);
 
     Matrix4x4 eye_matrix = GetMatrixFromGlArray(eye_matrices_[eye]);
     Matrix4x4 eye_view = eye_matrix * head_view_;
@@ -272,6 +278,12 @@ bool HelloCardboardApp::UpdateDeviceParams() {
 
   CardboardQrCode_destroy(buffer);
 
+  // Both eyes share the size, as their lenses are the mirror image of each
+  // other.
+  CardboardLensDistortion_getRecommendedRenderTargetSize(
+      lens_distortion_, kLeft, kRenderTargetQuality, &eye_texture_width_,
+      &eye_texture_height_);
+
   GlSetup();
 
   CardboardDistortionRenderer_destroy(distortion_renderer_);
@@ -322,8 +334,8 @@ void HelloCardboardApp::GlSetup() {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, screen_width_, screen_height_, 0,
-               GL_RGB, GL_UNSIGNED_BYTE, 0);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2 * eye_texture_width_,
+               eye_texture_height_, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
 
   left_eye_texture_description_.texture = texture_;
   left_eye_texture_description_.left_u = 0;
@@ -340,8 +352,8 @@ void HelloCardboardApp::GlSetup() {
   // Generate depth buffer to perform depth test.
   glGenRenderbuffers(1, &depthRenderBuffer_);
   glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer_);
-  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, screen_width_,
-                        screen_height_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16,
+                        2 * eye_texture_width_, eye_texture_height_);
   CHECKGLERROR("Create Render buffer");
 
   // Create render target.
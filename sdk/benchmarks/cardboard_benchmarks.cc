@@ -0,0 +1,444 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the hot paths of the platform independent core: distortion mesh
+// generation, distortion queries, sensor fusion updates and head pose queries.
+// Each benchmark reports the best time per operation over a few repetitions,
+// so that the numbers can be tracked over time.
+//
+// Usage:
+//   cardboard_benchmarks [filter]...
+//
+// Only the benchmarks whose name contains one of the filters are run, or all
+// of them if none is given.
+
+#include <algorithm>
+#include <array>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "distortion_mesh.h"
+#include "head_tracker.h"
+#include "include/cardboard.h"
+#include "lens_distortion.h"
+#include "polynomial_radial_distortion.h"
+#include "qrcode/cardboard_v1/cardboard_v1.h"
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+#include "sensors/sensor_fusion_ekf.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+#include "util/vectorutils.h"
+
+namespace cardboard {
+namespace {
+
+// Each benchmark runs its operation until kMinDurationNs have elapsed,
+// kRepetitions times.
+constexpr double kMinDurationNs = 2e8;
+constexpr int kRepetitions = 3;
+
+// Display of a typical phone in landscape.
+constexpr int kDisplayWidth = 2400;
+constexpr int kDisplayHeight = 1080;
+
+// Points per side of the grid of distortion queries.
+constexpr int kQueryGridSize = 64;
+
+// IMU rates of the sensor fusion benchmarks.
+constexpr int64_t kGyroscopePeriodNs = 2500000;  // 400 Hz.
+constexpr int kAccelerometerDecimation = 4;      // 100 Hz.
+constexpr double kGravity = 9.80665;
+
+// Time given to the head tracker to fuse samples from the host fake sensors
+// before its poses are queried.
+constexpr std::chrono::milliseconds kHeadTrackerWarmUp(300);
+constexpr int64_t kPredictionNs = 50000000;
+constexpr int kPosesPerBatch = 8;
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps benchmark results alive.
+volatile float g_sink;
+
+double ElapsedNs(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+// Calls @p operations repeatedly and returns the best time per operation in
+// nanoseconds. @p operations returns the number of operations it performed.
+double TimeOperations(const std::function<int64_t()>& operations) {
+  double best_ns = std::numeric_limits<double>::max();
+  for (int repetition = 0; repetition < kRepetitions; ++repetition) {
+    int64_t count = 0;
+    double elapsed_ns = 0.0;
+    const Clock::time_point start = Clock::now();
+    do {
+      count += operations();
+      elapsed_ns = ElapsedNs(start);
+    } while (elapsed_ns < kMinDurationNs);
+    best_ns = std::min(best_ns, elapsed_ns / count);
+  }
+  return best_ns;
+}
+
+std::vector<uint8_t> GetDeviceParams() {
+  return qrcode::getCardboardV1DeviceParams();
+}
+
+std::unique_ptr<PolynomialRadialDistortion> CreateDistortion() {
+  return std::unique_ptr<PolynomialRadialDistortion>(
+      new PolynomialRadialDistortion(std::vector<float>(
+          std::begin(qrcode::kCardboardV1DistortionCoeffs),
+          std::end(qrcode::kCardboardV1DistortionCoeffs))));
+}
+
+// Points in tan-angle units covering the field of view of a Cardboard v1.
+std::vector<std::array<float, 2>> GetQueryPoints() {
+  std::vector<std::array<float, 2>> points;
+  for (int i = 0; i < kQueryGridSize; ++i) {
+    for (int j = 0; j < kQueryGridSize; ++j) {
+      points.push_back({-0.8f + 1.6f * i / (kQueryGridSize - 1),
+                        -0.8f + 1.6f * j / (kQueryGridSize - 1)});
+    }
+  }
+  return points;
+}
+
+// --- Distortion meshes ---
+
+double BenchmarkLensDistortionCreate() {
+  const std::vector<uint8_t> params = GetDeviceParams();
+  return TimeOperations([&]() -> int64_t {
+    // Without the cache, this computes the field of view, the eye matrices
+    // and the default meshes of both eyes.
+    LensDistortion::ClearCache();
+    LensDistortion lens_distortion(params.data(), params.size(),
+                                   kDisplayWidth, kDisplayHeight);
+    g_sink = lens_distortion.GetDistortionMesh(kLeft).vertices[0];
+    return 1;
+  });
+}
+
+double BenchmarkLensDistortionCreateCached() {
+  const std::vector<uint8_t> params = GetDeviceParams();
+  LensDistortion::ClearCache();
+  return TimeOperations([&]() -> int64_t {
+    LensDistortion lens_distortion(params.data(), params.size(),
+                                   kDisplayWidth, kDisplayHeight);
+    g_sink = lens_distortion.GetDistortionMesh(kLeft).vertices[0];
+    return 1;
+  });
+}
+
+double BenchmarkMeshUniform(int resolution) {
+  const std::unique_ptr<PolynomialRadialDistortion> distortion =
+      CreateDistortion();
+  return TimeOperations([&]() -> int64_t {
+    const DistortionMesh mesh(*distortion, 1.6f, 1.6f, 0.8f, 0.8f, 1.6f, 1.6f,
+                              0.8f, 0.8f, resolution,
+                              DistortionMesh::Spacing::kUniform);
+    g_sink = mesh.GetMesh().vertices[0];
+    return 1;
+  });
+}
+
+double BenchmarkMeshUniform40() {
+  return BenchmarkMeshUniform(DistortionMesh::kDefaultResolution);
+}
+
+double BenchmarkMeshUniform128() {
+  return BenchmarkMeshUniform(DistortionMesh::kMaxResolution);
+}
+
+double BenchmarkMeshMaxError() {
+  const std::vector<uint8_t> params = GetDeviceParams();
+  LensDistortion lens_distortion(params.data(), params.size(), kDisplayWidth,
+                                 kDisplayHeight);
+  return TimeOperations([&]() -> int64_t {
+    // Rebuilds the meshes of both eyes with an adaptive grid.
+    lens_distortion.SetDistortionMeshMaxError(1.0f);
+    g_sink = lens_distortion.GetDistortionMesh(kLeft).vertices[0];
+    return 1;
+  });
+}
+
+// --- Distortion queries ---
+
+double BenchmarkDistort() {
+  const std::unique_ptr<PolynomialRadialDistortion> distortion =
+      CreateDistortion();
+  const std::vector<std::array<float, 2>> points = GetQueryPoints();
+  return TimeOperations([&]() -> int64_t {
+    float sum = 0.0f;
+    for (const std::array<float, 2>& point : points) {
+      sum += distortion->Distort(point)[0];
+    }
+    g_sink = sum;
+    return points.size();
+  });
+}
+
+double BenchmarkDistortInverse() {
+  const std::unique_ptr<PolynomialRadialDistortion> distortion =
+      CreateDistortion();
+  const std::vector<std::array<float, 2>> points = GetQueryPoints();
+  return TimeOperations([&]() -> int64_t {
+    float sum = 0.0f;
+    for (const std::array<float, 2>& point : points) {
+      sum += distortion->DistortInverse(point)[0];
+    }
+    g_sink = sum;
+    return points.size();
+  });
+}
+
+double BenchmarkUndistortedUv() {
+  const std::vector<uint8_t> params = GetDeviceParams();
+  const LensDistortion lens_distortion(params.data(), params.size(),
+                                       kDisplayWidth, kDisplayHeight);
+  std::vector<std::array<float, 2>> points = GetQueryPoints();
+  for (std::array<float, 2>& point : points) {
+    point = {0.5f + 0.5f * point[0], 0.5f + 0.5f * point[1]};
+  }
+  return TimeOperations([&]() -> int64_t {
+    float sum = 0.0f;
+    for (const std::array<float, 2>& point : points) {
+      sum += lens_distortion.UndistortedUvForDistortedUv(point, kLeft)[0];
+    }
+    g_sink = sum;
+    return points.size();
+  });
+}
+
+double BenchmarkUndistortedUvBatch() {
+  const std::vector<uint8_t> params = GetDeviceParams();
+  const LensDistortion lens_distortion(params.data(), params.size(),
+                                       kDisplayWidth, kDisplayHeight);
+  std::vector<float> u;
+  std::vector<float> v;
+  for (const std::array<float, 2>& point : GetQueryPoints()) {
+    u.push_back(0.5f + 0.5f * point[0]);
+    v.push_back(0.5f + 0.5f * point[1]);
+  }
+  std::vector<float> out_u(u.size());
+  std::vector<float> out_v(v.size());
+  return TimeOperations([&]() -> int64_t {
+    lens_distortion.UndistortedUvForDistortedUvBatch(
+        u.data(), v.data(), u.size(), kLeft, out_u.data(), out_v.data());
+    g_sink = out_u[0];
+    return u.size();
+  });
+}
+
+// --- Sensor fusion ---
+
+// Samples of a device spinning at a constant rate from an upright pose.
+struct ImuSamples {
+  std::vector<GyroscopeData> gyroscope;
+  std::vector<AccelerometerData> accelerometer;
+};
+
+ImuSamples GenerateImuSamples(int gyroscope_count) {
+  const Vector3 angular_velocity(0.3, 0.5, 0.1);
+  const double speed = Length(angular_velocity);
+  ImuSamples samples;
+  for (int i = 0; i < gyroscope_count; ++i) {
+    const uint64_t timestamp = (i + 1) * kGyroscopePeriodNs;
+    samples.gyroscope.push_back({timestamp, timestamp, angular_velocity});
+    if (i % kAccelerometerDecimation == 0) {
+      const Rotation sensor_from_start = Rotation::FromAxisAndAngle(
+          angular_velocity / speed, -speed * timestamp * 1e-9);
+      samples.accelerometer.push_back(
+          {timestamp, timestamp,
+           sensor_from_start * Vector3(0.0, 0.0, kGravity)});
+    }
+  }
+  return samples;
+}
+
+double BenchmarkEkfUpdates() {
+  // One minute of samples at 400 Hz and 100 Hz.
+  const ImuSamples samples = GenerateImuSamples(24000);
+  return TimeOperations([&]() -> int64_t {
+    SensorFusionEkf sensor_fusion;
+    size_t accelerometer_index = 0;
+    for (size_t i = 0; i < samples.gyroscope.size(); ++i) {
+      if (i % kAccelerometerDecimation == 0) {
+        sensor_fusion.ProcessAccelerometerSample(
+            samples.accelerometer[accelerometer_index++]);
+      }
+      sensor_fusion.ProcessGyroscopeSample(samples.gyroscope[i]);
+    }
+    g_sink = sensor_fusion.GetLatestRotationState()
+                 .sensor_from_start_rotation.GetQuaternion()[0];
+    return samples.gyroscope.size() + samples.accelerometer.size();
+  });
+}
+
+double BenchmarkEkfPredictRotation() {
+  SensorFusionEkf sensor_fusion;
+  const ImuSamples samples = GenerateImuSamples(400);
+  for (size_t i = 0; i < samples.gyroscope.size(); ++i) {
+    if (i % kAccelerometerDecimation == 0) {
+      sensor_fusion.ProcessAccelerometerSample(
+          samples.accelerometer[i / kAccelerometerDecimation]);
+    }
+    sensor_fusion.ProcessGyroscopeSample(samples.gyroscope[i]);
+  }
+  const int64_t timestamp =
+      samples.gyroscope.back().system_timestamp + kPredictionNs;
+  return TimeOperations([&]() -> int64_t {
+    float sum = 0.0f;
+    for (int i = 0; i < 1000; ++i) {
+      sum += sensor_fusion.PredictRotation(timestamp + i).GetQuaternion()[0];
+    }
+    g_sink = sum;
+    return 1000;
+  });
+}
+
+// --- Head tracker ---
+
+// Head tracker fed by the host fake sensors.
+class RunningHeadTracker {
+ public:
+  RunningHeadTracker() {
+    head_tracker_.Resume();
+    std::this_thread::sleep_for(kHeadTrackerWarmUp);
+  }
+  ~RunningHeadTracker() { head_tracker_.Pause(); }
+
+  HeadTracker& Get() { return head_tracker_; }
+
+ private:
+  HeadTracker head_tracker_;
+};
+
+double BenchmarkGetPose() {
+  RunningHeadTracker head_tracker;
+  std::array<float, 3> position;
+  std::array<float, 4> orientation;
+  return TimeOperations([&]() -> int64_t {
+    const int64_t timestamp = NowNs() + kPredictionNs;
+    for (int i = 0; i < 100; ++i) {
+      head_tracker.Get().GetPose(timestamp + i, kLandscapeLeft, position,
+                                 orientation);
+    }
+    g_sink = orientation[0] + position[0];
+    return 100;
+  });
+}
+
+double BenchmarkGetPoses() {
+  RunningHeadTracker head_tracker;
+  std::array<int64_t, kPosesPerBatch> timestamps;
+  std::array<float, 3 * kPosesPerBatch> positions;
+  std::array<float, 4 * kPosesPerBatch> orientations;
+  return TimeOperations([&]() -> int64_t {
+    const int64_t timestamp = NowNs() + kPredictionNs;
+    for (int i = 0; i < 100; ++i) {
+      for (int j = 0; j < kPosesPerBatch; ++j) {
+        timestamps[j] = timestamp + i + j * 1000000;
+      }
+      head_tracker.Get().GetPoses(timestamps.data(), kPosesPerBatch,
+                                  kLandscapeLeft, positions.data(),
+                                  orientations.data());
+    }
+    g_sink = orientations[0] + positions[0];
+    return 100 * kPosesPerBatch;
+  });
+}
+
+double BenchmarkGetPastPose() {
+  RunningHeadTracker head_tracker;
+  std::array<float, 3> position;
+  std::array<float, 4> orientation;
+  return TimeOperations([&]() -> int64_t {
+    const int64_t timestamp = NowNs() - 2 * kPredictionNs;
+    for (int i = 0; i < 100; ++i) {
+      head_tracker.Get().GetPastPose(timestamp + i, kLandscapeLeft, position,
+                                     orientation);
+    }
+    g_sink = orientation[0] + position[0];
+    return 100;
+  });
+}
+
+struct Benchmark {
+  const char* name;
+  const char* unit;
+  double (*function)();
+};
+
+constexpr Benchmark kBenchmarks[] = {
+    {"lens_distortion/create", "instance", BenchmarkLensDistortionCreate},
+    {"lens_distortion/create_cached", "instance",
+     BenchmarkLensDistortionCreateCached},
+    {"mesh/uniform_40", "mesh", BenchmarkMeshUniform40},
+    {"mesh/uniform_128", "mesh", BenchmarkMeshUniform128},
+    {"mesh/max_error_1px", "2 meshes", BenchmarkMeshMaxError},
+    {"distortion/distort", "point", BenchmarkDistort},
+    {"distortion/distort_inverse", "point", BenchmarkDistortInverse},
+    {"distortion/undistorted_uv", "point", BenchmarkUndistortedUv},
+    {"distortion/undistorted_uv_batch", "point", BenchmarkUndistortedUvBatch},
+    {"ekf/updates", "sample", BenchmarkEkfUpdates},
+    {"ekf/predict_rotation", "call", BenchmarkEkfPredictRotation},
+    {"head_tracker/get_pose", "pose", BenchmarkGetPose},
+    {"head_tracker/get_poses", "pose", BenchmarkGetPoses},
+    {"head_tracker/get_past_pose", "pose", BenchmarkGetPastPose},
+};
+
+bool IsSelected(const std::string& name, int filter_count,
+                char** filters) {
+  if (filter_count == 0) {
+    return true;
+  }
+  return std::any_of(filters, filters + filter_count, [&](const char* filter) {
+    return name.find(filter) != std::string::npos;
+  });
+}
+
+}  // namespace
+}  // namespace cardboard
+
+int main(int argc, char** argv) {
+  printf("%-34s %14s\n", "benchmark", "ns/op");
+  for (const cardboard::Benchmark& benchmark : cardboard::kBenchmarks) {
+    if (!cardboard::IsSelected(benchmark.name, argc - 1, argv + 1)) {
+      continue;
+    }
+    const double ns = benchmark.function();
+    printf("%-34s %14.1f  per %s\n", benchmark.name, ns, benchmark.unit);
+    fflush(stdout);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays IMU traces through SensorFusionEkf as fast as possible and reports
+// the fusion throughput, the per-sample processing latency and, when the trace
+// has ground truth records, the orientation error of the fused pose.
+//
+// Usage:
+//   imu_fusion_benchmark                      Benchmarks a synthetic trace.
+//   imu_fusion_benchmark <trace>...           Benchmarks the given traces.
+//   imu_fusion_benchmark --generate <trace> [seconds]
+//                                             Writes a synthetic trace with
+//                                             ground truth.
+//   imu_fusion_benchmark --generate-head-turns <trace> [seconds]
+//                                             Same, with head turns, e.g. for
+//                                             pose_prediction_evaluation.
+//
+// Passing --numeric-jacobian before the traces computes the accelerometer
+// measurement Jacobian by finite differences instead of in closed form.
+//
+// Traces can be recorded on a device with
+// CardboardHeadTracker_startTraceRecording().
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sensors/imu_trace.h"
+#include "sensors/sensor_fusion_ekf.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+#include "util/vectorutils.h"
+
+namespace cardboard {
+namespace {
+
+constexpr double kGravity = 9.80665;
+constexpr double kRadiansToDegrees = 180.0 / M_PI;
+
+// Synthetic trace parameters.
+constexpr double kDefaultSyntheticDurationS = 60.0;
+constexpr int64_t kAccelerometerPeriodNs = 10000000;  // 100 Hz.
+constexpr int64_t kGyroscopePeriodNs = 2500000;       // 400 Hz.
+constexpr int kGroundTruthDecimation = 4;  // One every 4 gyroscope samples.
+constexpr int kIntegrationSubsteps = 16;
+constexpr double kGyroscopeNoiseSigma = 0.005;      // rad/s.
+constexpr double kAccelerometerNoiseSigma = 0.05;   // m/s^2.
+const Vector3 kGyroscopeBias(0.002, -0.003, 0.001);  // rad/s.
+constexpr uint64_t kSyntheticStartTimestampNs = 1000000000;
+// Head turns of the kHeadTurns motion.
+constexpr double kHeadTurnAngle = M_PI / 3.0;  // 60 degrees.
+constexpr double kHeadTurnDurationS = 0.35;
+constexpr double kHeadTurnPeriodS = 1.0;
+
+// Head motions of the synthetic traces.
+enum class SyntheticMotion {
+  // Slow sinusoidal rotation around the three axes.
+  kSmooth,
+  // Turns of kHeadTurnAngle around the y axis, alternately in each direction,
+  // that start every kHeadTurnPeriodS and last kHeadTurnDurationS, over a slow
+  // sinusoidal rotation around the other axes. The turns follow a minimum
+  // jerk profile, so the angular velocity starts and stops smoothly.
+  kHeadTurns,
+};
+
+// Upper bounds of the latency histogram buckets in nanoseconds. The last
+// bucket collects everything above.
+constexpr int64_t kHistogramBucketsNs[] = {125,  250,  500,   1000,  2000,
+                                           4000, 8000, 16000, 32000, 64000};
+constexpr int kHistogramBucketCount =
+    sizeof(kHistogramBucketsNs) / sizeof(kHistogramBucketsNs[0]) + 1;
+
+// Angular velocity of the synthetic head @p motion at @p time_s, in the
+// sensor frame.
+Vector3 GetSyntheticAngularVelocity(SyntheticMotion motion, double time_s) {
+  if (motion == SyntheticMotion::kSmooth) {
+    return Vector3(0.8 * std::sin(2.0 * M_PI * 0.31 * time_s),
+                   1.2 * std::sin(2.0 * M_PI * 0.17 * time_s + 1.0),
+                   0.4 * std::cos(2.0 * M_PI * 0.53 * time_s));
+  }
+
+  // A minimum jerk turn of angle A and duration T has an angular velocity of
+  // 30 A / T u^2 (1 - u)^2, with u = t / T.
+  const double turn_time_s = std::fmod(time_s, kHeadTurnPeriodS);
+  double turn_velocity = 0.0;
+  if (turn_time_s < kHeadTurnDurationS) {
+    const double u = turn_time_s / kHeadTurnDurationS;
+    const double direction =
+        static_cast<int64_t>(time_s / kHeadTurnPeriodS) % 2 == 0 ? 1.0 : -1.0;
+    turn_velocity = direction * 30.0 * kHeadTurnAngle / kHeadTurnDurationS *
+                    u * u * (1.0 - u) * (1.0 - u);
+  }
+  return Vector3(0.2 * std::sin(time_s), turn_velocity,
+                 0.1 * std::cos(0.7 * time_s));
+}
+
+// Integrates the angular velocity over @p duration_s, following the
+// convention of the gyroscope integration in SensorFusionEkf.
+Rotation Integrate(SyntheticMotion motion, const Rotation& sensor_from_start,
+                   double start_s, double duration_s) {
+  Rotation result = sensor_from_start;
+  const double step_s = duration_s / kIntegrationSubsteps;
+  for (int i = 0; i < kIntegrationSubsteps; ++i) {
+    const Vector3 velocity =
+        GetSyntheticAngularVelocity(motion, start_s + (i + 0.5) * step_s);
+    const double speed = Length(velocity);
+    if (speed > 0.0) {
+      result = Rotation::FromAxisAndAngle(velocity / speed, -speed * step_s) *
+               result;
+    }
+  }
+  return result;
+}
+
+// Generates a trace of a device following the synthetic head @p motion, with
+// noisy and biased sensors.
+std::vector<ImuTraceRecord> GenerateSyntheticTrace(SyntheticMotion motion,
+                                                   double duration_s) {
+  std::mt19937 generator(1234);
+  std::normal_distribution<double> gyroscope_noise(0.0, kGyroscopeNoiseSigma);
+  std::normal_distribution<double> accelerometer_noise(
+      0.0, kAccelerometerNoiseSigma);
+
+  std::vector<ImuTraceRecord> records;
+  Rotation sensor_from_start = Rotation::Identity();
+  const int64_t duration_ns = static_cast<int64_t>(duration_s * 1e9);
+  for (int64_t gyroscope_index = 0;
+       gyroscope_index * kGyroscopePeriodNs <= duration_ns; ++gyroscope_index) {
+    const int64_t elapsed_ns = gyroscope_index * kGyroscopePeriodNs;
+    const double time_s = elapsed_ns * 1e-9;
+    if (gyroscope_index > 0) {
+      sensor_from_start = Integrate(motion, sensor_from_start,
+                                    time_s - kGyroscopePeriodNs * 1e-9,
+                                    kGyroscopePeriodNs * 1e-9);
+    }
+
+    ImuTraceRecord record;
+    record.timestamp_ns = kSyntheticStartTimestampNs + elapsed_ns;
+    if (elapsed_ns % kAccelerometerPeriodNs == 0) {
+      record.type = ImuTraceRecord::Type::kAccelerometer;
+      record.data = sensor_from_start * Vector3(0.0, 0.0, kGravity) +
+                    Vector3(accelerometer_noise(generator),
+                            accelerometer_noise(generator),
+                            accelerometer_noise(generator));
+      records.push_back(record);
+    }
+
+    record.type = ImuTraceRecord::Type::kGyroscope;
+    record.data =
+        GetSyntheticAngularVelocity(motion, time_s) + kGyroscopeBias +
+        Vector3(gyroscope_noise(generator), gyroscope_noise(generator),
+                gyroscope_noise(generator));
+    records.push_back(record);
+
+    if (gyroscope_index % kGroundTruthDecimation == 0) {
+      record.type = ImuTraceRecord::Type::kGroundTruth;
+      record.sensor_from_start_rotation = sensor_from_start;
+      records.push_back(record);
+    }
+  }
+  return records;
+}
+
+bool ReadTrace(const std::string& path, std::vector<ImuTraceRecord>* records) {
+  ImuTraceReader reader;
+  if (!reader.Open(path)) {
+    return false;
+  }
+  ImuTraceRecord record;
+  while (reader.ReadNext(&record)) {
+    records->push_back(record);
+  }
+  // Sensor threads may record slightly out of order.
+  std::stable_sort(records->begin(), records->end(),
+                   [](const ImuTraceRecord& a, const ImuTraceRecord& b) {
+                     return a.timestamp_ns < b.timestamp_ns;
+                   });
+  return true;
+}
+
+bool WriteTrace(const std::string& path,
+                const std::vector<ImuTraceRecord>& records) {
+  ImuTraceWriter writer;
+  if (!writer.Open(path)) {
+    return false;
+  }
+  for (const ImuTraceRecord& record : records) {
+    switch (record.type) {
+      case ImuTraceRecord::Type::kAccelerometer:
+        writer.Write(record.ToAccelerometerData());
+        break;
+      case ImuTraceRecord::Type::kGyroscope:
+        writer.Write(record.ToGyroscopeData());
+        break;
+      case ImuTraceRecord::Type::kGroundTruth:
+        writer.WriteGroundTruth(record.timestamp_ns,
+                                record.sensor_from_start_rotation);
+        break;
+    }
+  }
+  writer.Close();
+  return true;
+}
+
+double GetAngle(const Rotation& rotation) {
+  Vector3 axis;
+  double angle;
+  rotation.GetAxisAndAngle(&axis, &angle);
+  return angle;
+}
+
+// Angle between the down directions of two sensor from start rotations, i.e.
+// the error that the accelerometer can observe.
+double GetTiltAngle(const Rotation& a, const Rotation& b) {
+  const Vector3 down_a = a * Vector3(0.0, 0.0, 1.0);
+  const Vector3 down_b = b * Vector3(0.0, 0.0, 1.0);
+  return std::acos(std::max(-1.0, std::min(1.0, Dot(down_a, down_b))));
+}
+
+int64_t GetPercentile(const std::vector<int64_t>& sorted_values,
+                      double percentile) {
+  if (sorted_values.empty()) {
+    return 0;
+  }
+  const size_t index = std::min(
+      sorted_values.size() - 1,
+      static_cast<size_t>(percentile / 100.0 * sorted_values.size()));
+  return sorted_values[index];
+}
+
+void Benchmark(const std::string& name,
+               const std::vector<ImuTraceRecord>& records,
+               SensorFusionEkf::JacobianMode jacobian_mode) {
+  SensorFusionEkf sensor_fusion;
+  sensor_fusion.SetMeasurementJacobianMode(jacobian_mode);
+  std::vector<int64_t> latencies_ns;
+  latencies_ns.reserve(records.size());
+
+  bool is_aligned = false;
+  bool has_ground_truth_offset = false;
+  // Constant rotation from the EKF start space to the ground truth start
+  // space. The EKF starts with an arbitrary yaw.
+  Rotation start_offset = Rotation::Identity();
+  int ground_truth_count = 0;
+  double sum_squared_error = 0.0;
+  double max_error = 0.0;
+  double final_error = 0.0;
+  double max_tilt_error = 0.0;
+  double final_tilt_error = 0.0;
+
+  for (const ImuTraceRecord& record : records) {
+    if (record.type == ImuTraceRecord::Type::kGroundTruth) {
+      if (!is_aligned) {
+        continue;
+      }
+      const Rotation fused =
+          sensor_fusion.GetLatestRotationState().sensor_from_start_rotation;
+      const Rotation& ground_truth = record.sensor_from_start_rotation;
+      if (!has_ground_truth_offset) {
+        start_offset = -ground_truth * fused;
+        has_ground_truth_offset = true;
+      }
+      const double error = GetAngle(fused * -(ground_truth * start_offset));
+      const double tilt_error = GetTiltAngle(fused, ground_truth);
+      ++ground_truth_count;
+      sum_squared_error += error * error;
+      max_error = std::max(max_error, error);
+      final_error = error;
+      max_tilt_error = std::max(max_tilt_error, tilt_error);
+      final_tilt_error = tilt_error;
+      continue;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (record.type == ImuTraceRecord::Type::kAccelerometer) {
+      sensor_fusion.ProcessAccelerometerSample(record.ToAccelerometerData());
+      is_aligned = true;
+    } else {
+      sensor_fusion.ProcessGyroscopeSample(record.ToGyroscopeData());
+    }
+    const auto end = std::chrono::steady_clock::now();
+    latencies_ns.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+  }
+
+  int64_t total_ns = 0;
+  int64_t histogram[kHistogramBucketCount] = {};
+  for (int64_t latency_ns : latencies_ns) {
+    total_ns += latency_ns;
+    int bucket = 0;
+    while (bucket < kHistogramBucketCount - 1 &&
+           latency_ns > kHistogramBucketsNs[bucket]) {
+      ++bucket;
+    }
+    ++histogram[bucket];
+  }
+  std::sort(latencies_ns.begin(), latencies_ns.end());
+
+  printf("%s\n", name.c_str());
+  printf("  samples:           %zu\n", latencies_ns.size());
+  printf("  throughput:        %.0f samples/s\n",
+         total_ns > 0 ? latencies_ns.size() * 1e9 / total_ns : 0.0);
+  printf("  latency (ns):      p50 %lld  p90 %lld  p99 %lld  max %lld\n",
+         static_cast<long long>(GetPercentile(latencies_ns, 50.0)),
+         static_cast<long long>(GetPercentile(latencies_ns, 90.0)),
+         static_cast<long long>(GetPercentile(latencies_ns, 99.0)),
+         static_cast<long long>(
+             latencies_ns.empty() ? 0 : latencies_ns.back()));
+  printf("  latency histogram:\n");
+  for (int bucket = 0; bucket < kHistogramBucketCount; ++bucket) {
+    if (bucket < kHistogramBucketCount - 1) {
+      printf("    <= %6lld ns: %lld\n",
+             static_cast<long long>(kHistogramBucketsNs[bucket]),
+             static_cast<long long>(histogram[bucket]));
+    } else {
+      printf("     > %6lld ns: %lld\n",
+             static_cast<long long>(kHistogramBucketsNs[bucket - 1]),
+             static_cast<long long>(histogram[bucket]));
+    }
+  }
+  if (ground_truth_count > 0) {
+    printf("  orientation error: rms %.3f deg  max %.3f deg  final %.3f deg\n",
+           std::sqrt(sum_squared_error / ground_truth_count) *
+               kRadiansToDegrees,
+           max_error * kRadiansToDegrees, final_error * kRadiansToDegrees);
+    printf("  tilt error:        max %.3f deg  final %.3f deg\n",
+           max_tilt_error * kRadiansToDegrees,
+           final_tilt_error * kRadiansToDegrees);
+  } else {
+    printf("  orientation error: no ground truth in trace\n");
+  }
+}
+
+}  // namespace
+}  // namespace cardboard
+
+int main(int argc, char** argv) {
+  using cardboard::ImuTraceRecord;
+  using cardboard::SensorFusionEkf;
+
+  SensorFusionEkf::JacobianMode jacobian_mode =
+      SensorFusionEkf::JacobianMode::kAnalytic;
+  if (argc >= 2 && std::string(argv[1]) == "--numeric-jacobian") {
+    jacobian_mode = SensorFusionEkf::JacobianMode::kNumeric;
+    --argc;
+    ++argv;
+  }
+
+  if (argc >= 3 && (std::string(argv[1]) == "--generate" ||
+                    std::string(argv[1]) == "--generate-head-turns")) {
+    const cardboard::SyntheticMotion motion =
+        std::string(argv[1]) == "--generate"
+            ? cardboard::SyntheticMotion::kSmooth
+            : cardboard::SyntheticMotion::kHeadTurns;
+    const double duration_s =
+        argc >= 4 ? std::atof(argv[3])
+                  : cardboard::kDefaultSyntheticDurationS;
+    if (!cardboard::WriteTrace(
+            argv[2], cardboard::GenerateSyntheticTrace(motion, duration_s))) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (argc == 1) {
+    cardboard::Benchmark(
+        "synthetic",
+        cardboard::GenerateSyntheticTrace(
+            cardboard::SyntheticMotion::kSmooth,
+            cardboard::kDefaultSyntheticDurationS),
+        jacobian_mode);
+    return EXIT_SUCCESS;
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    std::vector<ImuTraceRecord> records;
+    if (!cardboard::ReadTrace(argv[i], &records)) {
+      return EXIT_FAILURE;
+    }
+    cardboard::Benchmark(argv[i], records, jacobian_mode);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the double precision math types with their single precision
+// variants, on the kernels that have SIMD versions and on a loop that performs
+// the same operations as the SensorFusionEkf prediction and accelerometer
+// update steps. For the single precision loop it also reports how far the
+// orientation drifts from the double precision one.
+//
+// Usage:
+//   math_benchmark
+//
+// Build with -DCARDBOARD_DISABLE_SIMD to measure the scalar single precision
+// kernels instead of the SSE or NEON ones.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "util/math_kernels.h"
+#include "util/matrix_3x3.h"
+#include "util/matrixutils.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+#include "util/vectorutils.h"
+
+namespace cardboard {
+namespace {
+
+constexpr double kRadiansToDegrees = 180.0 / M_PI;
+
+// Number of operands of the kernel benchmarks and number of passes over them.
+constexpr int kKernelOperandCount = 1024;
+constexpr int kKernelPasses = 2000;
+
+// Parameters of the EKF update loop.
+constexpr double kDurationS = 60.0;
+constexpr double kGyroscopeTimestepS = 0.0025;  // 400 Hz.
+constexpr int kAccelerometerDecimation = 4;    // 100 Hz.
+constexpr double kGravity = 9.80665;
+constexpr double kGyroscopeNoiseSigma = 0.005;     // rad/s.
+constexpr double kAccelerometerNoiseSigma = 0.05;  // m/s^2.
+constexpr double kProcessCovarianceValue = 1e-6;
+constexpr double kAccelerometerCovarianceValue = 0.25;
+constexpr int kLoopRepetitions = 5;
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedNs(Clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+// IMU readings of a device following a smooth synthetic head motion.
+struct ImuSamples {
+  std::vector<Vector3> gyroscope;
+  std::vector<Vector3> accelerometer;
+  std::vector<Rotation> ground_truth;
+};
+
+ImuSamples GenerateSamples() {
+  std::mt19937 generator(1234);
+  std::normal_distribution<double> gyroscope_noise(0.0, kGyroscopeNoiseSigma);
+  std::normal_distribution<double> accelerometer_noise(
+      0.0, kAccelerometerNoiseSigma);
+
+  ImuSamples samples;
+  Rotation sensor_from_start = Rotation::Identity();
+  const int count = static_cast<int>(kDurationS / kGyroscopeTimestepS);
+  for (int i = 0; i < count; ++i) {
+    const double time_s = i * kGyroscopeTimestepS;
+    const Vector3 velocity(0.8 * std::sin(2.0 * M_PI * 0.31 * time_s),
+                           1.2 * std::sin(2.0 * M_PI * 0.17 * time_s + 1.0),
+                           0.4 * std::cos(2.0 * M_PI * 0.53 * time_s));
+    const double speed = Length(velocity);
+    sensor_from_start = Rotation::FromAxisAndAngle(
+                            velocity / speed, -speed * kGyroscopeTimestepS) *
+                        sensor_from_start;
+    samples.gyroscope.push_back(
+        velocity + Vector3(gyroscope_noise(generator),
+                           gyroscope_noise(generator),
+                           gyroscope_noise(generator)));
+    samples.accelerometer.push_back(
+        sensor_from_start * Vector3(0.0, 0.0, kGravity) +
+        Vector3(accelerometer_noise(generator), accelerometer_noise(generator),
+                accelerometer_noise(generator)));
+    samples.ground_truth.push_back(sensor_from_start);
+  }
+  return samples;
+}
+
+template <typename T>
+Matrix3x3T<T> CrossProductMatrix(const Vector<3, T>& v) {
+  return Matrix3x3T<T>(0, -v[2], v[1], v[2], 0, -v[0], -v[1], v[0], 0);
+}
+
+// Runs the prediction step for every gyroscope sample and the accelerometer
+// update for every kAccelerometerDecimation-th one, with the same operations
+// as SensorFusionEkf. The measurement Jacobian is its small angle form.
+// Returns the orientation after every sample in @p trajectory.
+template <typename T>
+void RunEkfUpdateLoop(const std::vector<Vector<3, T>>& gyroscope,
+                      const std::vector<Vector<3, T>>& accelerometer,
+                      std::vector<RotationT<T>>* trajectory) {
+  const Vector<3, T> canonical_z(0, 0, 1);
+  const Matrix3x3T<T> identity = Matrix3x3T<T>::Identity();
+  const Matrix3x3T<T> process_covariance =
+      identity * static_cast<T>(kProcessCovarianceValue);
+  const Matrix3x3T<T> accelerometer_covariance =
+      identity * static_cast<T>(kAccelerometerCovarianceValue);
+  const T timestep = static_cast<T>(kGyroscopeTimestepS);
+
+  RotationT<T> sensor_from_start;
+  Matrix3x3T<T> state_covariance = identity * static_cast<T>(0.25);
+  for (size_t i = 0; i < gyroscope.size(); ++i) {
+    // Prediction.
+    const T speed = Length(gyroscope[i]);
+    const RotationT<T> motion = RotationT<T>::FromAxisAndAngle(
+        gyroscope[i] / speed, -speed * timestep);
+    sensor_from_start = motion * sensor_from_start;
+    const Matrix3x3T<T> motion_matrix = RotationMatrixNH(motion);
+    state_covariance = motion_matrix * state_covariance *
+                           Transpose(motion_matrix) +
+                       process_covariance;
+
+    // Accelerometer update.
+    if (i % kAccelerometerDecimation == 0) {
+      const Vector<3, T> predicted_down = sensor_from_start * canonical_z;
+      const Vector<3, T> measured_down = Normalized(accelerometer[i]);
+      Vector<3, T> axis;
+      T angle;
+      RotationT<T>::RotateInto(predicted_down, measured_down)
+          .GetAxisAndAngle(&axis, &angle);
+      const Vector<3, T> innovation = axis * angle;
+      const Matrix3x3T<T> jacobian = -CrossProductMatrix(measured_down) *
+                                     CrossProductMatrix(predicted_down);
+      const Matrix3x3T<T> jacobian_transpose = Transpose(jacobian);
+      const Matrix3x3T<T> innovation_covariance =
+          jacobian * state_covariance * jacobian_transpose +
+          accelerometer_covariance;
+      const Matrix3x3T<T> kalman_gain = state_covariance * jacobian_transpose *
+                                        Inverse(innovation_covariance);
+      const Vector<3, T> state_update = kalman_gain * innovation;
+      state_covariance =
+          (identity - kalman_gain * jacobian) * state_covariance;
+      const T update_angle = Length(state_update);
+      if (update_angle > 0) {
+        const RotationT<T> update = RotationT<T>::FromAxisAndAngle(
+            state_update / update_angle, update_angle);
+        sensor_from_start = update * sensor_from_start;
+        const Matrix3x3T<T> update_matrix = RotationMatrixNH(update);
+        state_covariance =
+            update_matrix * state_covariance * Transpose(update_matrix);
+      }
+    }
+    (*trajectory)[i] = sensor_from_start;
+  }
+}
+
+template <typename T>
+std::vector<Vector<3, T>> Convert(const std::vector<Vector3>& values) {
+  std::vector<Vector<3, T>> result;
+  result.reserve(values.size());
+  for (const Vector3& value : values) {
+    result.emplace_back(value);
+  }
+  return result;
+}
+
+// Returns the best time per sample of the EKF update loop in nanoseconds.
+template <typename T>
+double BenchmarkEkfUpdateLoop(const ImuSamples& samples,
+                              std::vector<RotationT<T>>* trajectory) {
+  const std::vector<Vector<3, T>> gyroscope = Convert<T>(samples.gyroscope);
+  const std::vector<Vector<3, T>> accelerometer =
+      Convert<T>(samples.accelerometer);
+  trajectory->resize(gyroscope.size());
+  double best_ns = 0.0;
+  for (int i = 0; i < kLoopRepetitions; ++i) {
+    const Clock::time_point start = Clock::now();
+    RunEkfUpdateLoop(gyroscope, accelerometer, trajectory);
+    const double elapsed_ns = ElapsedNs(start);
+    best_ns = i == 0 ? elapsed_ns : std::min(best_ns, elapsed_ns);
+  }
+  return best_ns / gyroscope.size();
+}
+
+double GetAngleBetween(const Rotation& a, const Rotation& b) {
+  Vector3 axis;
+  double angle;
+  (-a * b).GetAxisAndAngle(&axis, &angle);
+  return std::min(angle, 2.0 * M_PI - angle);
+}
+
+// Operands of the kernel benchmarks.
+template <typename T>
+struct KernelOperands {
+  std::vector<RotationT<T>> rotations;
+  std::vector<Vector<3, T>> vectors;
+  std::vector<Matrix3x3T<T>> matrices;
+};
+
+template <typename T>
+KernelOperands<T> GenerateOperands() {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  KernelOperands<T> operands;
+  for (int i = 0; i < kKernelOperandCount; ++i) {
+    const Vector3 axis(distribution(generator), distribution(generator),
+                       distribution(generator));
+    operands.rotations.emplace_back(
+        Rotation::FromAxisAndAngle(axis, M_PI * distribution(generator)));
+    operands.vectors.emplace_back(axis);
+    operands.matrices.push_back(RotationMatrixNH(operands.rotations.back()));
+  }
+  return operands;
+}
+
+// Runs @p kernel over all operands kKernelPasses times and returns the time
+// per call in nanoseconds.
+template <typename Kernel>
+double TimeKernel(Kernel kernel) {
+  const Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < kKernelPasses; ++pass) {
+    for (int i = 0; i < kKernelOperandCount; ++i) {
+      kernel(i);
+    }
+  }
+  return ElapsedNs(start) / (static_cast<double>(kKernelPasses) *
+                             kKernelOperandCount);
+}
+
+struct KernelTimes {
+  double quaternion_product_ns;
+  double rotate_vector_ns;
+  double matrix_product_ns;
+};
+
+template <typename T>
+KernelTimes BenchmarkKernels() {
+  const KernelOperands<T> operands = GenerateOperands<T>();
+  const int last = kKernelOperandCount - 1;
+  KernelTimes times;
+
+  RotationT<T> rotation;
+  times.quaternion_product_ns = TimeKernel([&](int i) {
+    rotation = operands.rotations[i] * operands.rotations[last - i];
+  });
+  Vector<3, T> vector;
+  times.rotate_vector_ns = TimeKernel([&](int i) {
+    vector += operands.rotations[i] * operands.vectors[last - i];
+  });
+  Matrix3x3T<T> matrix;
+  times.matrix_product_ns = TimeKernel([&](int i) {
+    matrix = matrix + operands.matrices[i] * operands.matrices[last - i];
+  });
+
+  // Keeps the results alive.
+  volatile T sink = rotation.GetQuaternion()[0] + vector[0] + matrix(0, 0);
+  (void)sink;
+  return times;
+}
+
+void Run() {
+  printf("single precision kernels: %s\n",
+         kMathSimdEnabled ? "SIMD" : "scalar");
+
+  const KernelTimes double_times = BenchmarkKernels<double>();
+  const KernelTimes float_times = BenchmarkKernels<float>();
+  printf("kernels (ns/call)        double     float   speedup\n");
+  printf("  quaternion product   %8.2f  %8.2f  %7.2fx\n",
+         double_times.quaternion_product_ns, float_times.quaternion_product_ns,
+         double_times.quaternion_product_ns /
+             float_times.quaternion_product_ns);
+  printf("  rotate vector        %8.2f  %8.2f  %7.2fx\n",
+         double_times.rotate_vector_ns, float_times.rotate_vector_ns,
+         double_times.rotate_vector_ns / float_times.rotate_vector_ns);
+  printf("  3x3 matrix product   %8.2f  %8.2f  %7.2fx\n",
+         double_times.matrix_product_ns, float_times.matrix_product_ns,
+         double_times.matrix_product_ns / float_times.matrix_product_ns);
+
+  const ImuSamples samples = GenerateSamples();
+  std::vector<Rotation> double_trajectory;
+  std::vector<Rotationf> float_trajectory;
+  const double double_ns =
+      BenchmarkEkfUpdateLoop(samples, &double_trajectory);
+  const double float_ns = BenchmarkEkfUpdateLoop(samples, &float_trajectory);
+
+  double max_drift = 0.0;
+  double max_double_error = 0.0;
+  double max_float_error = 0.0;
+  // Skips the first second, while the filter converges from the arbitrary
+  // initial orientation.
+  const size_t first = static_cast<size_t>(1.0 / kGyroscopeTimestepS);
+  for (size_t i = first; i < double_trajectory.size(); ++i) {
+    const Rotation float_rotation(float_trajectory[i]);
+    max_drift = std::max(
+        max_drift, GetAngleBetween(double_trajectory[i], float_rotation));
+    const Rotation& ground_truth = samples.ground_truth[i];
+    max_double_error = std::max(
+        max_double_error, GetAngleBetween(double_trajectory[i], ground_truth));
+    max_float_error = std::max(max_float_error,
+                               GetAngleBetween(float_rotation, ground_truth));
+  }
+
+  printf("EKF update loop (%zu samples)\n", double_trajectory.size());
+  printf("  time (ns/sample)     %8.1f  %8.1f  %7.2fx\n", double_ns, float_ns,
+         double_ns / float_ns);
+  printf("  max error (deg)      %8.4f  %8.4f\n",
+         max_double_error * kRadiansToDegrees,
+         max_float_error * kRadiansToDegrees);
+  printf("  max float drift from double: %.6f deg\n",
+         max_drift * kRadiansToDegrees);
+}
+
+}  // namespace
+}  // namespace cardboard
+
+int main() {
+  cardboard::Run();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays IMU traces through SensorFusionEkf and, after every gyroscope
+// sample, predicts the rotation 20, 40 and 60 ms ahead with each prediction
+// model.
+//
+// When the trace has ground truth records, predictions are made at the
+// samples that have one and compared with the ground truth of the first
+// record at or after the horizon. The comparison is on the motion from the
+// prediction time, i.e. the rotation from the fused orientation to the
+// prediction against the ground truth rotation over the same interval, since
+// the fusion starts with an arbitrary yaw and drifts. Otherwise, predictions
+// are compared with the rotation that the fusion reports once it has actually
+// processed the samples up to that time, which isolates the prediction error
+// from the fusion error.
+//
+// Errors are reported over all samples and over transients, i.e. samples
+// after which the angular velocity changes by more than
+// kTransientVelocityChange within the horizon, such as the start and the end
+// of head turns.
+//
+// Usage:
+//   pose_prediction_evaluation [options] <trace>...
+//
+// Options, which tune the constant acceleration model:
+//   --max-horizon <seconds>
+//   --acceleration-time-constant <seconds>
+//   --max-angular-acceleration <rad/s^2>
+//
+// Traces can be recorded on a device with
+// CardboardHeadTracker_startTraceRecording() or generated with
+// imu_fusion_benchmark --generate or --generate-head-turns.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sensors/imu_trace.h"
+#include "sensors/sensor_fusion_ekf.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+#include "util/vectorutils.h"
+
+namespace cardboard {
+namespace {
+
+constexpr double kRadiansToDegrees = 180.0 / M_PI;
+
+constexpr int64_t kHorizonsNs[] = {20000000, 40000000, 60000000};
+constexpr int kHorizonCount = sizeof(kHorizonsNs) / sizeof(kHorizonsNs[0]);
+
+constexpr SensorFusionEkf::PredictionModel kModels[] = {
+    SensorFusionEkf::PredictionModel::kConstantVelocity,
+    SensorFusionEkf::PredictionModel::kConstantAcceleration};
+constexpr const char* kModelNames[] = {"constant velocity",
+                                       "constant acceleration"};
+constexpr int kModelCount = sizeof(kModels) / sizeof(kModels[0]);
+
+// Samples processed before predictions are evaluated, so that the fusion has
+// converged.
+constexpr int64_t kWarmUpNs = 2000000000;
+// Change of angular velocity norm within the horizon, in rad/s, above which
+// a sample is considered a transient.
+constexpr double kTransientVelocityChange = 0.3;
+
+// Reads the sensor samples of a trace into @p records and its ground truth
+// records into @p ground_truth, both sorted by timestamp.
+bool ReadTrace(const std::string& path, std::vector<ImuTraceRecord>* records,
+               std::vector<ImuTraceRecord>* ground_truth) {
+  ImuTraceReader reader;
+  if (!reader.Open(path)) {
+    return false;
+  }
+  ImuTraceRecord record;
+  while (reader.ReadNext(&record)) {
+    if (record.type == ImuTraceRecord::Type::kGroundTruth) {
+      ground_truth->push_back(record);
+    } else {
+      records->push_back(record);
+    }
+  }
+  // Sensor threads may record slightly out of order.
+  const auto by_timestamp = [](const ImuTraceRecord& a,
+                               const ImuTraceRecord& b) {
+    return a.timestamp_ns < b.timestamp_ns;
+  };
+  std::stable_sort(records->begin(), records->end(), by_timestamp);
+  std::stable_sort(ground_truth->begin(), ground_truth->end(), by_timestamp);
+  return true;
+}
+
+double GetAngle(const Rotation& rotation) {
+  Vector3 axis;
+  double angle;
+  rotation.GetAxisAndAngle(&axis, &angle);
+  return std::min(angle, 2.0 * M_PI - angle);
+}
+
+double GetPercentile(std::vector<double> values, double percentile) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  const size_t index =
+      std::min(values.size() - 1,
+               static_cast<size_t>(percentile / 100.0 * values.size()));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+double GetRms(const std::vector<double>& values) {
+  double sum_squared = 0.0;
+  for (double value : values) {
+    sum_squared += value * value;
+  }
+  return values.empty() ? 0.0 : std::sqrt(sum_squared / values.size());
+}
+
+// A prediction made after processing a gyroscope sample, for the time of a
+// later one. The ground truth indices are only set when the trace has ground
+// truth records.
+struct Prediction {
+  size_t source_index;
+  size_t target_index;
+  size_t source_ground_truth_index;
+  size_t target_ground_truth_index;
+  Rotation rotations[kModelCount];
+};
+
+void Evaluate(const std::string& name,
+              const std::vector<ImuTraceRecord>& records,
+              const std::vector<ImuTraceRecord>& ground_truth,
+              const SensorFusionEkf::PredictionParams& base_params) {
+  // Timestamps of the gyroscope samples, which are the instants at which the
+  // fused rotation is known.
+  std::vector<uint64_t> gyroscope_timestamps;
+  for (const ImuTraceRecord& record : records) {
+    if (record.type == ImuTraceRecord::Type::kGyroscope) {
+      gyroscope_timestamps.push_back(record.timestamp_ns);
+    }
+  }
+  if (gyroscope_timestamps.empty()) {
+    printf("%s\n  no gyroscope samples\n", name.c_str());
+    return;
+  }
+  const uint64_t first_timestamp = gyroscope_timestamps.front();
+  std::vector<uint64_t> ground_truth_timestamps;
+  for (const ImuTraceRecord& record : ground_truth) {
+    ground_truth_timestamps.push_back(record.timestamp_ns);
+  }
+  const bool has_ground_truth = !ground_truth.empty();
+
+  SensorFusionEkf::PredictionParams params[kModelCount];
+  for (int model = 0; model < kModelCount; ++model) {
+    params[model] = base_params;
+    params[model].model = kModels[model];
+  }
+
+  SensorFusionEkf sensor_fusion;
+  std::vector<Rotation> rotations(gyroscope_timestamps.size());
+  std::vector<Vector3> velocities(gyroscope_timestamps.size());
+  std::vector<Prediction> predictions[kHorizonCount];
+  size_t gyroscope_index = 0;
+  for (const ImuTraceRecord& record : records) {
+    if (record.type == ImuTraceRecord::Type::kAccelerometer) {
+      sensor_fusion.ProcessAccelerometerSample(record.ToAccelerometerData());
+      continue;
+    }
+    sensor_fusion.ProcessGyroscopeSample(record.ToGyroscopeData());
+    const RotationState state = sensor_fusion.GetLatestRotationState();
+    rotations[gyroscope_index] = state.sensor_from_start_rotation;
+    velocities[gyroscope_index] = state.sensor_from_start_rotation_velocity;
+
+    // With ground truth, only the samples that have a ground truth record
+    // are evaluated.
+    const auto source_ground_truth =
+        std::lower_bound(ground_truth_timestamps.begin(),
+                         ground_truth_timestamps.end(), record.timestamp_ns);
+    const bool is_evaluated =
+        record.timestamp_ns - first_timestamp >= kWarmUpNs &&
+        (!has_ground_truth ||
+         (source_ground_truth != ground_truth_timestamps.end() &&
+          *source_ground_truth == record.timestamp_ns));
+    if (is_evaluated) {
+      for (int horizon = 0; horizon < kHorizonCount; ++horizon) {
+        // Predicts for the first reference at or after the horizon, so that
+        // it is a ground truth or a fused rotation rather than an
+        // interpolation.
+        const uint64_t horizon_timestamp =
+            record.timestamp_ns + kHorizonsNs[horizon];
+        const auto target = std::lower_bound(
+            gyroscope_timestamps.begin() + gyroscope_index,
+            gyroscope_timestamps.end(), horizon_timestamp);
+        const auto target_ground_truth =
+            std::lower_bound(source_ground_truth, ground_truth_timestamps.end(),
+                             horizon_timestamp);
+        if (target == gyroscope_timestamps.end() ||
+            (has_ground_truth &&
+             target_ground_truth == ground_truth_timestamps.end())) {
+          continue;
+        }
+        const uint64_t target_timestamp =
+            has_ground_truth ? *target_ground_truth : *target;
+        Prediction prediction;
+        prediction.source_index = gyroscope_index;
+        prediction.target_index = target - gyroscope_timestamps.begin();
+        prediction.source_ground_truth_index =
+            source_ground_truth - ground_truth_timestamps.begin();
+        prediction.target_ground_truth_index =
+            target_ground_truth - ground_truth_timestamps.begin();
+        for (int model = 0; model < kModelCount; ++model) {
+          sensor_fusion.SetPredictionParams(params[model]);
+          prediction.rotations[model] =
+              sensor_fusion.PredictRotation(static_cast<int64_t>(
+                  target_timestamp));
+        }
+        predictions[horizon].push_back(prediction);
+      }
+    }
+    ++gyroscope_index;
+  }
+
+  printf("%s\n", name.c_str());
+  printf("  reference: %s\n",
+         has_ground_truth ? "ground truth" : "fused rotation");
+  printf("  horizon  model                     rms     p95     max"
+         "  transient rms (deg)\n");
+  for (int horizon = 0; horizon < kHorizonCount; ++horizon) {
+    for (int model = 0; model < kModelCount; ++model) {
+      std::vector<double> errors;
+      std::vector<double> transient_errors;
+      for (const Prediction& prediction : predictions[horizon]) {
+        double error;
+        if (has_ground_truth) {
+          const Rotation predicted_motion =
+              prediction.rotations[model] *
+              -rotations[prediction.source_index];
+          const Rotation true_motion =
+              ground_truth[prediction.target_ground_truth_index]
+                  .sensor_from_start_rotation *
+              -ground_truth[prediction.source_ground_truth_index]
+                   .sensor_from_start_rotation;
+          error = GetAngle(predicted_motion * -true_motion);
+        } else {
+          error = GetAngle(prediction.rotations[model] *
+                           -rotations[prediction.target_index]);
+        }
+        error *= kRadiansToDegrees;
+        errors.push_back(error);
+        const Vector3 velocity_change =
+            velocities[prediction.target_index] -
+            velocities[prediction.source_index];
+        if (Length(velocity_change) > kTransientVelocityChange) {
+          transient_errors.push_back(error);
+        }
+      }
+      printf("  %3lld ms   %-22s %7.3f %7.3f %7.3f  %7.3f (%zu samples)\n",
+             static_cast<long long>(kHorizonsNs[horizon] / 1000000),
+             kModelNames[model], GetRms(errors), GetPercentile(errors, 95.0),
+             errors.empty() ? 0.0
+                            : *std::max_element(errors.begin(), errors.end()),
+             GetRms(transient_errors), transient_errors.size());
+    }
+  }
+}
+
+bool ParseDouble(const char* text, double* value) {
+  char* end;
+  *value = std::strtod(text, &end);
+  return end != text && *end == '\0';
+}
+
+}  // namespace
+}  // namespace cardboard
+
+int main(int argc, char** argv) {
+  using cardboard::ImuTraceRecord;
+  using cardboard::SensorFusionEkf;
+
+  SensorFusionEkf::PredictionParams params;
+  int i = 1;
+  for (; i + 1 < argc && std::strncmp(argv[i], "--", 2) == 0; i += 2) {
+    const std::string option = argv[i];
+    double* value = nullptr;
+    if (option == "--max-horizon") {
+      value = &params.max_horizon_s;
+    } else if (option == "--acceleration-time-constant") {
+      value = &params.acceleration_time_constant_s;
+    } else if (option == "--max-angular-acceleration") {
+      value = &params.max_angular_acceleration;
+    }
+    if (value == nullptr || !cardboard::ParseDouble(argv[i + 1], value)) {
+      fprintf(stderr, "Invalid option: %s %s\n", argv[i], argv[i + 1]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (i == argc) {
+    fprintf(stderr,
+            "Usage: %s [--max-horizon s] [--acceleration-time-constant s]"
+            " [--max-angular-acceleration rad/s^2] <trace>...\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  for (; i < argc; ++i) {
+    std::vector<ImuTraceRecord> records;
+    std::vector<ImuTraceRecord> ground_truth;
+    if (!cardboard::ReadTrace(argv[i], &records, &ground_truth)) {
+      return EXIT_FAILURE;
+    }
+    cardboard::Evaluate(argv[i], records, ground_truth, params);
+  }
+  return EXIT_SUCCESS;
+}
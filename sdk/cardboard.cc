@@ -17,6 +17,7 @@
 
 #include <cmath>
 
+#include "distortion_mesh_cache.h"
 #include "distortion_renderer.h"
 #include "head_tracker.h"
 #include "lens_distortion.h"
@@ -70,6 +71,17 @@ void GetDefaultDistortionMesh(CardboardMesh* mesh) {
   }
 }
 
+// Return default (empty) compact distortion mesh.
+void GetDefaultCompactDistortionMesh(CardboardCompactMesh* mesh) {
+  if (mesh != nullptr) {
+    mesh->indices = nullptr;
+    mesh->n_indices = 0;
+    mesh->vertices = nullptr;
+    mesh->n_vertices = 0;
+    mesh->position_scale = 1.0f;
+  }
+}
+
 // Return default (empty) encoded device params.
 void GetDefaultEncodedDeviceParams(uint8_t** encoded_device_params, int* size) {
   if (encoded_device_params != nullptr) {
@@ -141,6 +153,31 @@ void CardboardLensDistortion_destroy(CardboardLensDistortion* lens_distortion) {
   delete lens_distortion;
 }
 
+void CardboardLensDistortion_getCacheStatistics(int64_t* hits,
+                                                int64_t* misses) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(hits) ||
+      CARDBOARD_IS_ARG_NULL(misses)) {
+    return;
+  }
+  cardboard::LensDistortion::GetCacheStatistics(hits, misses);
+}
+
+void CardboardLensDistortion_clearCache() {
+  if (CARDBOARD_IS_NOT_INITIALIZED()) {
+    return;
+  }
+  cardboard::LensDistortion::ClearCache();
+}
+
+void CardboardLensDistortion_setPersistentCacheDirectory(
+    const char* directory) {
+  if (CARDBOARD_IS_NOT_INITIALIZED()) {
+    return;
+  }
+  cardboard::DistortionMeshCache::SetDirectory(
+      directory != nullptr ? directory : "");
+}
+
 void CardboardLensDistortion_getEyeFromHeadMatrix(
     CardboardLensDistortion* lens_distortion, CardboardEye eye,
     float* eye_from_head_matrix) {
@@ -192,6 +229,62 @@ void CardboardLensDistortion_getDistortionMesh(
               ->GetDistortionMesh(eye);
 }
 
+void CardboardLensDistortion_getCompactDistortionMesh(
+    CardboardLensDistortion* lens_distortion, CardboardEye eye,
+    CardboardCompactMesh* mesh) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion) || CARDBOARD_IS_ARG_NULL(mesh)) {
+    GetDefaultCompactDistortionMesh(mesh);
+    return;
+  }
+  *mesh = static_cast<cardboard::LensDistortion*>(lens_distortion)
+              ->GetCompactDistortionMesh(eye);
+}
+
+void CardboardLensDistortion_setDistortionMeshResolution(
+    CardboardLensDistortion* lens_distortion, int resolution) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion)) {
+    return;
+  }
+  static_cast<cardboard::LensDistortion*>(lens_distortion)
+      ->SetDistortionMeshResolution(resolution);
+}
+
+void CardboardLensDistortion_setDistortionMeshMaxError(
+    CardboardLensDistortion* lens_distortion, float max_error_pixels) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion) || !(max_error_pixels > 0)) {
+    return;
+  }
+  static_cast<cardboard::LensDistortion*>(lens_distortion)
+      ->SetDistortionMeshMaxError(max_error_pixels);
+}
+
+void CardboardLensDistortion_getRecommendedRenderTargetSize(
+    CardboardLensDistortion* lens_distortion, CardboardEye eye, float quality,
+    int* width, int* height) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion) || !(quality > 0) ||
+      CARDBOARD_IS_ARG_NULL(width) || CARDBOARD_IS_ARG_NULL(height)) {
+    return;
+  }
+  static_cast<cardboard::LensDistortion*>(lens_distortion)
+      ->GetRecommendedRenderTargetSize(eye, quality, width, height);
+}
+
+void CardboardLensDistortion_getPixelDensityMap(
+    CardboardLensDistortion* lens_distortion, CardboardEye eye, int32_t count,
+    float* density_map) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion) ||
+      CARDBOARD_IS_ARG_NULL(density_map) || count <= 0) {
+    return;
+  }
+  static_cast<cardboard::LensDistortion*>(lens_distortion)
+      ->GetPixelDensityMap(eye, count, density_map);
+}
+
 CardboardUv CardboardLensDistortion_undistortedUvForDistortedUv(
     CardboardLensDistortion* lens_distortion, const CardboardUv* distorted_uv,
     CardboardEye eye) {
@@ -232,6 +325,40 @@ CardboardUv CardboardLensDistortion_distortedUvForUndistortedUv(
   return ret;
 }
 
+void CardboardLensDistortion_undistortedUvForDistortedUvBatch(
+    CardboardLensDistortion* lens_distortion, const float* distorted_u,
+    const float* distorted_v, int count, CardboardEye eye,
+    float* undistorted_u, float* undistorted_v) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion) ||
+      CARDBOARD_IS_ARG_NULL(distorted_u) ||
+      CARDBOARD_IS_ARG_NULL(distorted_v) ||
+      CARDBOARD_IS_ARG_NULL(undistorted_u) ||
+      CARDBOARD_IS_ARG_NULL(undistorted_v) || count <= 0) {
+    return;
+  }
+  static_cast<cardboard::LensDistortion*>(lens_distortion)
+      ->UndistortedUvForDistortedUvBatch(distorted_u, distorted_v, count, eye,
+                                         undistorted_u, undistorted_v);
+}
+
+void CardboardLensDistortion_distortedUvForUndistortedUvBatch(
+    CardboardLensDistortion* lens_distortion, const float* undistorted_u,
+    const float* undistorted_v, int count, CardboardEye eye,
+    float* distorted_u, float* distorted_v) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() ||
+      CARDBOARD_IS_ARG_NULL(lens_distortion) ||
+      CARDBOARD_IS_ARG_NULL(undistorted_u) ||
+      CARDBOARD_IS_ARG_NULL(undistorted_v) ||
+      CARDBOARD_IS_ARG_NULL(distorted_u) ||
+      CARDBOARD_IS_ARG_NULL(distorted_v) || count <= 0) {
+    return;
+  }
+  static_cast<cardboard::LensDistortion*>(lens_distortion)
+      ->DistortedUvForUndistortedUvBatch(undistorted_u, undistorted_v, count,
+                                         eye, distorted_u, distorted_v);
+}
+
 void CardboardDistortionRenderer_destroy(
     CardboardDistortionRenderer* renderer) {
   if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer)) {
@@ -250,6 +377,36 @@ void CardboardDistortionRenderer_setMesh(CardboardDistortionRenderer* renderer,
   static_cast<cardboard::DistortionRenderer*>(renderer)->SetMesh(mesh, eye);
 }
 
+void CardboardDistortionRenderer_setCompactMesh(
+    CardboardDistortionRenderer* renderer, const CardboardCompactMesh* mesh,
+    CardboardEye eye) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer) ||
+      CARDBOARD_IS_ARG_NULL(mesh)) {
+    return;
+  }
+  static_cast<cardboard::DistortionRenderer*>(renderer)->SetCompactMesh(mesh,
+                                                                        eye);
+}
+
+void CardboardDistortionRenderer_setReprojection(
+    CardboardDistortionRenderer* renderer,
+    const CardboardReprojection* reprojection) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer)) {
+    return;
+  }
+  static_cast<cardboard::DistortionRenderer*>(renderer)->SetReprojection(
+      reprojection);
+}
+
+void CardboardDistortionRenderer_setVignetteFill(
+    CardboardDistortionRenderer* renderer, int enabled) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer)) {
+    return;
+  }
+  static_cast<cardboard::DistortionRenderer*>(renderer)->SetVignetteFill(
+      enabled != 0);
+}
+
 void CardboardDistortionRenderer_renderEyeToDisplay(
     CardboardDistortionRenderer* renderer, uint64_t target, int x, int y,
     int width, int height, const CardboardEyeTextureDescription* left_eye,
@@ -276,6 +433,63 @@ void CardboardHeadTracker_setLowPassFilter(CardboardHeadTracker* head_tracker, c
   head_tracker->SetLowPassFilter(cutoff_frequency);
 }
 
+void CardboardHeadTracker_startTraceRecording(
+    CardboardHeadTracker* head_tracker, const char* path) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker) ||
+      CARDBOARD_IS_ARG_NULL(path)) {
+    return;
+  }
+  head_tracker->StartTraceRecording(path);
+}
+
+void CardboardHeadTracker_stopTraceRecording(
+    CardboardHeadTracker* head_tracker) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker)) {
+    return;
+  }
+  head_tracker->StopTraceRecording();
+}
+
+void CardboardHeadTracker_setPosePrediction(
+    CardboardHeadTracker* head_tracker,
+    const CardboardPosePredictionParams* params) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker) ||
+      CARDBOARD_IS_ARG_NULL(params)) {
+    return;
+  }
+  cardboard::SensorFusionEkf::PredictionParams prediction_params;
+  prediction_params.model =
+      params->model == kConstantAccelerationPrediction
+          ? cardboard::SensorFusionEkf::PredictionModel::kConstantAcceleration
+          : cardboard::SensorFusionEkf::PredictionModel::kConstantVelocity;
+  prediction_params.max_horizon_s = params->max_horizon_s;
+  prediction_params.acceleration_time_constant_s =
+      params->acceleration_time_constant_s;
+  prediction_params.max_angular_acceleration =
+      params->max_angular_acceleration;
+  head_tracker->SetPosePrediction(prediction_params);
+}
+
+void CardboardHeadTracker_getPosePrediction(
+    CardboardHeadTracker* head_tracker, CardboardPosePredictionParams* params) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker) ||
+      CARDBOARD_IS_ARG_NULL(params)) {
+    return;
+  }
+  const cardboard::SensorFusionEkf::PredictionParams prediction_params =
+      head_tracker->GetPosePrediction();
+  params->model = prediction_params.model ==
+                          cardboard::SensorFusionEkf::PredictionModel::
+                              kConstantAcceleration
+                      ? kConstantAccelerationPrediction
+                      : kConstantVelocityPrediction;
+  params->max_horizon_s = static_cast<float>(prediction_params.max_horizon_s);
+  params->acceleration_time_constant_s =
+      static_cast<float>(prediction_params.acceleration_time_constant_s);
+  params->max_angular_acceleration =
+      static_cast<float>(prediction_params.max_angular_acceleration);
+}
+
 void CardboardHeadTracker_destroy(CardboardHeadTracker* head_tracker) {
   if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker)) {
     return;
@@ -315,6 +529,51 @@ void CardboardHeadTracker_getPose(
   std::memcpy(orientation, &out_orientation[0], 4 * sizeof(float));
 }
 
+void CardboardHeadTracker_getPoses(
+    CardboardHeadTracker* head_tracker, const int64_t* timestamps_ns,
+    int32_t count, CardboardViewportOrientation viewport_orientation,
+    float* positions, float* orientations) {
+  if (count <= 0) {
+    return;
+  }
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker) ||
+      CARDBOARD_IS_ARG_NULL(timestamps_ns) ||
+      CARDBOARD_IS_ARG_NULL(positions) ||
+      CARDBOARD_IS_ARG_NULL(orientations)) {
+    for (int32_t i = 0; i < count; ++i) {
+      GetDefaultPosition(positions == nullptr ? nullptr : positions + 3 * i);
+      GetDefaultOrientation(orientations == nullptr ? nullptr
+                                                    : orientations + 4 * i);
+    }
+    return;
+  }
+  head_tracker->GetPoses(timestamps_ns, count, viewport_orientation, positions,
+                         orientations);
+}
+
+int CardboardHeadTracker_getPastPose(
+    CardboardHeadTracker* head_tracker, int64_t timestamp_ns,
+    CardboardViewportOrientation viewport_orientation, float* position,
+    float* orientation) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker) ||
+      CARDBOARD_IS_ARG_NULL(position) || CARDBOARD_IS_ARG_NULL(orientation)) {
+    GetDefaultPosition(position);
+    GetDefaultOrientation(orientation);
+    return 0;
+  }
+  std::array<float, 3> out_position;
+  std::array<float, 4> out_orientation;
+  if (!head_tracker->GetPastPose(timestamp_ns, viewport_orientation,
+                                 out_position, out_orientation)) {
+    GetDefaultPosition(position);
+    GetDefaultOrientation(orientation);
+    return 0;
+  }
+  std::memcpy(position, &out_position[0], 3 * sizeof(float));
+  std::memcpy(orientation, &out_orientation[0], 4 * sizeof(float));
+  return 1;
+}
+
 void CardboardHeadTracker_recenter(CardboardHeadTracker* head_tracker) {
   if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(head_tracker)) {
     return;
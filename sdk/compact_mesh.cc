@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "compact_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/logging.h"
+
+namespace cardboard {
+
+namespace {
+
+int16_t Normalize(float value, float scale) {
+  return static_cast<int16_t>(
+      std::lround(std::min(std::max(value / scale, -1.0f), 1.0f) *
+                  CompactMesh::kNormalizedOne));
+}
+
+}  // namespace
+
+CompactMesh::CompactMesh(const CardboardMesh& mesh) : position_scale_(1.0f) {
+  if (mesh.n_vertices > kMaxVertices) {
+    CARDBOARD_LOGE(
+        "Distortion mesh has %d vertices, the compact layout supports up to "
+        "%d.",
+        mesh.n_vertices, kMaxVertices);
+    return;
+  }
+
+  // Positions outside of [-1, 1] are kept by scaling all of them down.
+  for (int i = 0; i < mesh.n_vertices * 2; i++) {
+    position_scale_ = std::max(position_scale_, std::fabs(mesh.vertices[i]));
+  }
+
+  vertex_data_.resize(mesh.n_vertices * 4);  // 4 components per vertex
+  for (int i = 0; i < mesh.n_vertices; i++) {
+    vertex_data_[4 * i + 0] = Normalize(mesh.vertices[2 * i + 0],
+                                        position_scale_);
+    vertex_data_[4 * i + 1] = Normalize(mesh.vertices[2 * i + 1],
+                                        position_scale_);
+    vertex_data_[4 * i + 2] = Normalize(mesh.uvs[2 * i + 0], 1.0f);
+    vertex_data_[4 * i + 3] = Normalize(mesh.uvs[2 * i + 1], 1.0f);
+  }
+  index_data_.assign(mesh.indices, mesh.indices + mesh.n_indices);
+}
+
+CardboardCompactMesh CompactMesh::GetMesh() const {
+  CardboardCompactMesh mesh;
+  mesh.indices = const_cast<uint16_t*>(index_data_.data());
+  mesh.n_indices = static_cast<int>(index_data_.size());
+  mesh.vertices = const_cast<int16_t*>(vertex_data_.data());
+  mesh.n_vertices = static_cast<int>(vertex_data_.size() / 4);
+  mesh.position_scale = position_scale_;
+  return mesh;
+}
+
+}  // namespace cardboard
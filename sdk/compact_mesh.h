@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_COMPACT_MESH_H_
+#define CARDBOARD_SDK_COMPACT_MESH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "include/cardboard.h"
+
+namespace cardboard {
+
+// Owns the buffers of a CardboardCompactMesh built from a CardboardMesh.
+class CompactMesh {
+ public:
+  // Largest number of vertices that can be addressed with 16-bit indices.
+  static constexpr int kMaxVertices = 65536;
+  // Value that represents 1.0 in a normalized signed 16-bit integer.
+  static constexpr float kNormalizedOne = 32767.0f;
+
+  // Converts @p mesh. When it has more than kMaxVertices vertices an error is
+  // logged and the compact mesh is left empty.
+  explicit CompactMesh(const CardboardMesh& mesh);
+  CardboardCompactMesh GetMesh() const;
+
+ private:
+  std::vector<uint16_t> index_data_;
+  std::vector<int16_t> vertex_data_;
+  float position_scale_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_COMPACT_MESH_H_
@@ -15,48 +15,237 @@
  */
 #include "distortion_mesh.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "include/cardboard.h"
 
 namespace cardboard {
 
+namespace {
+
+// Number of samples used to estimate the curvature of the inverse distortion
+// along each axis.
+constexpr int kCurvatureSamples = 256;
+// Number of lines parallel to each axis along which the curvature is sampled.
+constexpr int kCurvatureLines = 9;
+
+// Maps normalized [0, 1] texture coordinates to normalized [0, 1] screen
+// coordinates.
+class TextureToScreen {
+ public:
+  TextureToScreen(const PolynomialRadialDistortion& distortion,
+                  // Units of the following parameters are tan-angle units.
+                  float screen_width, float screen_height,
+                  float x_eye_offset_screen, float y_eye_offset_screen,
+                  float texture_width, float texture_height,
+                  float x_eye_offset_texture, float y_eye_offset_texture)
+      : distortion_(distortion),
+        screen_width_(screen_width),
+        screen_height_(screen_height),
+        x_eye_offset_screen_(x_eye_offset_screen),
+        y_eye_offset_screen_(y_eye_offset_screen),
+        texture_width_(texture_width),
+        texture_height_(texture_height),
+        x_eye_offset_texture_(x_eye_offset_texture),
+        y_eye_offset_texture_(y_eye_offset_texture) {}
+
+  std::array<float, 2> Map(float u_texture, float v_texture) const {
+    // Note that we warp the mesh vertices using the inverse of
+    // the distortion function instead of warping the texture
+    // coordinates by the distortion function so that the mesh
+    // exactly covers the screen area that gets rendered to.
+    // Helps avoid visible aliasing in the vignette.
+
+    // texture position & radius relative to eye center in meters - I believe
+    // this is tanangle
+    const std::array<float, 2> p_texture = {
+        u_texture * texture_width_ - x_eye_offset_texture_,
+        v_texture * texture_height_ - y_eye_offset_texture_};
+
+    const std::array<float, 2> p_screen =
+        distortion_.DistortInverse(p_texture);
+
+    return {(p_screen[0] + x_eye_offset_screen_) / screen_width_,
+            (p_screen[1] + y_eye_offset_screen_) / screen_height_};
+  }
+
+  // Returns @p resolution texture coordinates in [0, 1] along @p axis (0 for
+  // u, 1 for v) at which the grid vertices are placed.
+  std::vector<float> AxisSamples(int axis, int resolution,
+                                 DistortionMesh::Spacing spacing) const {
+    std::vector<float> samples(resolution);
+    if (spacing == DistortionMesh::Spacing::kUniform) {
+      for (int i = 0; i < resolution; i++) {
+        samples[i] = static_cast<float>(i) / (resolution - 1);
+      }
+      return samples;
+    }
+
+    // Piecewise linear interpolation error over an interval of length h is
+    // proportional to h^2 |f''|, so it is equidistributed by a vertex density
+    // proportional to sqrt(|f''|). Since the distortion is radial, f'' is
+    // taken as the largest second derivative along a few lines parallel to
+    // the axis. A uniform term equal to the mean curvature density is added so
+    // that the center is not left empty.
+    const float step = 1.0f / (kCurvatureSamples - 1);
+    std::vector<float> density(kCurvatureSamples, 0.0f);
+    for (int line = 0; line < kCurvatureLines; line++) {
+      const float s = static_cast<float>(line) / (kCurvatureLines - 1);
+      std::vector<std::array<float, 2>> f(kCurvatureSamples);
+      for (int i = 0; i < kCurvatureSamples; i++) {
+        const float t = i * step;
+        f[i] = axis == 0 ? Map(t, s) : Map(s, t);
+      }
+      for (int i = 1; i < kCurvatureSamples - 1; i++) {
+        const float second_difference =
+            std::fabs(f[i + 1][0] - 2.0f * f[i][0] + f[i - 1][0]) +
+            std::fabs(f[i + 1][1] - 2.0f * f[i][1] + f[i - 1][1]);
+        density[i] = std::max(density[i], std::sqrt(second_difference) / step);
+      }
+    }
+    density[0] = density[1];
+    density[kCurvatureSamples - 1] = density[kCurvatureSamples - 2];
+    float mean_density = 0.0f;
+    for (float d : density) {
+      mean_density += d;
+    }
+    mean_density /= kCurvatureSamples;
+
+    // Cumulative density, integrated with the trapezoidal rule.
+    std::vector<float> cumulative(kCurvatureSamples, 0.0f);
+    for (int i = 1; i < kCurvatureSamples; i++) {
+      cumulative[i] = cumulative[i - 1] + mean_density +
+                      0.5f * (density[i - 1] + density[i]);
+    }
+
+    // Place the vertices at equal increments of the cumulative density.
+    int j = 0;
+    for (int i = 0; i < resolution; i++) {
+      const float target =
+          cumulative.back() * static_cast<float>(i) / (resolution - 1);
+      while (j < kCurvatureSamples - 2 && cumulative[j + 1] < target) {
+        j++;
+      }
+      const float segment = cumulative[j + 1] - cumulative[j];
+      const float fraction =
+          segment > 0.0f
+              ? std::min(std::max((target - cumulative[j]) / segment, 0.0f),
+                         1.0f)
+              : 0.0f;
+      samples[i] = (j + fraction) * step;
+    }
+    samples.front() = 0.0f;
+    samples.back() = 1.0f;
+    return samples;
+  }
+
+ private:
+  const PolynomialRadialDistortion& distortion_;
+  const float screen_width_;
+  const float screen_height_;
+  const float x_eye_offset_screen_;
+  const float y_eye_offset_screen_;
+  const float texture_width_;
+  const float texture_height_;
+  const float x_eye_offset_texture_;
+  const float y_eye_offset_texture_;
+};
+
+// Returns the largest distance, in pixels, between the exact inverse
+// distortion and the triangles of a grid placed at @p u_samples x
+// @p v_samples. It is measured at the midpoint of every edge and diagonal.
+float MaxInterpolationErrorPixels(const TextureToScreen& texture_to_screen,
+                                  const std::vector<float>& u_samples,
+                                  const std::vector<float>& v_samples,
+                                  int screen_width_pixels,
+                                  int screen_height_pixels) {
+  const int cols = static_cast<int>(u_samples.size());
+  const int rows = static_cast<int>(v_samples.size());
+  std::vector<std::array<float, 2>> vertices(rows * cols);
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      vertices[row * cols + col] =
+          texture_to_screen.Map(u_samples[col], v_samples[row]);
+    }
+  }
+
+  float max_error = 0.0f;
+  auto check_midpoint = [&](int vertex_a, int vertex_b, float u, float v) {
+    const std::array<float, 2> exact = texture_to_screen.Map(u, v);
+    const float dx =
+        (0.5f * (vertices[vertex_a][0] + vertices[vertex_b][0]) - exact[0]) *
+        screen_width_pixels;
+    const float dy =
+        (0.5f * (vertices[vertex_a][1] + vertices[vertex_b][1]) - exact[1]) *
+        screen_height_pixels;
+    max_error = std::max(max_error, std::sqrt(dx * dx + dy * dy));
+  };
+
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      const int index = row * cols + col;
+      const bool has_right = col + 1 < cols;
+      const bool has_up = row + 1 < rows;
+      if (has_right) {
+        check_midpoint(index, index + 1,
+                       0.5f * (u_samples[col] + u_samples[col + 1]),
+                       v_samples[row]);
+      }
+      if (has_up) {
+        check_midpoint(index, index + cols, u_samples[col],
+                       0.5f * (v_samples[row] + v_samples[row + 1]));
+      }
+      if (has_right && has_up) {
+        // The strip alternates the diagonal direction between rows, so both
+        // diagonals are checked.
+        const float u_mid = 0.5f * (u_samples[col] + u_samples[col + 1]);
+        const float v_mid = 0.5f * (v_samples[row] + v_samples[row + 1]);
+        check_midpoint(index, index + cols + 1, u_mid, v_mid);
+        check_midpoint(index + 1, index + cols, u_mid, v_mid);
+      }
+    }
+  }
+  return max_error;
+}
+
+}  // namespace
+
 DistortionMesh::DistortionMesh(
     const PolynomialRadialDistortion& distortion,
     // Units of the following parameters are tan-angle units.
     float screen_width, float screen_height, float x_eye_offset_screen,
     float y_eye_offset_screen, float texture_width, float texture_height,
-    float x_eye_offset_texture, float y_eye_offset_texture) {
-  vertex_data_.resize(kResolution * kResolution *
-                      2);                           // 2 components per vertex
-  uvs_data_.resize(kResolution * kResolution * 2);  // 2 components per uv
-  float u_screen, v_screen, u_texture, v_texture;
-  std::array<float, 2> p_texture;
-  std::array<float, 2> p_screen;
-  for (int row = 0; row < kResolution; row++) {
-    for (int col = 0; col < kResolution; col++) {
-      // Note that we warp the mesh vertices using the inverse of
-      // the distortion function instead of warping the texture
-      // coordinates by the distortion function so that the mesh
-      // exactly covers the screen area that gets rendered to.
-      // Helps avoid visible aliasing in the vignette.
-      u_texture = (static_cast<float>(col) / (kResolution - 1));
-      v_texture = (static_cast<float>(row) / (kResolution - 1));
-
-      // texture position & radius relative to eye center in meters - I believe
-      // this is tanangle
-      p_texture[0] = u_texture * texture_width - x_eye_offset_texture;
-      p_texture[1] = v_texture * texture_height - y_eye_offset_texture;
-
-      p_screen = distortion.DistortInverse(p_texture);
-
-      u_screen = (p_screen[0] + x_eye_offset_screen) / screen_width;
-      v_screen = (p_screen[1] + y_eye_offset_screen) / screen_height;
-
-      const int index = (row * kResolution + col) * 2;
-
-      vertex_data_[index + 0] = 2 * u_screen - 1;
-      vertex_data_[index + 1] = 2 * v_screen - 1;
+    float x_eye_offset_texture, float y_eye_offset_texture, int resolution,
+    Spacing spacing) {
+  resolution = std::min(std::max(resolution, kMinResolution), kMaxResolution);
+  const TextureToScreen texture_to_screen(
+      distortion, screen_width, screen_height, x_eye_offset_screen,
+      y_eye_offset_screen, texture_width, texture_height, x_eye_offset_texture,
+      y_eye_offset_texture);
+  const std::vector<float> u_samples =
+      texture_to_screen.AxisSamples(0, resolution, spacing);
+  const std::vector<float> v_samples =
+      texture_to_screen.AxisSamples(1, resolution, spacing);
+
+  vertex_data_.resize(resolution * resolution *
+                      2);                         // 2 components per vertex
+  uvs_data_.resize(resolution * resolution * 2);  // 2 components per uv
+  for (int row = 0; row < resolution; row++) {
+    for (int col = 0; col < resolution; col++) {
+      const float u_texture = u_samples[col];
+      const float v_texture = v_samples[row];
+      const std::array<float, 2> uv_screen =
+          texture_to_screen.Map(u_texture, v_texture);
+
+      const int index = (row * resolution + col) * 2;
+
+      vertex_data_[index + 0] = 2 * uv_screen[0] - 1;
+      vertex_data_[index + 1] = 2 * uv_screen[1] - 1;
       uvs_data_[index + 0] = u_texture;
       uvs_data_[index + 1] = v_texture;
     }
@@ -86,16 +275,16 @@ DistortionMesh::DistortionMesh(
   //   2 vertices at the start of each row for the first triangle
   //   1 extra vertex per row (except first and last) for a
   //     degenerate triangle
-  const int n_indices = 2 * (kResolution - 1) * kResolution + (kResolution - 2);
+  const int n_indices = 2 * (resolution - 1) * resolution + (resolution - 2);
   index_data_.resize(n_indices);
   int index_offset = 0;
   int vertex_offset = 0;
-  for (int row = 0; row < kResolution - 1; row++) {
+  for (int row = 0; row < resolution - 1; row++) {
     if (row > 0) {
       index_data_[index_offset] = index_data_[index_offset - 1];
       index_offset++;
     }
-    for (int col = 0; col < kResolution; col++) {
+    for (int col = 0; col < resolution; col++) {
       if (col > 0) {
         if (row % 2 == 0) {
           // Move right on even rows.
@@ -106,20 +295,107 @@ DistortionMesh::DistortionMesh(
         }
       }
       index_data_[index_offset++] = vertex_offset;
-      index_data_[index_offset++] = vertex_offset + kResolution;
+      index_data_[index_offset++] = vertex_offset + resolution;
+    }
+    vertex_offset = vertex_offset + resolution;
+  }
+
+  indices_ = index_data_.data();
+  vertices_ = vertex_data_.data();
+  uvs_ = uvs_data_.data();
+  n_indices_ = static_cast<int>(index_data_.size());
+  n_vertices_ = static_cast<int>(vertex_data_.size() / 2);
+}
+
+DistortionMesh::DistortionMesh(std::shared_ptr<const void> storage,
+                               const float* vertices, const float* uvs,
+                               int n_vertices, const int* indices,
+                               int n_indices)
+    : storage_(std::move(storage)),
+      indices_(indices),
+      vertices_(vertices),
+      uvs_(uvs),
+      n_indices_(n_indices),
+      n_vertices_(n_vertices) {}
+
+DistortionMesh* DistortionMesh::CreateHorizontalMirror() const {
+  const int resolution =
+      static_cast<int>(std::lround(std::sqrt(static_cast<float>(n_vertices_))));
+  DistortionMesh* mirror = new DistortionMesh();
+  mirror->vertex_data_.resize(n_vertices_ * 2);
+  mirror->uvs_data_.resize(n_vertices_ * 2);
+  for (int row = 0; row < resolution; row++) {
+    for (int col = 0; col < resolution; col++) {
+      // Columns are reversed so that texture coordinates keep increasing from
+      // left to right and the same strip indices can be used.
+      const int index = (row * resolution + col) * 2;
+      const int mirror_index = (row * resolution + resolution - 1 - col) * 2;
+      mirror->vertex_data_[mirror_index + 0] = -vertices_[index + 0];
+      mirror->vertex_data_[mirror_index + 1] = vertices_[index + 1];
+      mirror->uvs_data_[mirror_index + 0] = 1 - uvs_[index + 0];
+      mirror->uvs_data_[mirror_index + 1] = uvs_[index + 1];
+    }
+  }
+  mirror->index_data_.assign(indices_, indices_ + n_indices_);
+
+  mirror->indices_ = mirror->index_data_.data();
+  mirror->vertices_ = mirror->vertex_data_.data();
+  mirror->uvs_ = mirror->uvs_data_.data();
+  mirror->n_indices_ = n_indices_;
+  mirror->n_vertices_ = n_vertices_;
+  return mirror;
+}
+
+int DistortionMesh::ComputeResolution(
+    const PolynomialRadialDistortion& distortion,
+    // Units of the following parameters are tan-angle units.
+    float screen_width, float screen_height, float x_eye_offset_screen,
+    float y_eye_offset_screen, float texture_width, float texture_height,
+    float x_eye_offset_texture, float y_eye_offset_texture,
+    float max_error_pixels, int screen_width_pixels, int screen_height_pixels,
+    Spacing spacing) {
+  const TextureToScreen texture_to_screen(
+      distortion, screen_width, screen_height, x_eye_offset_screen,
+      y_eye_offset_screen, texture_width, texture_height, x_eye_offset_texture,
+      y_eye_offset_texture);
+
+  // The error decreases with the resolution, so the smallest resolution that
+  // meets the budget is found with a binary search.
+  int low = kMinResolution;
+  int high = kMaxResolution;
+  while (low < high) {
+    const int resolution = low + (high - low) / 2;
+    const float error = MaxInterpolationErrorPixels(
+        texture_to_screen, texture_to_screen.AxisSamples(0, resolution, spacing),
+        texture_to_screen.AxisSamples(1, resolution, spacing),
+        screen_width_pixels, screen_height_pixels);
+    if (error <= max_error_pixels) {
+      high = resolution;
+    } else {
+      low = resolution + 1;
     }
-    vertex_offset = vertex_offset + kResolution;
   }
+  return low;
 }
 
 CardboardMesh DistortionMesh::GetMesh() const {
   CardboardMesh mesh;
-  mesh.indices = const_cast<int*>(index_data_.data());
-  mesh.vertices = const_cast<float*>(vertex_data_.data());
-  mesh.uvs = const_cast<float*>(uvs_data_.data());
-  mesh.n_indices = static_cast<int>(index_data_.size());
-  mesh.n_vertices = static_cast<int>(vertex_data_.size() / 2);
+  mesh.indices = const_cast<int*>(indices_);
+  mesh.vertices = const_cast<float*>(vertices_);
+  mesh.uvs = const_cast<float*>(uvs_);
+  mesh.n_indices = n_indices_;
+  mesh.n_vertices = n_vertices_;
   return mesh;
 }
 
+CardboardCompactMesh DistortionMesh::GetCompactMesh() const {
+  // Meshes may be shared by several lens distortion objects through the mesh
+  // cache, so the compact copy is built under a lock.
+  std::lock_guard<std::mutex> lock(compact_mesh_mutex_);
+  if (compact_mesh_ == nullptr) {
+    compact_mesh_.reset(new CompactMesh(GetMesh()));
+  }
+  return compact_mesh_->GetMesh();
+}
+
 }  // namespace cardboard
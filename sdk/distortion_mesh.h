@@ -16,8 +16,11 @@
 #ifndef CARDBOARD_SDK_DISTORTION_MESH_H_
 #define CARDBOARD_SDK_DISTORTION_MESH_H_
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
+#include "compact_mesh.h"
 #include "include/cardboard.h"
 #include "polynomial_radial_distortion.h"
 
@@ -25,20 +28,82 @@ namespace cardboard {
 
 class DistortionMesh {
  public:
+  // Default number of vertices per row and per column of the mesh grid.
+  static constexpr int kDefaultResolution = 40;
+  // Bounds of the number of vertices per row and per column. The upper bound
+  // keeps the vertex count addressable with 16-bit indices.
+  static constexpr int kMinResolution = 2;
+  static constexpr int kMaxResolution = 128;
+
+  // How the grid vertices are placed along each texture axis.
+  enum class Spacing {
+    // Vertices are uniformly spaced in texture space.
+    kUniform,
+    // Vertices are concentrated where the inverse distortion curves the most,
+    // usually towards the edges, and kept sparse near the lens center.
+    kAdaptive,
+  };
+
   DistortionMesh(const PolynomialRadialDistortion& distortion,
                  // Units of the following parameters are tan-angle units.
                  float screen_width, float screen_height,
                  float x_eye_offset_screen, float y_eye_offset_screen,
                  float texture_width, float texture_height,
-                 float x_eye_offset_texture, float y_eye_offset_texture);
+                 float x_eye_offset_texture, float y_eye_offset_texture,
+                 int resolution = kDefaultResolution,
+                 Spacing spacing = Spacing::kUniform);
+  // Wraps mesh buffers that are owned by @p storage, e.g. a memory mapped
+  // file. The buffers are not copied and must remain valid while @p storage is
+  // alive.
+  DistortionMesh(std::shared_ptr<const void> storage, const float* vertices,
+                 const float* uvs, int n_vertices, const int* indices,
+                 int n_indices);
   virtual ~DistortionMesh() = default;
   CardboardMesh GetMesh() const;
+  CardboardCompactMesh GetCompactMesh() const;
+
+  // Returns the mesh of the other eye of a viewer whose viewports are the
+  // mirror image of each other with respect to the vertical axis of the
+  // screen. Vertices and texture coordinates are reflected horizontally, so no
+  // inverse distortion is evaluated. Columns are stored in reverse order,
+  // which cancels the reflection, so the index buffer and the triangle
+  // winding are the same as in this mesh.
+  DistortionMesh* CreateHorizontalMirror() const;
+
+  // Returns the smallest resolution whose mesh deviates from the exact inverse
+  // distortion by at most @p max_error_pixels, measured on a screen of
+  // @p screen_width_pixels by @p screen_height_pixels. When the budget cannot
+  // be met, kMaxResolution is returned.
+  static int ComputeResolution(const PolynomialRadialDistortion& distortion,
+                               // Units of the following parameters are
+                               // tan-angle units.
+                               float screen_width, float screen_height,
+                               float x_eye_offset_screen,
+                               float y_eye_offset_screen, float texture_width,
+                               float texture_height, float x_eye_offset_texture,
+                               float y_eye_offset_texture,
+                               float max_error_pixels, int screen_width_pixels,
+                               int screen_height_pixels, Spacing spacing);
 
  private:
-  static constexpr int kResolution = 40;
+  DistortionMesh() = default;
+
   std::vector<int> index_data_;
   std::vector<float> vertex_data_;
   std::vector<float> uvs_data_;
+
+  // Buffers returned by GetMesh(). They point either to the vectors above or
+  // to the memory owned by storage_.
+  std::shared_ptr<const void> storage_;
+  const int* indices_;
+  const float* vertices_;
+  const float* uvs_;
+  int n_indices_;
+  int n_vertices_;
+
+  // Built by the first call to GetCompactMesh().
+  mutable std::mutex compact_mesh_mutex_;
+  mutable std::unique_ptr<CompactMesh> compact_mesh_;
 };
 
 }  // namespace cardboard
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "distortion_mesh_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "util/hash.h"
+#include "util/logging.h"
+
+namespace cardboard {
+
+namespace {
+
+// "CBDM" in ASCII.
+constexpr uint32_t kMagic = 0x4d444243;
+// Must be increased whenever the file layout or the mesh generation changes.
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t device_params_hash;
+  // FNV-1a hash of everything that follows the header.
+  uint64_t checksum;
+  int32_t device_params_size;
+  int32_t display_width;
+  int32_t display_height;
+  int32_t resolution;
+  int32_t n_vertices[2];
+  int32_t n_indices[2];
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0,
+              "FileHeader must keep the payload aligned");
+static_assert(sizeof(int) == sizeof(int32_t),
+              "Mesh indices are stored as 32-bit integers");
+
+constexpr size_t PaddedSize(size_t size) { return (size + 3) & ~size_t{3}; }
+
+// Largest vertex and index counts of a mesh, reached by a triangle strip
+// over a grid of DistortionMesh::kMaxResolution x kMaxResolution vertices.
+constexpr int kMaxVertices =
+    DistortionMesh::kMaxResolution * DistortionMesh::kMaxResolution;
+constexpr int kMaxIndices =
+    2 * (DistortionMesh::kMaxResolution - 1) * DistortionMesh::kMaxResolution +
+    (DistortionMesh::kMaxResolution - 2);
+
+// Counts read from a file are untrusted and must be checked with this before
+// computing sizes from them.
+bool IsValidMeshSize(int n_vertices, int n_indices) {
+  return n_vertices >= 0 && n_vertices <= kMaxVertices && n_indices >= 0 &&
+         n_indices <= kMaxIndices;
+}
+
+size_t MeshSize(int n_vertices, int n_indices) {
+  return 4 * static_cast<size_t>(n_vertices) * sizeof(float) +
+         static_cast<size_t>(n_indices) * sizeof(int32_t);
+}
+
+size_t PayloadSize(const FileHeader& header) {
+  return PaddedSize(static_cast<size_t>(header.device_params_size)) +
+         2 * 4 * sizeof(float) + 2 * 16 * sizeof(float) +
+         MeshSize(header.n_vertices[0], header.n_indices[0]) +
+         MeshSize(header.n_vertices[1], header.n_indices[1]);
+}
+
+// Memory mapping of a whole file.
+struct MappedFile {
+  MappedFile(void* data, size_t size) : data(data), size(size) {}
+  ~MappedFile() { munmap(data, size); }
+
+  void* const data;
+  const size_t size;
+};
+
+std::mutex& DirectoryMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::string& Directory() {
+  static std::string* directory = new std::string();
+  return *directory;
+}
+
+}  // namespace
+
+void DistortionMeshCache::SetDirectory(const std::string& directory) {
+  std::lock_guard<std::mutex> lock(DirectoryMutex());
+  Directory() = directory;
+}
+
+std::string DistortionMeshCache::GetFilePath(
+    const uint8_t* encoded_device_params, int size, int display_width,
+    int display_height, int resolution) {
+  std::lock_guard<std::mutex> lock(DirectoryMutex());
+  if (Directory().empty()) {
+    return std::string();
+  }
+  char file_name[128];
+  snprintf(file_name, sizeof(file_name),
+           "cardboard_distortion_mesh_%016" PRIx64 "_%dx%d_%d.bin",
+           Fnv1aHash(encoded_device_params, size), display_width,
+           display_height, resolution);
+  return Directory() + "/" + file_name;
+}
+
+bool DistortionMeshCache::Load(const uint8_t* encoded_device_params, int size,
+                               int display_width, int display_height,
+                               int resolution, Entry* entry) {
+  const std::string path = GetFilePath(encoded_device_params, size,
+                                       display_width, display_height,
+                                       resolution);
+  if (path.empty()) {
+    return false;
+  }
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(FileHeader)) {
+    close(fd);
+    return false;
+  }
+  const size_t file_size = static_cast<size_t>(file_stat.st_size);
+  void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  std::shared_ptr<const MappedFile> mapping =
+      std::make_shared<const MappedFile>(data, file_size);
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  FileHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      header.device_params_hash != Fnv1aHash(encoded_device_params, size) ||
+      header.device_params_size != size ||
+      header.display_width != display_width ||
+      header.display_height != display_height ||
+      header.resolution != resolution ||
+      !IsValidMeshSize(header.n_vertices[0], header.n_indices[0]) ||
+      !IsValidMeshSize(header.n_vertices[1], header.n_indices[1]) ||
+      sizeof(FileHeader) + PayloadSize(header) != file_size) {
+    CARDBOARD_LOGD("Ignoring mismatching distortion mesh cache file %s.",
+                   path.c_str());
+    return false;
+  }
+
+  const uint8_t* payload = bytes + sizeof(FileHeader);
+  if (header.checksum != Fnv1aHash(payload, file_size - sizeof(FileHeader)) ||
+      std::memcmp(payload, encoded_device_params, size) != 0) {
+    CARDBOARD_LOGD("Ignoring corrupted distortion mesh cache file %s.",
+                   path.c_str());
+    return false;
+  }
+
+  const float* floats = reinterpret_cast<const float*>(
+      payload + PaddedSize(header.device_params_size));
+  for (int eye = 0; eye < 2; eye++) {
+    std::memcpy(entry->fov[eye].data(), floats, 4 * sizeof(float));
+    floats += 4;
+  }
+  for (int eye = 0; eye < 2; eye++) {
+    entry->eye_from_head_matrix[eye] = Matrix4x4::FromArray(floats);
+    floats += 16;
+  }
+  for (int eye = 0; eye < 2; eye++) {
+    const float* vertices = floats;
+    const float* uvs = vertices + 2 * header.n_vertices[eye];
+    const int* indices =
+        reinterpret_cast<const int*>(uvs + 2 * header.n_vertices[eye]);
+    std::shared_ptr<const DistortionMesh> mesh =
+        std::make_shared<const DistortionMesh>(
+            mapping, vertices, uvs, header.n_vertices[eye], indices,
+            header.n_indices[eye]);
+    (eye == 0 ? entry->left_mesh : entry->right_mesh) = mesh;
+    floats = reinterpret_cast<const float*>(indices + header.n_indices[eye]);
+  }
+  return true;
+}
+
+bool DistortionMeshCache::Store(const uint8_t* encoded_device_params, int size,
+                                int display_width, int display_height,
+                                int resolution, const Entry& entry) {
+  const std::string path = GetFilePath(encoded_device_params, size,
+                                       display_width, display_height,
+                                       resolution);
+  if (path.empty()) {
+    return false;
+  }
+
+  const std::array<CardboardMesh, 2> meshes = {entry.left_mesh->GetMesh(),
+                                               entry.right_mesh->GetMesh()};
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.device_params_hash = Fnv1aHash(encoded_device_params, size);
+  header.device_params_size = size;
+  header.display_width = display_width;
+  header.display_height = display_height;
+  header.resolution = resolution;
+  for (int eye = 0; eye < 2; eye++) {
+    header.n_vertices[eye] = meshes[eye].n_vertices;
+    header.n_indices[eye] = meshes[eye].n_indices;
+  }
+
+  std::vector<uint8_t> payload;
+  payload.reserve(PayloadSize(header));
+  auto append = [&payload](const void* data, size_t data_size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    payload.insert(payload.end(), bytes, bytes + data_size);
+  };
+  append(encoded_device_params, size);
+  payload.resize(PaddedSize(payload.size()), 0);
+  for (int eye = 0; eye < 2; eye++) {
+    append(entry.fov[eye].data(), 4 * sizeof(float));
+  }
+  for (int eye = 0; eye < 2; eye++) {
+    float matrix[16];
+    entry.eye_from_head_matrix[eye].ToArray(matrix);
+    append(matrix, sizeof(matrix));
+  }
+  for (int eye = 0; eye < 2; eye++) {
+    append(meshes[eye].vertices, 2 * meshes[eye].n_vertices * sizeof(float));
+    append(meshes[eye].uvs, 2 * meshes[eye].n_vertices * sizeof(float));
+    append(meshes[eye].indices, meshes[eye].n_indices * sizeof(int32_t));
+  }
+  header.checksum = Fnv1aHash(payload.data(), payload.size());
+
+  const std::string temporary_path =
+      path + ".tmp" + std::to_string(static_cast<long>(getpid()));
+  FILE* file = fopen(temporary_path.c_str(), "wb");
+  if (file == nullptr) {
+    CARDBOARD_LOGE("Cannot create distortion mesh cache file %s.",
+                   temporary_path.c_str());
+    return false;
+  }
+  const bool written =
+      fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+  if (fclose(file) != 0 || !written ||
+      rename(temporary_path.c_str(), path.c_str()) != 0) {
+    CARDBOARD_LOGE("Cannot write distortion mesh cache file %s.",
+                   path.c_str());
+    remove(temporary_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace cardboard
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_DISTORTION_MESH_CACHE_H_
+#define CARDBOARD_SDK_DISTORTION_MESH_CACHE_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "distortion_mesh.h"
+#include "util/matrix_4x4.h"
+
+namespace cardboard {
+
+// Persists the distortion meshes, field of view and eye matrices computed for
+// a set of device params, display size and mesh resolution, so they can be
+// memory mapped on later launches instead of being recomputed.
+//
+// Each entry is stored in its own file with the following layout. All the
+// values use the native endianness and every section is 4-byte aligned:
+//
+//   FileHeader
+//   uint8_t encoded_device_params[], padded to a multiple of 4 bytes
+//   float fov[2][4]
+//   float eye_from_head_matrix[2][16]
+//   For each eye:
+//     float vertices[2 * n_vertices]
+//     float uvs[2 * n_vertices]
+//     int32_t indices[n_indices]
+//
+// The header holds the full key and a checksum of the rest of the file. Files
+// with another version, another key or a checksum mismatch are ignored, so
+// callers fall back to computing the entry.
+class DistortionMeshCache {
+ public:
+  struct Entry {
+    std::array<std::array<float, 4>, 2> fov;  // L, R, B, T
+    std::array<Matrix4x4, 2> eye_from_head_matrix;
+    std::shared_ptr<const DistortionMesh> left_mesh;
+    std::shared_ptr<const DistortionMesh> right_mesh;
+  };
+
+  // Sets the directory where cache files are stored. An empty path, the
+  // default, disables the cache.
+  static void SetDirectory(const std::string& directory);
+
+  // Loads the entry for the given key into @p entry. The meshes reference the
+  // memory mapped file, which stays mapped while they are alive. Returns false
+  // when the cache is disabled or there is no valid file for the key.
+  static bool Load(const uint8_t* encoded_device_params, int size,
+                   int display_width, int display_height, int resolution,
+                   Entry* entry);
+
+  // Writes @p entry for the given key. The file is written to a temporary
+  // path and renamed, so readers never observe a partially written file.
+  // Returns false when the cache is disabled or the file cannot be written.
+  static bool Store(const uint8_t* encoded_device_params, int size,
+                    int display_width, int display_height, int resolution,
+                    const Entry& entry);
+
+ private:
+  static std::string GetFilePath(const uint8_t* encoded_device_params,
+                                 int size, int display_width,
+                                 int display_height, int resolution);
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_DISTORTION_MESH_CACHE_H_
@@ -20,6 +20,7 @@
 #include <cstdio>
 
 #include "include/cardboard.h"
+#include "reprojection.h"
 
 namespace cardboard {
 
@@ -29,10 +30,37 @@ class DistortionRenderer {
  public:
   virtual ~DistortionRenderer() = default;
   virtual void SetMesh(const CardboardMesh* mesh, CardboardEye eye) = 0;
+  virtual void SetCompactMesh(const CardboardCompactMesh* mesh,
+                              CardboardEye eye) = 0;
   virtual void RenderEyeToDisplay(
       uint64_t target, int x, int y, int width, int height,
       const CardboardEyeTextureDescription* left_eye,
       const CardboardEyeTextureDescription* right_eye) = 0;
+
+  // Renderers that support reprojection apply the matrices of each eye to the
+  // texture coordinates of the mesh vertices. See reprojection.h.
+  void SetReprojection(const CardboardReprojection* reprojection) {
+    for (CardboardEye eye : {kLeft, kRight}) {
+      reprojection_matrix_[eye] =
+          reprojection == nullptr
+              ? kIdentityReprojectionMatrix
+              : ComputeReprojectionMatrix(*reprojection, eye);
+    }
+  }
+
+  void SetVignetteFill(bool enabled) { vignette_fill_ = enabled; }
+
+ protected:
+  const std::array<float, 9>& GetReprojectionMatrix(CardboardEye eye) const {
+    return reprojection_matrix_[eye];
+  }
+
+  bool IsVignetteFillEnabled() const { return vignette_fill_; }
+
+ private:
+  std::array<std::array<float, 9>, 2> reprojection_matrix_{
+      {kIdentityReprojectionMatrix, kIdentityReprojectionMatrix}};
+  bool vignette_fill_ = false;
 };
 
 }  // namespace cardboard
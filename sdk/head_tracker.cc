@@ -15,7 +15,12 @@
  */
 #include "head_tracker.h"
 
+#include <algorithm>
+
 #include "include/cardboard.h"
+#if defined(__ANDROID__)
+#include "sensors/device_imu_source.h"
+#endif
 #include "sensors/neck_model.h"
 #include "util/logging.h"
 #include "util/rotation.h"
@@ -29,40 +34,42 @@ namespace cardboard {
 // [1]: Landscape right.
 // [2]: Portrait.
 // [3]: Portrait upside down.
-static std::array<Rotation, 4> SensorToDisplayRotations() {
-  static std::array<Rotation, 4> kSensorToDisplayRotations{
+static const std::array<Rotationf, 4>& SensorToDisplayRotations() {
+  static const std::array<Rotationf, 4> kSensorToDisplayRotations{
       // LandscapeLeft: This is the same than initializing the rotation from
       // Rotation::FromAxisAndAngle(Vector3(0., 0., 1.), M_PI / 2.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(
+      Rotationf::FromQuaternion(Rotationf::QuaternionType(
           0., 0., 0.7071067811865476, 0.7071067811865476)),
       // LandscapeRight: This is the same than initializing the rotation from
       // Rotation::FromAxisAndAngle(Vector3(0., 0., 1.), -M_PI / 2.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(
+      Rotationf::FromQuaternion(Rotationf::QuaternionType(
           0., 0., -0.7071067811865476, 0.7071067811865476)),
       // Portrait: This is the same than initializing the rotation from
       // Rotation::FromAxisAndAngle(Vector3(0., 0., 1.), 0.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(0., 0., 0., 1.)),
+      Rotationf::FromQuaternion(Rotationf::QuaternionType(0., 0., 0., 1.)),
       // PortaitUpsideDown: This is the same than initializing the rotation from
       // Rotation::FromAxisAndAngle(Vector3(0., 0., 1.), M_PI).
-      Rotation::FromQuaternion(Rotation::QuaternionType(0., 0., 1., 0.))};
+      Rotationf::FromQuaternion(Rotationf::QuaternionType(0., 0., 1., 0.))};
   return kSensorToDisplayRotations;
 }
 
-static std::array<Rotation, 4> EkfToHeadTrackerRotations() {
-  static std::array<Rotation, 4> kEkfToHeadTrackerRotations{
+static const std::array<Rotationf, 4>& EkfToHeadTrackerRotations() {
+  static const std::array<Rotationf, 4> kEkfToHeadTrackerRotations{
       // LandscapeLeft: This is the same than initializing the rotation from
       // Rotation::FromYawPitchRoll(-M_PI / 2., 0, -M_PI / 2.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(0.5, -0.5, -0.5, 0.5)),
+      Rotationf::FromQuaternion(
+          Rotationf::QuaternionType(0.5, -0.5, -0.5, 0.5)),
       // LandscapeRight: This is the same than initializing the rotation from
       // Rotation::FromYawPitchRoll(M_PI / 2., 0, M_PI / 2.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(0.5, 0.5, 0.5, 0.5)),
+      Rotationf::FromQuaternion(
+          Rotationf::QuaternionType(0.5, 0.5, 0.5, 0.5)),
       // Portrait: This is the same than initializing the rotation from
       // Rotation::FromYawPitchRoll(M_PI / 2., M_PI / 2., M_PI / 2.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(
+      Rotationf::FromQuaternion(Rotationf::QuaternionType(
           0.7071067811865476, 0., 0., 0.7071067811865476)),
       // Portrait upside down: This is the same than initializing the rotation
       // from Rotation::FromYawPitchRoll(-M_PI / 2., -M_PI / 2., -M_PI / 2.).
-      Rotation::FromQuaternion(Rotation::QuaternionType(
+      Rotationf::FromQuaternion(Rotationf::QuaternionType(
           0., -0.7071067811865476, -0.7071067811865476, 0.))};
   return kEkfToHeadTrackerRotations;
 }
@@ -89,9 +96,9 @@ static std::array<Rotation, 4> EkfToHeadTrackerRotations() {
 // | Landscape Right | π   | 0   | π/2 |-π/2 |
 // | Portrait        | π/2 |-π/2 | 0   | π   |
 // | Portrait UD     |-π/2 | π/2 | π   | 0   |
-static std::array<std::array<Rotation, 4>, 4>
+static const std::array<std::array<Rotation, 4>, 4>&
 ViewportChangeRotationCompensation() {
-  static std::array<std::array<Rotation, 4>, 4>
+  static const std::array<std::array<Rotation, 4>, 4>
       kViewportChangeRotationCompensation{{
           // Landscape left.
           {Rotation::Identity(), Rotation::FromYawPitchRoll(0, 0, M_PI),
@@ -117,18 +124,33 @@ HeadTracker::HeadTracker()
     : is_tracking_(false),
       sensor_fusion_(new SensorFusionEkf()),
       latest_gyroscope_data_({0, 0, Vector3::Zero()}),
+#if defined(__ANDROID__)
+      imu_sensor_(new ImuEventProducer([]() {
+        return std::unique_ptr<ImuSampleSource>(new DeviceImuSource());
+      })),
+#else
       accel_sensor_(new SensorEventProducer<AccelerometerData>()),
       gyro_sensor_(new SensorEventProducer<GyroscopeData>()),
+#endif
       is_viewport_orientation_initialized_(false) {
+#if defined(__ANDROID__)
+  on_imu_callback_ = [&](const std::vector<ImuSample>& samples) {
+    OnImuSamples(samples);
+  };
+#else
   on_accel_callback_ = [&](const AccelerometerData& event) {
     OnAccelerometerData(event);
   };
   on_gyro_callback_ = [&](const GyroscopeData& event) {
     OnGyroscopeData(event);
   };
+#endif
 }
 
-HeadTracker::~HeadTracker() { UnregisterCallbacks(); }
+HeadTracker::~HeadTracker() {
+  UnregisterCallbacks();
+  StopTraceRecording();
+}
 
 void HeadTracker::Pause() {
   if (!is_tracking_) {
@@ -156,24 +178,67 @@ void HeadTracker::GetPose(int64_t timestamp_ns,
                           CardboardViewportOrientation viewport_orientation,
                           std::array<float, 3>& out_position,
                           std::array<float, 4>& out_orientation) {
-  const Vector4 orientation =
+  const Vector4f orientation =
       GetRotation(viewport_orientation, timestamp_ns).GetQuaternion();
 
-  if (is_viewport_orientation_initialized_ &&
-      viewport_orientation != viewport_orientation_) {
-    sensor_fusion_->RotateSensorSpaceToStartSpaceTransformation(
-        ViewportChangeRotationCompensation()[viewport_orientation_]
-                                            [viewport_orientation]);
+  SetViewportOrientation(viewport_orientation);
+
+  out_orientation[0] = orientation[0];
+  out_orientation[1] = orientation[1];
+  out_orientation[2] = orientation[2];
+  out_orientation[3] = orientation[3];
+
+  out_position = ApplyNeckModel(out_orientation, 1.0);
+}
+
+void HeadTracker::GetPoses(const int64_t* timestamps_ns, int count,
+                           CardboardViewportOrientation viewport_orientation,
+                           float* out_positions, float* out_orientations) {
+  const SensorFusionEkf::PredictionSnapshot snapshot =
+      sensor_fusion_->GetPredictionSnapshot();
+  const Rotationf& sensor_to_display =
+      SensorToDisplayRotations()[viewport_orientation];
+  const Rotationf& ekf_to_head_tracker =
+      EkfToHeadTrackerRotations()[viewport_orientation];
+
+  for (int i = 0; i < count; ++i) {
+    const Rotationf predicted_rotation(
+        SensorFusionEkf::PredictRotation(snapshot, timestamps_ns[i]));
+    const Vector4f orientation =
+        (sensor_to_display * predicted_rotation * ekf_to_head_tracker)
+            .GetQuaternion();
+    const std::array<float, 4> pose_orientation{
+        orientation[0], orientation[1], orientation[2], orientation[3]};
+    const std::array<float, 3> pose_position =
+        ApplyNeckModel(pose_orientation, 1.0);
+    std::copy(pose_orientation.begin(), pose_orientation.end(),
+              out_orientations + 4 * i);
+    std::copy(pose_position.begin(), pose_position.end(),
+              out_positions + 3 * i);
   }
-  viewport_orientation_ = viewport_orientation;
-  is_viewport_orientation_initialized_ = true;
 
-  out_orientation[0] = static_cast<float>(orientation[0]);
-  out_orientation[1] = static_cast<float>(orientation[1]);
-  out_orientation[2] = static_cast<float>(orientation[2]);
-  out_orientation[3] = static_cast<float>(orientation[3]);
+  SetViewportOrientation(viewport_orientation);
+}
+
+bool HeadTracker::GetPastPose(int64_t timestamp_ns,
+                              CardboardViewportOrientation viewport_orientation,
+                              std::array<float, 3>& out_position,
+                              std::array<float, 4>& out_orientation) const {
+  Rotation sensor_from_start;
+  if (!sensor_fusion_->GetRotationAt(timestamp_ns, &sensor_from_start)) {
+    return false;
+  }
+  const Vector4f orientation =
+      ToDisplayRotation(viewport_orientation, sensor_from_start)
+          .GetQuaternion();
+
+  out_orientation[0] = orientation[0];
+  out_orientation[1] = orientation[1];
+  out_orientation[2] = orientation[2];
+  out_orientation[3] = orientation[3];
 
   out_position = ApplyNeckModel(out_orientation, 1.0);
+  return true;
 }
 
 void HeadTracker::Recenter() {
@@ -184,14 +249,62 @@ void HeadTracker::SetLowPassFilter(const int cutoff_frequency) {
   sensor_fusion_->SetLowPassFilter(cutoff_frequency);
 }
 
+void HeadTracker::SetPosePrediction(
+    const SensorFusionEkf::PredictionParams& params) {
+  sensor_fusion_->SetPredictionParams(params);
+}
+
+SensorFusionEkf::PredictionParams HeadTracker::GetPosePrediction() const {
+  return sensor_fusion_->GetPredictionParams();
+}
+
+bool HeadTracker::StartTraceRecording(const std::string& path) {
+  StopTraceRecording();
+  std::shared_ptr<ImuTraceWriter> trace_writer(new ImuTraceWriter());
+  if (!trace_writer->Open(path)) {
+    return false;
+  }
+  trace_writer_ = trace_writer;
+#if defined(__ANDROID__)
+  imu_sensor_->SetTraceWriter(trace_writer_);
+#else
+  accel_sensor_->SetTraceWriter(trace_writer_);
+  gyro_sensor_->SetTraceWriter(trace_writer_);
+#endif
+  return true;
+}
+
+void HeadTracker::StopTraceRecording() {
+  if (!trace_writer_) {
+    return;
+  }
+#if defined(__ANDROID__)
+  imu_sensor_->SetTraceWriter(nullptr);
+#else
+  accel_sensor_->SetTraceWriter(nullptr);
+  gyro_sensor_->SetTraceWriter(nullptr);
+#endif
+  // Samples being recorded by a sensor thread are dropped after closing.
+  trace_writer_->Close();
+  trace_writer_.reset();
+}
+
 void HeadTracker::RegisterCallbacks() {
+#if defined(__ANDROID__)
+  imu_sensor_->StartSensorPolling(&on_imu_callback_);
+#else
   accel_sensor_->StartSensorPolling(&on_accel_callback_);
   gyro_sensor_->StartSensorPolling(&on_gyro_callback_);
+#endif
 }
 
 void HeadTracker::UnregisterCallbacks() {
+#if defined(__ANDROID__)
+  imu_sensor_->StopSensorPolling();
+#else
   accel_sensor_->StopSensorPolling();
   gyro_sensor_->StopSensorPolling();
+#endif
 }
 
 void HeadTracker::OnAccelerometerData(const AccelerometerData& event) {
@@ -209,17 +322,50 @@ void HeadTracker::OnGyroscopeData(const GyroscopeData& event) {
   sensor_fusion_->ProcessGyroscopeSample(event);
 }
 
-Rotation HeadTracker::GetRotation(
+void HeadTracker::OnImuSamples(const std::vector<ImuSample>& samples) {
+  if (!is_tracking_) {
+    return;
+  }
+  for (auto it = samples.rbegin(); it != samples.rend(); ++it) {
+    if (it->type == ImuSample::Type::kGyroscope) {
+      latest_gyroscope_data_ = it->gyroscope;
+      break;
+    }
+  }
+  sensor_fusion_->ProcessSamples(samples);
+}
+
+void HeadTracker::SetViewportOrientation(
+    CardboardViewportOrientation viewport_orientation) {
+  if (is_viewport_orientation_initialized_ &&
+      viewport_orientation != viewport_orientation_) {
+    sensor_fusion_->RotateSensorSpaceToStartSpaceTransformation(
+        ViewportChangeRotationCompensation()[viewport_orientation_]
+                                            [viewport_orientation]);
+  }
+  viewport_orientation_ = viewport_orientation;
+  is_viewport_orientation_initialized_ = true;
+}
+
+Rotationf HeadTracker::GetRotation(
     CardboardViewportOrientation viewport_orientation,
     int64_t timestamp_ns) const {
-  const Rotation predicted_rotation =
-      sensor_fusion_->PredictRotation(timestamp_ns);
+  return ToDisplayRotation(viewport_orientation,
+                           sensor_fusion_->PredictRotation(timestamp_ns));
+}
+
+Rotationf HeadTracker::ToDisplayRotation(
+    CardboardViewportOrientation viewport_orientation,
+    const Rotation& sensor_from_start) const {
+  // The fused state is kept in double precision, but the pose is returned in
+  // single precision, so the display space composition is done in float.
+  const Rotationf rotation(sensor_from_start);
 
   // In order to update our pose as the sensor changes, we begin with the
   // inverse default orientation (the orientation returned by a reset sensor,
   // i.e. since the last Reset() call), apply the current sensor transformation,
   // and then transform into display space.
-  return SensorToDisplayRotations()[viewport_orientation] * predicted_rotation *
+  return SensorToDisplayRotations()[viewport_orientation] * rotation *
          EkfToHeadTrackerRotations()[viewport_orientation];
 }
 
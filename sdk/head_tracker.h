@@ -17,12 +17,18 @@
 #define CARDBOARD_SDK_HEAD_TRACKER_H_
 
 #include <array>
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <string>
+#include <vector>
 
 #include "include/cardboard.h"
 #include "sensors/accelerometer_data.h"
 #include "sensors/gyroscope_data.h"
+#include "sensors/imu_event_producer.h"
+#include "sensors/imu_sample.h"
+#include "sensors/imu_trace.h"
 #include "sensors/sensor_event_producer.h"
 #include "sensors/sensor_fusion_ekf.h"
 #include "util/rotation.h"
@@ -49,12 +55,50 @@ class HeadTracker {
                std::array<float, 3>& out_position,
                std::array<float, 4>& out_orientation);
 
+  // Gets the predicted poses for several timestamps from a single snapshot of
+  // the sensor fusion state.
+  //
+  // @param timestamps_ns @p count timestamps.
+  // @param count number of poses.
+  // @param viewport_orientation viewport orientation of all the poses.
+  // @param out_positions 3 * @p count floats, (x, y, z) for each pose.
+  // @param out_orientations 4 * @p count floats, a quaternion for each pose.
+  void GetPoses(const int64_t* timestamps_ns, int count,
+                CardboardViewportOrientation viewport_orientation,
+                float* out_positions, float* out_orientations);
+
+  // Gets the pose for a given timestamp of the last few hundred milliseconds,
+  // interpolated from the fused rotations. Timestamps after the latest sensor
+  // sample are predicted like in GetPose(). Unlike GetPose(), it does not
+  // track viewport orientation changes.
+  //
+  // @return false if there is no pose for @p timestamp_ns.
+  bool GetPastPose(int64_t timestamp_ns,
+                   CardboardViewportOrientation viewport_orientation,
+                   std::array<float, 3>& out_position,
+                   std::array<float, 4>& out_orientation) const;
+
   // Recenters the head tracker.
   void Recenter();
 
   // Sets low pass filter to the head tracker.
   void SetLowPassFilter(int cutoff_frequency);
 
+  // Sets the model and the tuning of the pose prediction.
+  void SetPosePrediction(const SensorFusionEkf::PredictionParams& params);
+
+  // Gets the model and the tuning of the pose prediction.
+  SensorFusionEkf::PredictionParams GetPosePrediction() const;
+
+  // Starts recording the sensor samples into an IMU trace at @p path,
+  // replacing any recording in progress.
+  //
+  // @return false if the trace could not be created.
+  bool StartTraceRecording(const std::string& path);
+
+  // Stops the recording in progress, if any.
+  void StopTraceRecording();
+
  private:
   // Function called when receiving AccelerometerData.
   //
@@ -66,6 +110,12 @@ class HeadTracker {
   // @param event sensor event.
   void OnGyroscopeData(const GyroscopeData& event);
 
+  // Function called when receiving a time ordered batch of samples of both
+  // sensors.
+  //
+  // @param samples sensor events.
+  void OnImuSamples(const std::vector<ImuSample>& samples);
+
   // Registers this as a listener for data from the accel and gyro sensors. This
   // is useful for informing the sensors that they may need to start polling for
   // data.
@@ -75,9 +125,19 @@ class HeadTracker {
   // polling for data.
   void UnregisterCallbacks();
 
+  // Compensates the sensor fusion for a change of viewport orientation since
+  // the previous pose query.
+  void SetViewportOrientation(
+      CardboardViewportOrientation viewport_orientation);
+
   // Gets the predicted rotation for a given timestamp and viewport orientation.
-  Rotation GetRotation(CardboardViewportOrientation viewport_orientation,
-                       int64_t timestamp_ns) const;
+  Rotationf GetRotation(CardboardViewportOrientation viewport_orientation,
+                        int64_t timestamp_ns) const;
+
+  // Transforms a rotation from Start to Sensor Space into display space for
+  // the given viewport orientation.
+  Rotationf ToDisplayRotation(CardboardViewportOrientation viewport_orientation,
+                              const Rotation& sensor_from_start) const;
 
   std::atomic<bool> is_tracking_;
   // Sensor Fusion object that stores the internal state of the filter.
@@ -85,6 +145,14 @@ class HeadTracker {
   // Latest gyroscope data.
   GyroscopeData latest_gyroscope_data_;
 
+#if defined(__ANDROID__)
+  // Event provider polling both sensors from a single thread and supplying
+  // their samples to the detector in timestamp order.
+  std::unique_ptr<ImuEventProducer> imu_sensor_;
+
+  // Callback function registered to imu_sensor_.
+  ImuEventProducer::Callback on_imu_callback_;
+#else
   // Event providers supplying AccelerometerData and GyroscopeData to the
   // detector.
   std::shared_ptr<SensorEventProducer<AccelerometerData>> accel_sensor_;
@@ -93,6 +161,10 @@ class HeadTracker {
   // Callback functions registered to the input SingleTypeEventProducer.
   std::function<void(AccelerometerData)> on_accel_callback_;
   std::function<void(GyroscopeData)> on_gyro_callback_;
+#endif
+
+  // Trace being recorded, or nullptr.
+  std::shared_ptr<ImuTraceWriter> trace_writer_;
 
   // Orientation of the viewport. It is initialized in the first call of
   // GetPose().
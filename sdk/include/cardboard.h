@@ -75,6 +75,16 @@ typedef enum CardboardSupportedOpenGlEsTextureType {
   kGlTextureExternalOes = 1,
 } CardboardSupportedOpenGlEsTextureType;
 
+/// Enum to distinguish the models used by the head tracker to predict the
+/// pose at a future time.
+typedef enum CardboardPosePredictionModel {
+  /// Extrapolates the current angular velocity. This is the default.
+  kConstantVelocityPrediction = 0,
+  /// Extrapolates the current angular velocity and angular acceleration. It
+  /// follows the start and the end of head turns more closely.
+  kConstantAccelerationPrediction = 1,
+} CardboardPosePredictionModel;
+
 /// Struct representing a 3D mesh with 3D vertices and corresponding UV
 /// coordinates.
 typedef struct CardboardMesh {
@@ -90,6 +100,24 @@ typedef struct CardboardMesh {
   int n_vertices;
 } CardboardMesh;
 
+/// Struct representing a distortion mesh in a compact layout. Vertex
+/// attributes are interleaved and stored as normalized signed 16-bit integers
+/// (i.e. value / 32767) and indices are 16-bit. It takes less than half of the
+/// memory and vertex fetch bandwidth of CardboardMesh.
+typedef struct CardboardCompactMesh {
+  /// Indices buffer.
+  uint16_t* indices;
+  /// Number of indices.
+  int n_indices;
+  /// Vertices buffer. 4 normalized values per vertex: x, y, u, v. x and y must
+  /// be multiplied by @c position_scale. u and v are in the [0, 1] range.
+  int16_t* vertices;
+  /// Number of vertices.
+  int n_vertices;
+  /// Scale of the vertex positions. It is greater than or equal to 1.
+  float position_scale;
+} CardboardCompactMesh;
+
 /// Struct to hold information about an eye texture.
 typedef struct CardboardEyeTextureDescription {
   /// The texture with eye pixels.
@@ -137,10 +165,49 @@ typedef struct CardboardEyeTextureDescription {
   float bottom_v;
 } CardboardEyeTextureDescription;
 
+/// Struct to set the rotational reprojection of the eye textures, which moves
+/// them to a head orientation fresher than the one they were rendered with.
+typedef struct CardboardReprojection {
+  /// Head orientation quaternion that the eye textures were rendered with, as
+  /// returned by @c ::CardboardHeadTracker_getPose.
+  float render_orientation[4];
+  /// Head orientation quaternion predicted for the time the frame is
+  /// displayed, as returned by @c ::CardboardHeadTracker_getPose.
+  float display_orientation[4];
+  /// Field of view half angles of each eye texture, indexed by
+  /// @c CardboardEye, as returned by
+  /// @c ::CardboardLensDistortion_getFieldOfView.
+  float field_of_view[2][4];
+} CardboardReprojection;
+
+/// Struct to configure the pose prediction of the head tracker.
+typedef struct CardboardPosePredictionParams {
+  /// Prediction model.
+  CardboardPosePredictionModel model;
+  /// With kConstantAccelerationPrediction, the angular acceleration is applied
+  /// during at most this many seconds of the extrapolation, in [0, 0.2].
+  /// Defaults to 0.06.
+  float max_horizon_s;
+  /// Time constant in seconds of the low-pass filter applied to the angular
+  /// acceleration estimate, in [0.001, 1]. Longer values are less noisy but
+  /// react later. Defaults to 0.03.
+  float acceleration_time_constant_s;
+  /// Norm in radians per second squared above which the angular acceleration
+  /// estimate is clamped, non-negative. Defaults to 40.
+  float max_angular_acceleration;
+} CardboardPosePredictionParams;
+
 /// Struct to set OpenGL ES distortion renderer configuration.
 typedef struct CardboardOpenGlEsDistortionRendererConfig {
   /// Texture type.
   CardboardSupportedOpenGlEsTextureType texture_type;
+  /// Nonzero when the caller guarantees that the OpenGL ES state left by
+  /// @c ::CardboardDistortionRenderer_renderEyeToDisplay is not modified
+  /// until the next call, and that the eye textures are not deleted while
+  /// they are rendered. The renderer then only sets the state that changes
+  /// between calls and does not restore it at the end of them. Only used by
+  /// @c ::CardboardOpenGlEs3DistortionRenderer_create. Defaults to 0.
+  int caller_guarantees_state;
 } CardboardOpenGlEsDistortionRendererConfig;
 
 /// Struct to set Metal distortion renderer configuration.
@@ -308,6 +375,10 @@ void Cardboard_initializeAndroid(JavaVM* vm, jobject context);
 /// Creates a new lens distortion object and initializes it with the values from
 /// @c encoded_device_params.
 ///
+/// The field of view, eye matrices and distortion meshes derived from the
+/// arguments are kept in a process-wide cache, so creating a lens distortion
+/// object with arguments that were recently used is cheap.
+///
 /// @pre @p encoded_device_params Must not be null.
 /// When it is unmet, a call to this function results in a no-op and returns a
 /// @c nullptr.
@@ -331,6 +402,37 @@ CardboardLensDistortion* CardboardLensDistortion_create(
 /// @param[in]      lens_distortion         Lens distortion object pointer.
 void CardboardLensDistortion_destroy(CardboardLensDistortion* lens_distortion);
 
+/// Gets the number of CardboardLensDistortion_create() calls that were served
+/// from the lens distortion cache and the number that had to compute the
+/// distortion, since start up or the last call to
+/// CardboardLensDistortion_clearCache().
+///
+/// @pre @p hits Must not be null.
+/// @pre @p misses Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[out]     hits                    Number of cache hits.
+/// @param[out]     misses                  Number of cache misses.
+void CardboardLensDistortion_getCacheStatistics(int64_t* hits,
+                                                int64_t* misses);
+
+/// Removes every entry from the lens distortion cache and resets its counters.
+/// Existing lens distortion objects are not affected.
+void CardboardLensDistortion_clearCache();
+
+/// Sets the directory where lens distortion objects persist their distortion
+/// meshes, field of view and eye matrices. When a lens distortion object is
+/// created with arguments whose results are already stored in this directory,
+/// they are memory mapped instead of computed. Invalid or outdated files are
+/// ignored and overwritten. The persistent cache is disabled by default.
+///
+/// The application is responsible for providing a writable directory, e.g. its
+/// cache directory.
+///
+/// @param[in]      directory               Path to the directory. A nullptr
+///     or an empty string disables the persistent cache.
+void CardboardLensDistortion_setPersistentCacheDirectory(const char* directory);
+
 /// Gets the eye_from_head matrix for a particular eye.
 ///
 /// @pre @p lens_distortion Must not be null.
@@ -394,6 +496,106 @@ void CardboardLensDistortion_getDistortionMesh(
     CardboardLensDistortion* lens_distortion, CardboardEye eye,
     CardboardMesh* mesh);
 
+/// Gets the distortion mesh for a particular eye in the compact layout. It is
+/// built the first time it is requested.
+///
+/// @pre @p lens_distortion Must not be null.
+/// @pre @p mesh Must not be null.
+/// When it is unmet, a call to this function results in a no-op and a default
+/// value is returned (empty values).
+///
+/// Important: The distorsion mesh that is returned by this function becomes
+/// invalid if CardboardLensDistortion is destroyed.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      eye                     Desired eye.
+/// @param[out]     mesh                    Compact distortion mesh.
+void CardboardLensDistortion_getCompactDistortionMesh(
+    CardboardLensDistortion* lens_distortion, CardboardEye eye,
+    CardboardCompactMesh* mesh);
+
+/// Rebuilds the distortion meshes of both eyes as uniform grids of
+/// @p resolution x @p resolution vertices. The default resolution is 40.
+/// Values are clamped to the [2, 128] range.
+///
+/// @pre @p lens_distortion Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// Important: Distortion meshes previously returned by
+/// CardboardLensDistortion_getDistortionMesh() become invalid.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      resolution              Vertices per row and per column.
+void CardboardLensDistortion_setDistortionMeshResolution(
+    CardboardLensDistortion* lens_distortion, int resolution);
+
+/// Rebuilds the distortion meshes of both eyes with the fewest vertices whose
+/// deviation from the exact lens distortion is at most @p max_error_pixels
+/// display pixels. Vertices are concentrated where the distortion curves the
+/// most, usually towards the edges of the lenses.
+///
+/// @pre @p lens_distortion Must not be null.
+/// @pre @p max_error_pixels Must be greater than zero.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// Important: Distortion meshes previously returned by
+/// CardboardLensDistortion_getDistortionMesh() become invalid.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      max_error_pixels        Error budget in display pixels.
+void CardboardLensDistortion_setDistortionMeshMaxError(
+    CardboardLensDistortion* lens_distortion, float max_error_pixels);
+
+/// Gets the recommended size of the render target of an eye texture, in
+/// pixels.
+///
+/// With a @p quality of 1, the texture pixels are as dense as the display
+/// pixels where the lens distortion stretches the texture the most, usually
+/// at the center of the lens. Larger sizes waste fill rate and memory without
+/// adding detail.
+///
+/// @pre @p lens_distortion Must not be null.
+/// @pre @p quality Must be greater than zero.
+/// @pre @p width Must not be null.
+/// @pre @p height Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      eye                     Desired eye.
+/// @param[in]      quality                 Scale of the size, e.g. 0.8 for
+///     80% of the pixel density of the display.
+/// @param[out]     width                   Width of the render target.
+/// @param[out]     height                  Height of the render target.
+void CardboardLensDistortion_getRecommendedRenderTargetSize(
+    CardboardLensDistortion* lens_distortion, CardboardEye eye, float quality,
+    int* width, int* height);
+
+/// Gets the pixel density that an eye texture needs as a function of the
+/// distance to the optical center of the lens, so that the regions that the
+/// display compresses can be rendered with fewer pixels (fixed foveation).
+///
+/// Samples are uniformly spaced from the optical center to the farthest corner
+/// of the texture, in tan-angle units. The optical center is at the texture
+/// coordinates (tan(left) / (tan(left) + tan(right)), tan(bottom) /
+/// (tan(bottom) + tan(top))) of the field of view returned by
+/// @c ::CardboardLensDistortion_getFieldOfView. Densities are relative to the
+/// one of @c ::CardboardLensDistortion_getRecommendedRenderTargetSize with a
+/// quality of 1.
+///
+/// @pre @p lens_distortion Must not be null.
+/// @pre @p density_map Must not be null.
+/// @pre @p count Must be greater than zero.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      eye                     Desired eye.
+/// @param[in]      count                   Number of samples.
+/// @param[out]     density_map             Array of @p count relative
+///     densities.
+void CardboardLensDistortion_getPixelDensityMap(
+    CardboardLensDistortion* lens_distortion, CardboardEye eye, int32_t count,
+    float* density_map);
+
 /// Applies lens inverse distortion function to a point normalized [0,1] in
 /// pre-distortion (eye texture) space.
 ///
@@ -426,6 +628,65 @@ CardboardUv CardboardLensDistortion_undistortedUvForDistortedUv(
 CardboardUv CardboardLensDistortion_distortedUvForUndistortedUv(
     CardboardLensDistortion* lens_distortion, const CardboardUv* undistorted_uv,
     CardboardEye eye);
+
+/// Applies lens inverse distortion function to an array of points normalized
+/// [0,1] in pre-distortion (eye texture) space. It is equivalent to calling
+/// CardboardLensDistortion_undistortedUvForDistortedUv() for each point, but
+/// the per call overhead is paid only once.
+///
+/// @pre @p lens_distortion Must not be null.
+/// @pre @p distorted_u, @p distorted_v, @p undistorted_u and @p undistorted_v
+///     Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// The output arrays may alias the input ones.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      distorted_u             U coordinates of the distorted
+///     points.
+/// @param[in]      distorted_v             V coordinates of the distorted
+///     points.
+/// @param[in]      count                   Number of points. Nothing is done if
+///     it is not positive.
+/// @param[in]      eye                     Desired eye.
+/// @param[out]     undistorted_u           U coordinates of the points
+///     normalized [0,1] in the screen post distort space.
+/// @param[out]     undistorted_v           V coordinates of the points
+///     normalized [0,1] in the screen post distort space.
+void CardboardLensDistortion_undistortedUvForDistortedUvBatch(
+    CardboardLensDistortion* lens_distortion, const float* distorted_u,
+    const float* distorted_v, int count, CardboardEye eye,
+    float* undistorted_u, float* undistorted_v);
+
+/// Applies lens distortion function to an array of points normalized [0,1] in
+/// the screen post-distortion space. It is equivalent to calling
+/// CardboardLensDistortion_distortedUvForUndistortedUv() for each point, but
+/// the per call overhead is paid only once and the distortion polynomial is
+/// evaluated with SIMD instructions when available.
+///
+/// @pre @p lens_distortion Must not be null.
+/// @pre @p undistorted_u, @p undistorted_v, @p distorted_u and @p distorted_v
+///     Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// The output arrays may alias the input ones.
+///
+/// @param[in]      lens_distortion         Lens distortion object pointer.
+/// @param[in]      undistorted_u           U coordinates of the undistorted
+///     points.
+/// @param[in]      undistorted_v           V coordinates of the undistorted
+///     points.
+/// @param[in]      count                   Number of points. Nothing is done if
+///     it is not positive.
+/// @param[in]      eye                     Desired eye.
+/// @param[out]     distorted_u             U coordinates of the points
+///     normalized [0,1] in pre distort space (eye texture space).
+/// @param[out]     distorted_v             V coordinates of the points
+///     normalized [0,1] in pre distort space (eye texture space).
+void CardboardLensDistortion_distortedUvForUndistortedUvBatch(
+    CardboardLensDistortion* lens_distortion, const float* undistorted_u,
+    const float* undistorted_v, int count, CardboardEye eye,
+    float* distorted_u, float* distorted_v);
 /// @}
 
 /////////////////////////////////////////////////////////////////////////////
@@ -453,6 +714,20 @@ CardboardDistortionRenderer* CardboardOpenGlEs2DistortionRenderer_create(
 CardboardDistortionRenderer* CardboardOpenGlEs3DistortionRenderer_create(
     const CardboardOpenGlEsDistortionRendererConfig* config);
 
+/// Gets the number of OpenGL ES calls issued by the last call to
+/// @c ::CardboardDistortionRenderer_renderEyeToDisplay of an OpenGL ES 3.0
+/// distortion renderer. Must be called from the render thread.
+///
+/// @pre @p renderer Must not be null and must have been created by
+///     @c ::CardboardOpenGlEs3DistortionRenderer_create.
+/// When it is unmet, a call to this function results in a no-op and returns
+/// 0.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @return         Number of OpenGL ES calls.
+int CardboardOpenGlEs3DistortionRenderer_getGlCallCount(
+    const CardboardDistortionRenderer* renderer);
+
 /// Creates a new distortion renderer object. It uses Metal as the rendering
 /// API. Must be called from the render thread.
 ///
@@ -469,6 +744,71 @@ CardboardDistortionRenderer* CardboardMetalDistortionRenderer_create(
 CardboardDistortionRenderer* CardboardVulkanDistortionRenderer_create(
     const CardboardVulkanDistortionRendererConfig* config);
 
+/// Builds the pipeline of a Vulkan distortion renderer for a render pass ahead
+/// of time, so that the first frame rendered with it does not compile it. Must
+/// be called from render thread.
+///
+/// Only the pipeline of the last render pass passed to this function or used
+/// for rendering is kept. Switching to another render pass builds its
+/// pipeline again, through the pipeline cache.
+///
+/// @pre @p renderer Must not be null and must have been created by
+///     @c ::CardboardVulkanDistortionRenderer_create.
+/// @pre @p vk_render_pass Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @param[in]      vk_render_pass          Render pass that will be used in
+///     @c CardboardVulkanDistortionRendererTarget. This field holds an address
+///     pointing to a [VkRenderPass
+///     value](https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkRenderPass.html).
+void CardboardVulkanDistortionRenderer_prepareRenderPass(
+    CardboardDistortionRenderer* renderer, uint64_t vk_render_pass);
+
+/// Adds serialized pipeline cache data to a Vulkan distortion renderer, so that
+/// its pipelines are not compiled again, and sets the file the pipeline cache
+/// is saved to when the renderer is destroyed. Must be called from render
+/// thread, before @c ::CardboardVulkanDistortionRenderer_prepareRenderPass or
+/// the first frame for the data to be of use.
+///
+/// Renderers also start from the pipeline cache of the last renderer destroyed
+/// in the process. Data from another device or driver is ignored.
+///
+/// @pre @p renderer Must not be null and must have been created by
+///     @c ::CardboardVulkanDistortionRenderer_create.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @param[in]      data                    Serialized pipeline cache, as
+///     returned by @c ::CardboardVulkanDistortionRenderer_getPipelineCacheData.
+///     It may be null. It is copied, so it may be released after the call.
+/// @param[in]      size                    Size of @p data in bytes.
+/// @param[in]      path                    File the pipeline cache is loaded
+///     from when @p data is null or not valid, and saved to when the renderer
+///     is destroyed. It may be null.
+void CardboardVulkanDistortionRenderer_setPipelineCache(
+    CardboardDistortionRenderer* renderer, const uint8_t* data, int32_t size,
+    const char* path);
+
+/// Gets the serialized pipeline cache of a Vulkan distortion renderer, so that
+/// it can be persisted and passed to
+/// @c ::CardboardVulkanDistortionRenderer_setPipelineCache later. Must be
+/// called from render thread.
+///
+/// @pre @p renderer Must not be null and must have been created by
+///     @c ::CardboardVulkanDistortionRenderer_create.
+/// @pre @p size Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @param[out]     data                    Buffer where the data is written.
+///     When it is null, only the size of the data is returned.
+/// @param[in, out] size                    Size of @p data in bytes. It is
+///     set to the number of bytes written, or to the size of the data when
+///     @p data is null.
+void CardboardVulkanDistortionRenderer_getPipelineCacheData(
+    CardboardDistortionRenderer* renderer, uint8_t* data, int32_t* size);
+
 /// Destroys and releases memory used by the provided distortion renderer
 /// object. Must be called from render thread.
 ///
@@ -492,9 +832,75 @@ void CardboardDistortionRenderer_setMesh(CardboardDistortionRenderer* renderer,
                                          const CardboardMesh* mesh,
                                          CardboardEye eye);
 
+/// Sets the distortion Mesh for a particular eye in the compact layout. Must be
+/// called from render thread.
+///
+/// Compact meshes take half the memory and bandwidth of the ones set with
+/// @c ::CardboardDistortionRenderer_setMesh, at the cost of 16-bit precision.
+/// The OpenGL ES renderers only draw both eyes with a single call when the
+/// meshes of both eyes are compact.
+///
+/// @pre @p renderer Must not be null.
+/// @pre @p mesh Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @param[in]      mesh                    Compact distortion mesh.
+/// @param[in]      eye                     Desired eye.
+void CardboardDistortionRenderer_setCompactMesh(
+    CardboardDistortionRenderer* renderer, const CardboardCompactMesh* mesh,
+    CardboardEye eye);
+
+/// Sets the rotational reprojection that the following calls to
+/// @c ::CardboardDistortionRenderer_renderEyeToDisplay apply to the eye
+/// textures. Must be called from render thread.
+///
+/// The rotation between the render and the display orientations is applied to
+/// the texture coordinates of the distortion mesh vertices, which hides the
+/// head motion that happens while the eye textures are rendered. Translation
+/// is not reprojected. The borders of the eye textures are stretched into the
+/// area they do not cover. It is only applied by the OpenGL ES renderers.
+///
+/// @pre @p renderer Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @param[in]      reprojection            Reprojection to apply. When it is
+///     null, the eye textures are no longer reprojected.
+void CardboardDistortionRenderer_setReprojection(
+    CardboardDistortionRenderer* renderer,
+    const CardboardReprojection* reprojection);
+
+/// Sets whether the following calls to
+/// @c ::CardboardDistortionRenderer_renderEyeToDisplay fill the part of the
+/// rectangle that the distortion meshes do not cover with black instead of
+/// clearing the color buffer. Must be called from render thread. It is
+/// disabled by default.
+///
+/// The fill is only applied by the OpenGL ES renderers, when the meshes are
+/// compact and each one lies on its own half of the rectangle. The previous
+/// content of the color buffer is invalidated first, so that tile-based GPUs
+/// do not load it. OpenGL ES 3.0 invalidates the rectangle and leaves the
+/// pixels outside of it unchanged. OpenGL ES 2.0 discards the whole color
+/// buffer when @c GL_EXT_discard_framebuffer is supported, which leaves the
+/// pixels outside of the rectangle undefined. Otherwise, the whole color
+/// buffer is cleared.
+///
+/// @pre @p renderer Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      renderer                Distortion renderer object pointer.
+/// @param[in]      enabled                 Nonzero to fill only the part of
+///     the rectangle that the meshes do not cover.
+void CardboardDistortionRenderer_setVignetteFill(
+    CardboardDistortionRenderer* renderer, int enabled);
+
 /// Renders eye textures to a rectangle in the display. Must be called from
 /// render thread.
 ///
+/// See @c ::CardboardDistortionRenderer_setVignetteFill for how the color
+/// buffer is cleared.
+///
 /// @pre @p renderer Must not be null.
 /// @pre @p left_eye Must not be null.
 /// @pre @p right_eye Must not be null.
@@ -619,6 +1025,69 @@ void CardboardHeadTracker_getPose(
     CardboardViewportOrientation viewport_orientation, float* position,
     float* orientation);
 
+/// Gets the predicted head poses for several timestamps, e.g. one per eye or
+/// one per band of a display that scans out progressively. All the poses are
+/// predicted from the same head tracker state, and calling this function once
+/// costs less than calling CardboardHeadTracker_getPose() for each timestamp.
+///
+/// @details The timestamps are in the same clock as in
+///          CardboardHeadTracker_getPose().
+///
+/// @pre @p head_tracker Must not be null.
+/// @pre @p timestamps_ns Must not be null.
+/// @pre @p positions Must not be null.
+/// @pre @p orientations Must not be null.
+/// When it is unmet, a call to this function results in a no-op and default
+/// values are returned in the non-null output arrays (zero values and identity
+/// quaternions, respectively).
+///
+/// @param[in]      head_tracker            Head tracker object pointer.
+/// @param[in]      timestamps_ns           @p count timestamps for the poses in
+///                                         nanoseconds.
+/// @param[in]      count                   Number of poses. Nothing is done if
+///                                         it is not positive.
+/// @param[in]      viewport_orientation    The viewport orientation.
+/// @param[out]     positions               3 * @p count floats, (x, y, z) for
+///                                         each pose.
+/// @param[out]     orientations            4 * @p count floats, a quaternion
+///                                         for each pose.
+void CardboardHeadTracker_getPoses(
+    CardboardHeadTracker* head_tracker, const int64_t* timestamps_ns,
+    int32_t count, CardboardViewportOrientation viewport_orientation,
+    float* positions, float* orientations);
+
+/// Gets the head pose at a past timestamp, interpolated between the poses
+/// fused after each gyroscope sample of the last few hundred milliseconds (at
+/// least 512 samples). It can be used to get the pose at which a frame was
+/// rendered or a camera image was captured.
+///
+/// @details Timestamps after the latest gyroscope sample are predicted like
+///          in CardboardHeadTracker_getPose(). The history restarts when the
+///          head tracker is recentered and when the viewport orientation
+///          changes. @p timestamp_ns is in the same clock as in
+///          CardboardHeadTracker_getPose().
+///
+/// @pre @p head_tracker Must not be null.
+/// @pre @p position Must not be null.
+/// @pre @p orientation Must not be null.
+/// When it is unmet, a call to this function results in a no-op, default
+/// values are returned (zero values and identity quaternion, respectively)
+/// and 0 is returned.
+///
+/// @param[in]      head_tracker            Head tracker object pointer.
+/// @param[in]      timestamp_ns            The timestamp for the pose in
+///                                         nanoseconds.
+/// @param[in]      viewport_orientation    The viewport orientation.
+/// @param[out]     position                3 floats for (x, y, z).
+/// @param[out]     orientation             4 floats for quaternion
+/// @return 1 if the pose was found, or 0 with default values if
+///         @p timestamp_ns is older than the history or if the head tracker
+///         has not fused any sample yet.
+int CardboardHeadTracker_getPastPose(
+    CardboardHeadTracker* head_tracker, int64_t timestamp_ns,
+    CardboardViewportOrientation viewport_orientation, float* position,
+    float* orientation);
+
 /// Recenters the head tracker.
 ///
 /// @details        By recentering, the @p head_tracker orientation gets aligned
@@ -641,6 +1110,54 @@ void CardboardHeadTracker_recenter(CardboardHeadTracker* head_tracker);
 void CardboardHeadTracker_setLowPassFilter(CardboardHeadTracker* head_tracker,
                                            int cutoff_frequency);
 
+/// Starts recording the accelerometer and gyroscope samples received by the
+/// head tracker into a binary IMU trace file, which can be replayed offline
+/// through the sensor fusion. A recording already in progress is stopped
+/// first. Failures are logged.
+///
+/// @pre @p head_tracker Must not be null.
+/// @pre @p path Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      head_tracker            Head tracker object pointer.
+/// @param[in]      path                    Path of the trace file. It is
+///     created or truncated.
+void CardboardHeadTracker_startTraceRecording(
+    CardboardHeadTracker* head_tracker, const char* path);
+
+/// Stops the IMU trace recording in progress, if any, and closes its file.
+///
+/// @pre @p head_tracker Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      head_tracker            Head tracker object pointer.
+void CardboardHeadTracker_stopTraceRecording(
+    CardboardHeadTracker* head_tracker);
+
+/// Sets the model and the tuning used to predict the pose returned by
+/// CardboardHeadTracker_getPose(). Values out of range are clamped.
+///
+/// @pre @p head_tracker Must not be null.
+/// @pre @p params Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      head_tracker            Head tracker object pointer.
+/// @param[in]      params                  Pose prediction parameters.
+void CardboardHeadTracker_setPosePrediction(
+    CardboardHeadTracker* head_tracker,
+    const CardboardPosePredictionParams* params);
+
+/// Gets the model and the tuning used to predict the pose.
+///
+/// @pre @p head_tracker Must not be null.
+/// @pre @p params Must not be null.
+/// When it is unmet, a call to this function results in a no-op.
+///
+/// @param[in]      head_tracker            Head tracker object pointer.
+/// @param[out]     params                  Pose prediction parameters.
+void CardboardHeadTracker_getPosePrediction(
+    CardboardHeadTracker* head_tracker, CardboardPosePredictionParams* params);
+
 /// @}
 
 /////////////////////////////////////////////////////////////////////////////
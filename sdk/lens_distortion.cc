@@ -15,97 +15,323 @@
  */
 #include "lens_distortion.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "distortion_mesh_cache.h"
 #include "include/cardboard.h"
 #include "screen_params.h"
+#include "util/hash.h"
 
 namespace cardboard {
 
-constexpr float kDefaultBorderSizeMeters = 0.003f;
+namespace {
 
-// All values in tanangle units.
-struct LensDistortion::ViewportParams {
-  float width;
-  float height;
-  float x_eye_offset;
-  float y_eye_offset;
-};
+constexpr float kDefaultBorderSizeMeters = 0.003f;
 
-LensDistortion::LensDistortion(const uint8_t* encoded_device_params, int size,
-                               int display_width, int display_height) {
-  device_params_.ParseFromArray(encoded_device_params, size);
+// Maximum number of entries kept by the shared params cache. Entries are
+// evicted in least recently used order.
+constexpr size_t kMaxCacheEntries = 8;
+
+// Largest difference, in tanangle units, between the viewport parameters of
+// both eyes for them to be considered the mirror image of each other.
+constexpr float kMirrorTolerance = 1e-5f;
+
+// Step, in tanangle units, of the finite differences of the inverse
+// distortion.
+constexpr float kPixelDensityStep = 1e-3f;
+
+// Returns how much the display stretches the eye texture at @p radius
+// tanangle units from the optical center. The inverse distortion stretches it
+// radially by its derivative and tangentially by its ratio to the radius, and
+// the larger of both sets the pixel density the texture needs.
+float TextureStretch(const PolynomialRadialDistortion& distortion,
+                     float radius) {
+  const float inner = std::max(radius - kPixelDensityStep, 0.0f);
+  const float outer = radius + kPixelDensityStep;
+  const float radial = (distortion.DistortInverse({outer, 0.0f})[0] -
+                        distortion.DistortInverse({inner, 0.0f})[0]) /
+                       (outer - inner);
+  if (radius < kPixelDensityStep) {
+    return radial;
+  }
+  const float tangential =
+      distortion.DistortInverse({radius, 0.0f})[0] / radius;
+  return std::max(radial, tangential);
+}
 
-  eye_from_head_matrix_[kLeft] = cardboard::Matrix4x4::Translation(
-      device_params_.inter_lens_distance() * 0.5f, 0.f, 0.f);
-  eye_from_head_matrix_[kRight] = cardboard::Matrix4x4::Translation(
-      -device_params_.inter_lens_distance() * 0.5f, 0.f, 0.f);
+}  // namespace
 
-  std::vector<float> distortion_coefficients(
-      device_params_.distortion_coefficients_size(), 0.0f);
-  for (int i = 0; i < device_params_.distortion_coefficients_size(); i++) {
-    distortion_coefficients.at(i) = device_params_.distortion_coefficients(i);
-  }
+struct LensDistortion::CacheState {
+  struct Entry {
+    uint64_t hash;
+    std::vector<uint8_t> encoded_device_params;
+    int display_width;
+    int display_height;
+    uint64_t last_use;
+    std::shared_ptr<const SharedParams> params;
+  };
 
-  distortion_ = std::unique_ptr<PolynomialRadialDistortion>(
-      new PolynomialRadialDistortion(distortion_coefficients));
+  std::mutex mutex;
+  std::vector<Entry> entries;
+  uint64_t use_counter = 0;
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
 
-  screen_params::getScreenSizeInMeters(display_width, display_height,
-                                       &screen_width_meters_,
-                                       &screen_height_meters_);
-  UpdateParams();
-}
+LensDistortion::LensDistortion(const uint8_t* encoded_device_params, int size,
+                               int display_width, int display_height)
+    : params_(GetSharedParams(encoded_device_params, size, display_width,
+                              display_height)),
+      mesh_resolution_(DistortionMesh::kDefaultResolution),
+      mesh_spacing_(DistortionMesh::Spacing::kUniform),
+      left_mesh_(params_->left_mesh),
+      right_mesh_(params_->right_mesh) {}
 
 LensDistortion::~LensDistortion() {}
 
 void LensDistortion::GetEyeFromHeadMatrix(
     CardboardEye eye, float* eye_from_head_matrix) const {
-  this->eye_from_head_matrix_[eye].ToArray(eye_from_head_matrix);
+  params_->eye_from_head_matrix[eye].ToArray(eye_from_head_matrix);
 }
 
 void LensDistortion::GetEyeProjectionMatrix(
     CardboardEye eye, float z_near, float z_far,
     float* projection_matrix) const {
-  Matrix4x4::Perspective(fov_[eye], z_near, z_far).ToArray(projection_matrix);
+  Matrix4x4::Perspective(params_->fov[eye], z_near, z_far)
+      .ToArray(projection_matrix);
 }
 
 void LensDistortion::GetEyeFieldOfView(CardboardEye eye,
                                        float* field_of_view) const {
-  std::memcpy(field_of_view, fov_[eye].data(), sizeof(float) * 4);
+  std::memcpy(field_of_view, params_->fov[eye].data(), sizeof(float) * 4);
 }
 
 CardboardMesh LensDistortion::GetDistortionMesh(CardboardEye eye) const {
   return eye == kLeft ? left_mesh_->GetMesh() : right_mesh_->GetMesh();
 }
 
-void LensDistortion::UpdateParams() {
-  fov_[kLeft] = CalculateFov(device_params_, *distortion_, screen_width_meters_,
-                             screen_height_meters_);
-  // Mirror fov for right eye.
-  fov_[kRight] = fov_[kLeft];
-  fov_[kRight][0] = fov_[kLeft][1];
-  fov_[kRight][1] = fov_[kLeft][0];
-
-  left_mesh_ = std::unique_ptr<DistortionMesh>(
-      CreateDistortionMesh(kLeft, device_params_, *distortion_, fov_[kLeft],
-                           screen_width_meters_, screen_height_meters_));
-  right_mesh_ = std::unique_ptr<DistortionMesh>(
-      CreateDistortionMesh(kRight, device_params_, *distortion_, fov_[kRight],
-                           screen_width_meters_, screen_height_meters_));
+CardboardCompactMesh LensDistortion::GetCompactDistortionMesh(
+    CardboardEye eye) const {
+  return eye == kLeft ? left_mesh_->GetCompactMesh()
+                      : right_mesh_->GetCompactMesh();
+}
+
+void LensDistortion::SetDistortionMeshResolution(int resolution) {
+  mesh_resolution_ = resolution;
+  mesh_spacing_ = DistortionMesh::Spacing::kUniform;
+  UpdateDistortionMeshes();
+}
+
+void LensDistortion::SetDistortionMeshMaxError(float max_error_pixels) {
+  mesh_spacing_ = DistortionMesh::Spacing::kAdaptive;
+  mesh_resolution_ = DistortionMesh::kMinResolution;
+  // Both eyes share the resolution, so the one with the largest error wins.
+  for (CardboardEye eye : {kLeft, kRight}) {
+    const ViewportParams& screen_params = params_->screen_params[eye];
+    const ViewportParams& texture_params = params_->texture_params[eye];
+    mesh_resolution_ = std::max(
+        mesh_resolution_,
+        DistortionMesh::ComputeResolution(
+            *params_->distortion, screen_params.width, screen_params.height,
+            screen_params.x_eye_offset, screen_params.y_eye_offset,
+            texture_params.width, texture_params.height,
+            texture_params.x_eye_offset, texture_params.y_eye_offset,
+            max_error_pixels, params_->display_width, params_->display_height,
+            mesh_spacing_));
+  }
+  UpdateDistortionMeshes();
+}
+
+void LensDistortion::GetRecommendedRenderTargetSize(CardboardEye eye,
+                                                    float quality, int* width,
+                                                    int* height) const {
+  // Display pixels per tanangle unit of the texture where it is stretched the
+  // most.
+  const float stretch = GetMaxTextureStretch(eye);
+  const ViewportParams& screen_params = params_->screen_params[eye];
+  const ViewportParams& texture_params = params_->texture_params[eye];
+  const float x_density =
+      stretch * params_->display_width / screen_params.width;
+  const float y_density =
+      stretch * params_->display_height / screen_params.height;
+  *width = std::max(1, static_cast<int>(std::ceil(quality * x_density *
+                                                   texture_params.width)));
+  *height = std::max(1, static_cast<int>(std::ceil(quality * y_density *
+                                                    texture_params.height)));
+}
+
+void LensDistortion::GetPixelDensityMap(CardboardEye eye, int count,
+                                        float* density_map) const {
+  const float max_radius = GetMaxTextureRadius(eye);
+  const float max_stretch = GetMaxTextureStretch(eye);
+  for (int i = 0; i < count; i++) {
+    const float radius =
+        count > 1 ? max_radius * static_cast<float>(i) / (count - 1) : 0.0f;
+    density_map[i] = TextureStretch(*params_->distortion, radius) / max_stretch;
+  }
+}
+
+void LensDistortion::GetCacheStatistics(int64_t* hits, int64_t* misses) {
+  CacheState& cache = GetCacheState();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  *hits = cache.hits;
+  *misses = cache.misses;
+}
+
+void LensDistortion::ClearCache() {
+  CacheState& cache = GetCacheState();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.entries.clear();
+  cache.hits = 0;
+  cache.misses = 0;
+}
+
+LensDistortion::CacheState& LensDistortion::GetCacheState() {
+  static CacheState* cache = new CacheState();
+  return *cache;
+}
+
+std::shared_ptr<const LensDistortion::SharedParams>
+LensDistortion::GetSharedParams(const uint8_t* encoded_device_params, int size,
+                                int display_width, int display_height) {
+  const uint64_t hash = Fnv1aHash(encoded_device_params, size);
+  CacheState& cache = GetCacheState();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    for (CacheState::Entry& entry : cache.entries) {
+      if (entry.hash == hash && entry.display_width == display_width &&
+          entry.display_height == display_height &&
+          entry.encoded_device_params.size() == static_cast<size_t>(size) &&
+          std::equal(entry.encoded_device_params.begin(),
+                     entry.encoded_device_params.end(),
+                     encoded_device_params)) {
+        entry.last_use = ++cache.use_counter;
+        cache.hits++;
+        return entry.params;
+      }
+    }
+    cache.misses++;
+  }
+
+  // The computation is done without holding the lock. Concurrent misses for
+  // the same key compute it twice, but only one entry is kept.
+  std::shared_ptr<const SharedParams> params = ComputeSharedParams(
+      encoded_device_params, size, display_width, display_height);
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.entries.size() >= kMaxCacheEntries) {
+    cache.entries.erase(std::min_element(
+        cache.entries.begin(), cache.entries.end(),
+        [](const CacheState::Entry& a, const CacheState::Entry& b) {
+          return a.last_use < b.last_use;
+        }));
+  }
+  cache.entries.push_back(CacheState::Entry{
+      hash,
+      std::vector<uint8_t>(encoded_device_params,
+                           encoded_device_params + size),
+      display_width, display_height, ++cache.use_counter, params});
+  return params;
+}
+
+std::shared_ptr<const LensDistortion::SharedParams>
+LensDistortion::ComputeSharedParams(const uint8_t* encoded_device_params,
+                                    int size, int display_width,
+                                    int display_height) {
+  DeviceParams device_params;
+  device_params.ParseFromArray(encoded_device_params, size);
+
+  std::shared_ptr<SharedParams> params = std::make_shared<SharedParams>();
+  params->display_width = display_width;
+  params->display_height = display_height;
+
+  params->eye_from_head_matrix[kLeft] = cardboard::Matrix4x4::Translation(
+      device_params.inter_lens_distance() * 0.5f, 0.f, 0.f);
+  params->eye_from_head_matrix[kRight] = cardboard::Matrix4x4::Translation(
+      -device_params.inter_lens_distance() * 0.5f, 0.f, 0.f);
+
+  std::vector<float> distortion_coefficients(
+      device_params.distortion_coefficients_size(), 0.0f);
+  for (int i = 0; i < device_params.distortion_coefficients_size(); i++) {
+    distortion_coefficients.at(i) = device_params.distortion_coefficients(i);
+  }
+
+  params->distortion = std::unique_ptr<PolynomialRadialDistortion>(
+      new PolynomialRadialDistortion(distortion_coefficients));
+
+  screen_params::getScreenSizeInMeters(display_width, display_height,
+                                       &params->screen_width_meters,
+                                       &params->screen_height_meters);
+
+  // The persistent cache, when enabled, provides everything that is
+  // expensive to compute.
+  DistortionMeshCache::Entry cache_entry;
+  const bool loaded = DistortionMeshCache::Load(
+      encoded_device_params, size, display_width, display_height,
+      DistortionMesh::kDefaultResolution, &cache_entry);
+
+  if (loaded) {
+    params->fov = cache_entry.fov;
+    params->eye_from_head_matrix = cache_entry.eye_from_head_matrix;
+  } else {
+    params->fov[kLeft] = CalculateFov(device_params, *params->distortion,
+                                      params->screen_width_meters,
+                                      params->screen_height_meters);
+    // Mirror fov for right eye.
+    params->fov[kRight] = params->fov[kLeft];
+    params->fov[kRight][0] = params->fov[kLeft][1];
+    params->fov[kRight][1] = params->fov[kLeft][0];
+  }
+
+  for (CardboardEye eye : {kLeft, kRight}) {
+    CalculateViewportParameters(
+        eye, device_params, params->fov[eye], params->screen_width_meters,
+        params->screen_height_meters, &params->screen_params[eye],
+        &params->texture_params[eye]);
+  }
+
+  if (loaded) {
+    params->left_mesh = cache_entry.left_mesh;
+    params->right_mesh = cache_entry.right_mesh;
+    return params;
+  }
+
+  CreateDistortionMeshes(*params->distortion, params->screen_params,
+                         params->texture_params,
+                         DistortionMesh::kDefaultResolution,
+                         DistortionMesh::Spacing::kUniform, &params->left_mesh,
+                         &params->right_mesh);
+
+  cache_entry.fov = params->fov;
+  cache_entry.eye_from_head_matrix = params->eye_from_head_matrix;
+  cache_entry.left_mesh = params->left_mesh;
+  cache_entry.right_mesh = params->right_mesh;
+  DistortionMeshCache::Store(encoded_device_params, size, display_width,
+                             display_height, DistortionMesh::kDefaultResolution,
+                             cache_entry);
+  return params;
+}
+
+void LensDistortion::UpdateDistortionMeshes() {
+  CreateDistortionMeshes(*params_->distortion, params_->screen_params,
+                         params_->texture_params, mesh_resolution_,
+                         mesh_spacing_, &left_mesh_, &right_mesh_);
 }
 
 std::array<float, 2> LensDistortion::DistortedUvForUndistortedUv(
     const std::array<float, 2>& in, CardboardEye eye) const {
-  if (screen_width_meters_ == 0 || screen_height_meters_ == 0) {
+  if (params_->screen_width_meters == 0 ||
+      params_->screen_height_meters == 0) {
     return {0, 0};
   }
 
-  ViewportParams screen_params, texture_params;
-
-  CalculateViewportParameters(eye, device_params_, fov_[eye],
-                              screen_width_meters_, screen_height_meters_,
-                              &screen_params, &texture_params);
+  const ViewportParams& screen_params = params_->screen_params[eye];
+  const ViewportParams& texture_params = params_->texture_params[eye];
 
   // Convert input from normalized [0, 1] screen coordinates to eye-centered
   // tanangle units.
@@ -114,7 +340,7 @@ std::array<float, 2> LensDistortion::DistortedUvForUndistortedUv(
       in[1] * screen_params.height - screen_params.y_eye_offset};
 
   std::array<float, 2> distorted_uv_tanangle =
-      distortion_->Distort(undistorted_uv_tanangle);
+      params_->distortion->Distort(undistorted_uv_tanangle);
 
   // Convert output from tanangle units to normalized [0, 1] pre distort texture
   // space.
@@ -126,15 +352,13 @@ std::array<float, 2> LensDistortion::DistortedUvForUndistortedUv(
 
 std::array<float, 2> LensDistortion::UndistortedUvForDistortedUv(
     const std::array<float, 2>& in, CardboardEye eye) const {
-  if (screen_width_meters_ == 0 || screen_height_meters_ == 0) {
+  if (params_->screen_width_meters == 0 ||
+      params_->screen_height_meters == 0) {
     return {0, 0};
   }
 
-  ViewportParams screen_params, texture_params;
-
-  CalculateViewportParameters(eye, device_params_, fov_[eye],
-                              screen_width_meters_, screen_height_meters_,
-                              &screen_params, &texture_params);
+  const ViewportParams& screen_params = params_->screen_params[eye];
+  const ViewportParams& texture_params = params_->texture_params[eye];
 
   // Convert input from normalized [0, 1] pre distort texture space to
   // eye-centered tanangle units.
@@ -143,7 +367,7 @@ std::array<float, 2> LensDistortion::UndistortedUvForDistortedUv(
       in[1] * texture_params.height - texture_params.y_eye_offset};
 
   std::array<float, 2> undistorted_uv_tanangle =
-      distortion_->DistortInverse(distorted_uv_tanangle);
+      params_->distortion->DistortInverse(distorted_uv_tanangle);
 
   // Convert output from tanangle units to normalized [0, 1] screen coordinates.
   return {(undistorted_uv_tanangle[0] + screen_params.x_eye_offset) /
@@ -152,6 +376,75 @@ std::array<float, 2> LensDistortion::UndistortedUvForDistortedUv(
               screen_params.height};
 }
 
+void LensDistortion::DistortedUvForUndistortedUvBatch(const float* u,
+                                                      const float* v,
+                                                      int count,
+                                                      CardboardEye eye,
+                                                      float* out_u,
+                                                      float* out_v) const {
+  if (params_->screen_width_meters == 0 ||
+      params_->screen_height_meters == 0) {
+    std::fill(out_u, out_u + count, 0.0f);
+    std::fill(out_v, out_v + count, 0.0f);
+    return;
+  }
+
+  const ViewportParams& screen_params = params_->screen_params[eye];
+  const ViewportParams& texture_params = params_->texture_params[eye];
+
+  // The conversions are done in place on the output arrays so no temporary
+  // storage is needed. Both inputs are read before either output is written,
+  // in case out_u is v or out_v is u.
+  for (int i = 0; i < count; ++i) {
+    const float u_i = u[i];
+    const float v_i = v[i];
+    out_u[i] = u_i * screen_params.width - screen_params.x_eye_offset;
+    out_v[i] = v_i * screen_params.height - screen_params.y_eye_offset;
+  }
+
+  params_->distortion->DistortBatch(out_u, out_v, count, out_u, out_v);
+
+  const float inverse_width = 1.0f / texture_params.width;
+  const float inverse_height = 1.0f / texture_params.height;
+  for (int i = 0; i < count; ++i) {
+    out_u[i] = (out_u[i] + texture_params.x_eye_offset) * inverse_width;
+    out_v[i] = (out_v[i] + texture_params.y_eye_offset) * inverse_height;
+  }
+}
+
+void LensDistortion::UndistortedUvForDistortedUvBatch(const float* u,
+                                                      const float* v,
+                                                      int count,
+                                                      CardboardEye eye,
+                                                      float* out_u,
+                                                      float* out_v) const {
+  if (params_->screen_width_meters == 0 ||
+      params_->screen_height_meters == 0) {
+    std::fill(out_u, out_u + count, 0.0f);
+    std::fill(out_v, out_v + count, 0.0f);
+    return;
+  }
+
+  const ViewportParams& screen_params = params_->screen_params[eye];
+  const ViewportParams& texture_params = params_->texture_params[eye];
+
+  for (int i = 0; i < count; ++i) {
+    const float u_i = u[i];
+    const float v_i = v[i];
+    out_u[i] = u_i * texture_params.width - texture_params.x_eye_offset;
+    out_v[i] = v_i * texture_params.height - texture_params.y_eye_offset;
+  }
+
+  params_->distortion->DistortInverseBatch(out_u, out_v, count, out_u, out_v);
+
+  const float inverse_width = 1.0f / screen_params.width;
+  const float inverse_height = 1.0f / screen_params.height;
+  for (int i = 0; i < count; ++i) {
+    out_u[i] = (out_u[i] + screen_params.x_eye_offset) * inverse_width;
+    out_v[i] = (out_v[i] + screen_params.y_eye_offset) * inverse_height;
+  }
+}
+
 std::array<float, 4> LensDistortion::CalculateFov(
     const DeviceParams& device_params,
     const PolynomialRadialDistortion& distortion, float screen_width_meters,
@@ -205,21 +498,51 @@ float LensDistortion::GetYEyeOffsetMeters(const DeviceParams& device_params,
 }
 
 DistortionMesh* LensDistortion::CreateDistortionMesh(
-    CardboardEye eye, const DeviceParams& device_params,
     const PolynomialRadialDistortion& distortion,
-    const std::array<float, 4>& fov, float screen_width_meters,
-    float screen_height_meters) {
-  ViewportParams screen_params, texture_params;
-
-  CalculateViewportParameters(eye, device_params, fov, screen_width_meters,
-                              screen_height_meters, &screen_params,
-                              &texture_params);
-
+    const ViewportParams& screen_params, const ViewportParams& texture_params,
+    int resolution, DistortionMesh::Spacing spacing) {
   return new DistortionMesh(distortion, screen_params.width,
                             screen_params.height, screen_params.x_eye_offset,
                             screen_params.y_eye_offset, texture_params.width,
                             texture_params.height, texture_params.x_eye_offset,
-                            texture_params.y_eye_offset);
+                            texture_params.y_eye_offset, resolution, spacing);
+}
+
+void LensDistortion::CreateDistortionMeshes(
+    const PolynomialRadialDistortion& distortion,
+    const std::array<ViewportParams, 2>& screen_params,
+    const std::array<ViewportParams, 2>& texture_params, int resolution,
+    DistortionMesh::Spacing spacing,
+    std::shared_ptr<const DistortionMesh>* left_mesh,
+    std::shared_ptr<const DistortionMesh>* right_mesh) {
+  std::unique_ptr<DistortionMesh> left(
+      CreateDistortionMesh(distortion, screen_params[kLeft],
+                           texture_params[kLeft], resolution, spacing));
+  std::unique_ptr<DistortionMesh> right(
+      AreViewportsMirrored(screen_params, texture_params)
+          ? left->CreateHorizontalMirror()
+          : CreateDistortionMesh(distortion, screen_params[kRight],
+                                 texture_params[kRight], resolution, spacing));
+  *left_mesh = std::move(left);
+  *right_mesh = std::move(right);
+}
+
+bool LensDistortion::AreViewportsMirrored(
+    const std::array<ViewportParams, 2>& screen_params,
+    const std::array<ViewportParams, 2>& texture_params) {
+  // Mirroring a viewport keeps its size and vertical offset, and moves the
+  // eye center from x_eye_offset to width - x_eye_offset.
+  auto are_mirrored = [](const ViewportParams& left,
+                         const ViewportParams& right) {
+    return std::fabs(left.width - right.width) < kMirrorTolerance &&
+           std::fabs(left.height - right.height) < kMirrorTolerance &&
+           std::fabs(left.y_eye_offset - right.y_eye_offset) <
+               kMirrorTolerance &&
+           std::fabs(left.width - left.x_eye_offset - right.x_eye_offset) <
+               kMirrorTolerance;
+  };
+  return are_mirrored(screen_params[kLeft], screen_params[kRight]) &&
+         are_mirrored(texture_params[kLeft], texture_params[kRight]);
 }
 
 void LensDistortion::CalculateViewportParameters(
@@ -249,6 +572,25 @@ void LensDistortion::CalculateViewportParameters(
   texture_params->y_eye_offset = tan(fov[2]);
 }
 
+float LensDistortion::GetMaxTextureRadius(CardboardEye eye) const {
+  const ViewportParams& texture_params = params_->texture_params[eye];
+  const float max_x =
+      std::max(texture_params.x_eye_offset,
+               texture_params.width - texture_params.x_eye_offset);
+  const float max_y = std::max(
+      texture_params.y_eye_offset,
+      texture_params.height - texture_params.y_eye_offset);
+  return std::hypot(max_x, max_y);
+}
+
+float LensDistortion::GetMaxTextureStretch(CardboardEye eye) const {
+  // The stretch is sampled at the optical center and at the farthest corner of
+  // the texture, which bound it for the monotonic distortions of lenses.
+  return std::max(
+      TextureStretch(*params_->distortion, 0.0f),
+      TextureStretch(*params_->distortion, GetMaxTextureRadius(eye)));
+}
+
 constexpr float LensDistortion::DegreesToRadians(float angle) {
   return angle * M_PI / 180.0f;
 }
@@ -17,6 +17,7 @@
 #define CARDBOARD_SDK_LENSDISTORTION_H_
 
 #include <array>
+#include <cstdint>
 #include <memory>
 
 #ifdef __ANDROID__
@@ -44,27 +45,114 @@ class LensDistortion {
       const std::array<float, 2>& in, CardboardEye eye) const;
   std::array<float, 2> UndistortedUvForDistortedUv(
       const std::array<float, 2>& in, CardboardEye eye) const;
+  // Batched versions of the above functions. Points are given as separate u
+  // and v arrays of @p count elements. Each output array may be either input
+  // array, e.g. @p out_u may be @p v.
+  void DistortedUvForUndistortedUvBatch(const float* u, const float* v,
+                                        int count, CardboardEye eye,
+                                        float* out_u, float* out_v) const;
+  void UndistortedUvForDistortedUvBatch(const float* u, const float* v,
+                                        int count, CardboardEye eye,
+                                        float* out_u, float* out_v) const;
   void GetEyeFromHeadMatrix(CardboardEye eye,
                             float* eye_from_head_matrix) const;
   void GetEyeProjectionMatrix(CardboardEye eye, float z_near, float z_far,
                               float* projection_matrix) const;
   void GetEyeFieldOfView(CardboardEye eye, float* field_of_view) const;
   CardboardMesh GetDistortionMesh(CardboardEye eye) const;
+  CardboardCompactMesh GetCompactDistortionMesh(CardboardEye eye) const;
+  // Rebuilds the distortion meshes with a uniform grid of @p resolution x
+  // @p resolution vertices.
+  void SetDistortionMeshResolution(int resolution);
+  // Rebuilds the distortion meshes with an adaptive grid that has the fewest
+  // vertices whose error is at most @p max_error_pixels display pixels.
+  void SetDistortionMeshMaxError(float max_error_pixels);
+  // Returns the size of the eye texture of @p eye whose pixels are as dense
+  // as the display pixels where the distortion stretches the texture the
+  // most, scaled by @p quality.
+  void GetRecommendedRenderTargetSize(CardboardEye eye, float quality,
+                                      int* width, int* height) const;
+  // Writes to @p density_map @p count samples of the pixel density that the
+  // eye texture of @p eye needs, relative to the one of the recommended render
+  // target size. Samples are uniformly spaced in tanangle units from the
+  // optical center to the farthest corner of the texture.
+  void GetPixelDensityMap(CardboardEye eye, int count,
+                          float* density_map) const;
+
+  // Instances created with the same encoded device params and display size
+  // share their FOV, eye matrices and default distortion meshes through a
+  // process-wide cache. These functions report and reset its usage.
+  static void GetCacheStatistics(int64_t* hits, int64_t* misses);
+  static void ClearCache();
+
  private:
-  struct ViewportParams;
+  // All values in tanangle units.
+  struct ViewportParams {
+    float width;
+    float height;
+    float x_eye_offset;
+    float y_eye_offset;
+  };
+
+  // Everything that is derived from the encoded device params and the display
+  // size. It is immutable once computed.
+  struct SharedParams {
+    int display_width;
+    int display_height;
+    float screen_width_meters;
+    float screen_height_meters;
+    std::array<std::array<float, 4>, 2> fov;  // L, R, B, T
+    std::array<Matrix4x4, 2> eye_from_head_matrix;
+    std::array<ViewportParams, 2> screen_params;
+    std::array<ViewportParams, 2> texture_params;
+    std::unique_ptr<PolynomialRadialDistortion> distortion;
+    // Meshes built with the default resolution and spacing.
+    std::shared_ptr<const DistortionMesh> left_mesh;
+    std::shared_ptr<const DistortionMesh> right_mesh;
+  };
+  struct CacheState;
+
+  // Returns the shared params for the given arguments, computing them on a
+  // cache miss.
+  static std::shared_ptr<const SharedParams> GetSharedParams(
+      const uint8_t* encoded_device_params, int size, int display_width,
+      int display_height);
+  static std::shared_ptr<const SharedParams> ComputeSharedParams(
+      const uint8_t* encoded_device_params, int size, int display_width,
+      int display_height);
+  static CacheState& GetCacheState();
 
-  void UpdateParams();
+  void UpdateDistortionMeshes();
   static float GetYEyeOffsetMeters(const DeviceParams& device_params,
                                    float screen_height_meters);
   static DistortionMesh* CreateDistortionMesh(
-      CardboardEye eye, const cardboard::DeviceParams& device_params,
       const cardboard::PolynomialRadialDistortion& distortion,
-      const std::array<float, 4>& fov, float screen_width_meters,
-      float screen_height_meters);
+      const ViewportParams& screen_params,
+      const ViewportParams& texture_params, int resolution,
+      DistortionMesh::Spacing spacing);
+  // Creates the meshes of both eyes. When the viewports of both eyes are the
+  // mirror image of each other, the right eye mesh is mirrored from the left
+  // eye one instead of being computed.
+  static void CreateDistortionMeshes(
+      const cardboard::PolynomialRadialDistortion& distortion,
+      const std::array<ViewportParams, 2>& screen_params,
+      const std::array<ViewportParams, 2>& texture_params, int resolution,
+      DistortionMesh::Spacing spacing,
+      std::shared_ptr<const DistortionMesh>* left_mesh,
+      std::shared_ptr<const DistortionMesh>* right_mesh);
+  static bool AreViewportsMirrored(
+      const std::array<ViewportParams, 2>& screen_params,
+      const std::array<ViewportParams, 2>& texture_params);
   static std::array<float, 4> CalculateFov(
       const cardboard::DeviceParams& device_params,
       const cardboard::PolynomialRadialDistortion& distortion,
       float screen_width_meters, float screen_height_meters);
+  // Returns the largest distance, in tanangle units, from the optical center
+  // of @p eye to a corner of its eye texture.
+  float GetMaxTextureRadius(CardboardEye eye) const;
+  // Returns the largest stretch of the eye texture of @p eye by the display.
+  float GetMaxTextureStretch(CardboardEye eye) const;
+
   static void CalculateViewportParameters(CardboardEye eye,
                                           const DeviceParams& device_params,
                                           const std::array<float, 4>& fov,
@@ -74,15 +162,13 @@ class LensDistortion {
                                           ViewportParams* texture_params);
   static constexpr float DegreesToRadians(float angle);
 
-  DeviceParams device_params_;
-
-  float screen_width_meters_;
-  float screen_height_meters_;
-  std::array<std::array<float, 4>, 2> fov_;  // L, R, B, T
-  std::array<Matrix4x4, 2> eye_from_head_matrix_;
-  std::unique_ptr<DistortionMesh> left_mesh_;
-  std::unique_ptr<DistortionMesh> right_mesh_;
-  std::unique_ptr<PolynomialRadialDistortion> distortion_;
+  std::shared_ptr<const SharedParams> params_;
+  int mesh_resolution_;
+  DistortionMesh::Spacing mesh_spacing_;
+  // Either the default meshes in params_ or meshes owned by this instance when
+  // the resolution or spacing were changed.
+  std::shared_ptr<const DistortionMesh> left_mesh_;
+  std::shared_ptr<const DistortionMesh> right_mesh_;
 };
 
 }  // namespace cardboard
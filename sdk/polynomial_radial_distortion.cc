@@ -15,14 +15,120 @@
  */
 #include "polynomial_radial_distortion.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace cardboard {
 
+namespace {
+
+// Tolerance of the iterative inverse used at runtime, 0.1mm.
+constexpr float kInverseTolerance = 0.0001f;
+// Tolerance of the iterative inverse used to sample and validate the inverse
+// table.
+constexpr float kInverseTableReferenceTolerance = 0.000001f;
+// Maximum number of Secant method iterations.
+constexpr int kMaxInverseIterations = 100;
+// Number of intervals in the inverse table.
+constexpr int kInverseTableIntervals = 64;
+// Largest distorted radius covered by the inverse table. It spans beyond the
+// field of view of any known viewer.
+constexpr float kMaxInverseTableRadius = 4.0f;
+// Step used to search for the range in which the distortion is monotonic.
+constexpr float kMonotonicRangeSearchStep = 0.01f;
+
+// Evaluates the distortion factor with Horner's rule:
+//
+//   1 + r^2 (K1 + r^2 (K2 + ... + r^2 Kn))
+float HornerDistortionFactor(const float* coefficients, int n,
+                             float r_squared) {
+  float acc = 0.0f;
+  for (int i = n - 1; i >= 0; --i) {
+    acc = (acc + coefficients[i]) * r_squared;
+  }
+  return 1.0f + acc;
+}
+
+// Distorts as many points as fit in whole SIMD registers and returns how many
+// were processed. The caller handles the remaining ones.
+int DistortBatchSimd(const float* coefficients, int n, const float* x,
+                     const float* y, int count, float* out_x, float* out_y) {
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256 one = _mm256_set1_ps(1.0f);
+  for (; i + 8 <= count; i += 8) {
+    const __m256 px = _mm256_loadu_ps(x + i);
+    const __m256 py = _mm256_loadu_ps(y + i);
+    const __m256 r_squared =
+        _mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py));
+    __m256 acc = _mm256_setzero_ps();
+    for (int k = n - 1; k >= 0; --k) {
+      acc = _mm256_mul_ps(_mm256_add_ps(acc, _mm256_set1_ps(coefficients[k])),
+                          r_squared);
+    }
+    const __m256 factor = _mm256_add_ps(one, acc);
+    _mm256_storeu_ps(out_x + i, _mm256_mul_ps(px, factor));
+    _mm256_storeu_ps(out_y + i, _mm256_mul_ps(py, factor));
+  }
+#elif defined(__SSE2__)
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    const __m128 px = _mm_loadu_ps(x + i);
+    const __m128 py = _mm_loadu_ps(y + i);
+    const __m128 r_squared = _mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py));
+    __m128 acc = _mm_setzero_ps();
+    for (int k = n - 1; k >= 0; --k) {
+      acc = _mm_mul_ps(_mm_add_ps(acc, _mm_set1_ps(coefficients[k])),
+                       r_squared);
+    }
+    const __m128 factor = _mm_add_ps(one, acc);
+    _mm_storeu_ps(out_x + i, _mm_mul_ps(px, factor));
+    _mm_storeu_ps(out_y + i, _mm_mul_ps(py, factor));
+  }
+#elif defined(__ARM_NEON)
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t px = vld1q_f32(x + i);
+    const float32x4_t py = vld1q_f32(y + i);
+    const float32x4_t r_squared = vmlaq_f32(vmulq_f32(px, px), py, py);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (int k = n - 1; k >= 0; --k) {
+      acc = vmulq_f32(vaddq_f32(acc, vdupq_n_f32(coefficients[k])), r_squared);
+    }
+    const float32x4_t factor = vaddq_f32(one, acc);
+    vst1q_f32(out_x + i, vmulq_f32(px, factor));
+    vst1q_f32(out_y + i, vmulq_f32(py, factor));
+  }
+#else
+  (void)coefficients;
+  (void)n;
+  (void)x;
+  (void)y;
+  (void)count;
+  (void)out_x;
+  (void)out_y;
+#endif
+  return i;
+}
+
+}  // namespace
+
 PolynomialRadialDistortion::PolynomialRadialDistortion(
     const std::vector<float>& coefficients)
-    : coefficients_(coefficients) {}
+    : coefficients_(coefficients),
+      inverse_sample_step_(0.0f),
+      max_inverse_table_radius_(0.0f) {
+  ComputeInverseTable();
+}
 
 float PolynomialRadialDistortion::DistortionFactor(float r_squared) const {
   float r_factor = 1.0f;
@@ -40,6 +146,99 @@ float PolynomialRadialDistortion::DistortRadius(float r) const {
   return r * DistortionFactor(r * r);
 }
 
+float PolynomialRadialDistortion::DistortRadiusDerivative(float r) const {
+  // d/dr (r + K1 r^3 + K2 r^5 + ...) = 1 + 3 K1 r^2 + 5 K2 r^4 + ...
+  const float r_squared = r * r;
+  float r_factor = 1.0f;
+  float derivative = 1.0f;
+  float exponent = 1.0f;
+
+  for (float ki : coefficients_) {
+    r_factor *= r_squared;
+    exponent += 2.0f;
+    derivative += exponent * ki * r_factor;
+  }
+
+  return derivative;
+}
+
+float PolynomialRadialDistortion::DistortRadiusInverseIterative(
+    float distorted_radius, float tolerance) const {
+  // Based on the shape of typical distortion curves, |radius| / 2 and
+  // |radius| / 3 are good initial guesses for the Secant method that will
+  // remain within the intended range of the polynomial.
+  float r0 = distorted_radius / 2.0f;
+  float r1 = distorted_radius / 3.0f;
+  float r2;
+  float dr0 = distorted_radius - DistortRadius(r0);
+  float dr1;
+  for (int i = 0;
+       i < kMaxInverseIterations && std::fabs(r1 - r0) > tolerance; i++) {
+    dr1 = distorted_radius - DistortRadius(r1);
+    if (dr1 == dr0) {
+      break;
+    }
+    r2 = r1 - dr1 * ((r1 - r0) / (dr1 - dr0));
+    r0 = r1;
+    r1 = r2;
+    dr0 = dr1;
+  }
+
+  return r1;
+}
+
+void PolynomialRadialDistortion::ComputeInverseTable() {
+  // The inverse is only well defined while the distortion is monotonic, so
+  // the table stops at the first radius where the derivative vanishes.
+  float max_radius = 0.0f;
+  while (DistortRadius(max_radius) < kMaxInverseTableRadius) {
+    const float next_radius = max_radius + kMonotonicRangeSearchStep;
+    if (DistortRadiusDerivative(next_radius) <= 0.0f) {
+      break;
+    }
+    max_radius = next_radius;
+  }
+  const float max_distorted_radius = DistortRadius(max_radius);
+  if (max_distorted_radius <= 0.0f) {
+    return;
+  }
+
+  inverse_sample_step_ = max_distorted_radius / kInverseTableIntervals;
+  inverse_radius_samples_.resize(kInverseTableIntervals + 1);
+  inverse_radius_derivative_samples_.resize(kInverseTableIntervals + 1);
+  for (int i = 0; i <= kInverseTableIntervals; i++) {
+    const float distorted_radius = i * inverse_sample_step_;
+    const float radius =
+        i == 0 ? 0.0f
+               : DistortRadiusInverseIterative(distorted_radius,
+                                               kInverseTableReferenceTolerance);
+    inverse_radius_samples_[i] = radius;
+    // Inverse function theorem: dr/dr' = 1 / (dr'/dr).
+    inverse_radius_derivative_samples_[i] =
+        1.0f / DistortRadiusDerivative(radius);
+  }
+
+  // Checks the interpolation against the iterative solver at the middle of
+  // each interval, where the error is the largest, and drops the intervals
+  // that are not accurate enough. Those are resolved iteratively.
+  int valid_intervals = 0;
+  max_inverse_table_radius_ = max_distorted_radius;
+  for (; valid_intervals < kInverseTableIntervals; valid_intervals++) {
+    const float distorted_radius =
+        (valid_intervals + 0.5f) * inverse_sample_step_;
+    const float expected_radius = DistortRadiusInverseIterative(
+        distorted_radius, kInverseTableReferenceTolerance);
+    const std::array<float, 2> interpolated =
+        DistortInverse({distorted_radius, 0.0f});
+    if (std::fabs(interpolated[0] - expected_radius) > kInverseTolerance) {
+      break;
+    }
+  }
+  max_inverse_table_radius_ = valid_intervals * inverse_sample_step_;
+  inverse_radius_samples_.resize(valid_intervals + 1);
+  inverse_radius_derivative_samples_.resize(valid_intervals + 1);
+}
+
 std::array<float, 2> PolynomialRadialDistortion::Distort(
     const std::array<float, 2>& p) const {
   float distortion_factor = DistortionFactor(p[0] * p[0] + p[1] * p[1]);
@@ -54,23 +253,52 @@ std::array<float, 2> PolynomialRadialDistortion::DistortInverse(
     return std::array<float, 2>();
   }
 
-  // Based on the shape of typical distortion curves, |radius| / 2 and
-  // |radius| / 3 are good initial guesses for the Secant method that will
-  // remain within the intended range of the polynomial.
-  float r0 = radius / 2.0f;
-  float r1 = radius / 3.0f;
-  float r2;
-  float dr0 = radius - DistortRadius(r0);
-  float dr1;
-  while (std::fabs(r1 - r0) > 0.0001f /** 0.1mm */) {
-    dr1 = radius - DistortRadius(r1);
-    r2 = r1 - dr1 * ((r1 - r0) / (dr1 - dr0));
-    r0 = r1;
-    r1 = r2;
-    dr0 = dr1;
+  float r;
+  if (radius < max_inverse_table_radius_) {
+    // Cubic Hermite interpolation of the inverse table.
+    const float t = radius / inverse_sample_step_;
+    const int i = std::min(static_cast<int>(t),
+                           static_cast<int>(inverse_radius_samples_.size()) - 2);
+    const float u = t - i;
+    const float u2 = u * u;
+    const float u3 = u2 * u;
+    r = (2.0f * u3 - 3.0f * u2 + 1.0f) * inverse_radius_samples_[i] +
+        (u3 - 2.0f * u2 + u) * inverse_sample_step_ *
+            inverse_radius_derivative_samples_[i] +
+        (-2.0f * u3 + 3.0f * u2) * inverse_radius_samples_[i + 1] +
+        (u3 - u2) * inverse_sample_step_ *
+            inverse_radius_derivative_samples_[i + 1];
+  } else {
+    r = DistortRadiusInverseIterative(radius, kInverseTolerance);
   }
 
-  return std::array<float, 2>{(r1 / radius) * p[0], (r1 / radius) * p[1]};
+  return std::array<float, 2>{(r / radius) * p[0], (r / radius) * p[1]};
+}
+
+void PolynomialRadialDistortion::DistortBatch(const float* x, const float* y,
+                                              int count, float* out_x,
+                                              float* out_y) const {
+  const int n = static_cast<int>(coefficients_.size());
+  int i = DistortBatchSimd(coefficients_.data(), n, x, y, count, out_x, out_y);
+  for (; i < count; ++i) {
+    const float px = x[i];
+    const float py = y[i];
+    const float factor =
+        HornerDistortionFactor(coefficients_.data(), n, px * px + py * py);
+    out_x[i] = px * factor;
+    out_y[i] = py * factor;
+  }
+}
+
+void PolynomialRadialDistortion::DistortInverseBatch(const float* x,
+                                                     const float* y, int count,
+                                                     float* out_x,
+                                                     float* out_y) const {
+  for (int i = 0; i < count; ++i) {
+    const std::array<float, 2> p = DistortInverse({x[i], y[i]});
+    out_x[i] = p[0];
+    out_y[i] = p[1];
+  }
 }
 
 }  // namespace cardboard
@@ -54,8 +54,24 @@ class PolynomialRadialDistortion {
 
   // Given a 2d point p, returns the point that would need to be passed to
   // Distort to get point p (approximately).
+  //
+  // Within the range covered by the precomputed inverse table this is a fixed
+  // cost evaluation. Points outside of it fall back to the iterative solver.
   std::array<float, 2> DistortInverse(const std::array<float, 2>& p) const;
 
+  // Batched version of Distort. Distorts @p count points whose coordinates are
+  // given as separate x and y arrays. The polynomial is evaluated with the
+  // SIMD instruction set available at compile time (AVX2, SSE2 or NEON) and a
+  // scalar loop handles the remaining points. The output arrays may alias the
+  // input ones.
+  void DistortBatch(const float* x, const float* y, int count, float* out_x,
+                    float* out_y) const;
+
+  // Batched version of DistortInverse. The output arrays may alias the input
+  // ones.
+  void DistortInverseBatch(const float* x, const float* y, int count,
+                           float* out_x, float* out_y) const;
+
  private:
   // Given a radius (measuring distance from the optical axis of the lens),
   // returns the distortion factor for that radius.
@@ -65,7 +81,31 @@ class PolynomialRadialDistortion {
   // returns the corresponding distorted radius.
   float DistortRadius(float r) const;
 
+  // Given a radius (measuring distance from the optical axis of the lens),
+  // returns the derivative of the distorted radius with respect to it.
+  float DistortRadiusDerivative(float r) const;
+
+  // Given a distorted radius, returns the radius that would need to be passed
+  // to DistortRadius to get it. It uses the Secant method and stops when two
+  // consecutive estimates are closer than @p tolerance.
+  float DistortRadiusInverseIterative(float distorted_radius,
+                                      float tolerance) const;
+
+  // Samples the inverse of DistortRadius and stores it into a table that is
+  // interpolated by DistortInverse. Only the range in which the interpolation
+  // error is below the tolerance of the iterative solver is kept.
+  void ComputeInverseTable();
+
   std::vector<float> coefficients_;
+
+  // Undistorted radius and its derivative with respect to the distorted
+  // radius, sampled at uniformly spaced distorted radii.
+  std::vector<float> inverse_radius_samples_;
+  std::vector<float> inverse_radius_derivative_samples_;
+  // Distance between two consecutive samples in distorted radius units.
+  float inverse_sample_step_;
+  // Largest distorted radius that is resolved with the inverse table.
+  float max_inverse_table_radius_;
 };
 
 }  // namespace cardboard
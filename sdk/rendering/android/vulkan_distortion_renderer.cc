@@ -15,8 +15,15 @@
  */
 #include <sys/types.h>
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "distortion_renderer.h"
@@ -39,6 +46,72 @@
   }
 
 namespace cardboard::rendering {
+namespace {
+
+// Size of the header at the start of pipeline cache data, made of the header
+// size, the header version, the vendor ID, the device ID and the pipeline cache
+// UUID.
+constexpr size_t kPipelineCacheHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+// Pipeline cache data of the last destroyed renderer. Renderers are recreated
+// when the swapchain changes, and they start from it to avoid compiling their
+// pipelines again.
+std::mutex& GetSavedPipelineCacheMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::vector<uint8_t>& GetSavedPipelineCacheData() {
+  static std::vector<uint8_t>* data = new std::vector<uint8_t>();
+  return *data;
+}
+
+// Tells whether pipeline cache data was created by the same driver and device.
+// Implementations may not validate it, so it is checked before being used.
+bool IsPipelineCacheDataCompatible(
+    const uint8_t* data, size_t size,
+    const VkPhysicalDeviceProperties& properties) {
+  if (data == nullptr || size < kPipelineCacheHeaderSize) {
+    return false;
+  }
+  uint32_t header[4];
+  memcpy(header, data, sizeof(header));
+  return header[0] >= kPipelineCacheHeaderSize &&
+         header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header[2] == properties.vendorID &&
+         header[3] == properties.deviceID &&
+         memcmp(data + sizeof(header), properties.pipelineCacheUUID,
+                VK_UUID_SIZE) == 0;
+}
+
+// Reads a whole file. Returns an empty vector if it cannot be read.
+std::vector<uint8_t> ReadFile(const std::string& path) {
+  std::vector<uint8_t> data;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return data;
+  }
+  uint8_t buffer[4096];
+  size_t read_size;
+  while ((read_size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + read_size);
+  }
+  fclose(file);
+  return data;
+}
+
+// Writes a whole file, replacing its contents.
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  const bool written =
+      fwrite(data.data(), 1, data.size(), file) == data.size();
+  return fclose(file) == 0 && written;
+}
+
+}  // namespace
 
 struct PushConstantsObject {
   float left_u;
@@ -54,6 +127,20 @@ struct Vertex {
   float tex_v;
 };
 
+// Vertex layout of CardboardCompactMesh.
+struct CompactVertex {
+  int16_t pos_x;
+  int16_t pos_y;
+  int16_t tex_u;
+  int16_t tex_v;
+};
+
+// Vertex layouts of the meshes. Each one has its own pipeline.
+enum VertexLayout {
+  kFloatVertexLayout = 0,    // Vertex, set with SetMesh().
+  kCompactVertexLayout = 1,  // CompactVertex, set with SetCompactMesh().
+};
+
 class VulkanDistortionRenderer : public DistortionRenderer {
  public:
   explicit VulkanDistortionRenderer(
@@ -74,6 +161,7 @@ class VulkanDistortionRenderer : public DistortionRenderer {
     CreateSharedVulkanObjects();
     CreatePerEyeVulkanObjects(kLeft);
     CreatePerEyeVulkanObjects(kRight);
+    CreatePipelineCache();
   }
 
   ~VulkanDistortionRenderer() {
@@ -90,8 +178,11 @@ class VulkanDistortionRenderer : public DistortionRenderer {
     vkDestroyDescriptorPool(logical_device_, descriptor_pool_[kLeft], nullptr);
     vkDestroyDescriptorPool(logical_device_, descriptor_pool_[kRight], nullptr);
 
-    CleanPipeline(kLeft);
-    CleanPipeline(kRight);
+    for (VkPipeline pipeline : pipelines_) {
+      vkDestroyPipeline(logical_device_, pipeline, nullptr);
+    }
+    SavePipelineCache();
+    vkDestroyPipelineCache(logical_device_, pipeline_cache_, nullptr);
 
     vkDestroyBuffer(logical_device_, index_buffers_[kLeft], nullptr);
     vkFreeMemory(logical_device_, index_buffers_memory_[kLeft], nullptr);
@@ -147,6 +238,41 @@ class VulkanDistortionRenderer : public DistortionRenderer {
     vkUnmapMemory(logical_device_, index_buffers_memory_[eye]);
 
     indices_count_ = mesh->n_indices;
+    position_scale_[eye] = 1.0f;
+    vertex_layout_[eye] = kFloatVertexLayout;
+  }
+
+  void SetCompactMesh(const CardboardCompactMesh* mesh,
+                      CardboardEye eye) override {
+    // Create Vertex buffer
+    VkDeviceSize vertex_buffer_size = sizeof(CompactVertex) * mesh->n_vertices;
+    CreateBuffer(vertex_buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 vertex_buffers_[eye], vertex_buffers_memory_[eye]);
+
+    void* vertex_data;
+    CALL_VK(vkMapMemory(logical_device_, vertex_buffers_memory_[eye], 0,
+                        vertex_buffer_size, 0, &vertex_data));
+    memcpy(vertex_data, mesh->vertices, vertex_buffer_size);
+    vkUnmapMemory(logical_device_, vertex_buffers_memory_[eye]);
+
+    // Create Index Buffer
+    VkDeviceSize index_buffer_size = sizeof(uint16_t) * mesh->n_indices;
+    CreateBuffer(index_buffer_size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 index_buffers_[eye], index_buffers_memory_[eye]);
+
+    void* index_data;
+    vkMapMemory(logical_device_, index_buffers_memory_[eye], 0,
+                index_buffer_size, 0, &index_data);
+    memcpy(index_data, mesh->indices, index_buffer_size);
+    vkUnmapMemory(logical_device_, index_buffers_memory_[eye]);
+
+    indices_count_ = mesh->n_indices;
+    position_scale_[eye] = mesh->position_scale;
+    vertex_layout_[eye] = kCompactVertexLayout;
   }
 
   void RenderEyeToDisplay(
@@ -167,11 +293,7 @@ class VulkanDistortionRenderer : public DistortionRenderer {
       return;
     }
 
-    if (render_pass != current_render_pass_) {
-      current_render_pass_ = render_pass;
-      CreateGraphicsPipeline(kLeft);
-      CreateGraphicsPipeline(kRight);
-    }
+    SetRenderPass(render_pass);
 
     RenderDistortionMesh(left_eye, kLeft, command_buffer, image_index, x, y,
                          width, height);
@@ -179,6 +301,92 @@ class VulkanDistortionRenderer : public DistortionRenderer {
                          width, height);
   }
 
+  /**
+   * Builds the graphics pipeline for a render pass ahead of time, so that
+   * RenderEyeToDisplay() does not compile it on the first frame.
+   *
+   * @param render_pass Render pass that targets will use.
+   */
+  void PrepareRenderPass(VkRenderPass render_pass) {
+    SetRenderPass(render_pass);
+    GetGraphicsPipeline(vertex_layout_[kLeft]);
+    GetGraphicsPipeline(vertex_layout_[kRight]);
+  }
+
+  /**
+   * Adds serialized pipeline cache data to the pipeline cache, and sets the
+   * file the cache is saved to when the renderer is destroyed.
+   *
+   * @param data Serialized pipeline cache. When it is null or incompatible
+   *        with the device, the data is read from @p path instead.
+   * @param size Size of @p data in bytes.
+   * @param path File the pipeline cache is loaded from and saved to. It may be
+   *        null.
+   */
+  void SetPipelineCache(const uint8_t* data, size_t size, const char* path) {
+    pipeline_cache_path_ = path == nullptr ? "" : path;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device_, &properties);
+
+    std::vector<uint8_t> file_data;
+    if (!IsPipelineCacheDataCompatible(data, size, properties)) {
+      if (pipeline_cache_path_.empty()) {
+        return;
+      }
+      file_data = ReadFile(pipeline_cache_path_);
+      if (!IsPipelineCacheDataCompatible(file_data.data(), file_data.size(),
+                                         properties)) {
+        return;
+      }
+      data = file_data.data();
+      size = file_data.size();
+    }
+
+    // The data is merged rather than used to create a new cache, so it is
+    // added to what the cache already holds.
+    const VkPipelineCacheCreateInfo pipeline_cache_create_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = size,
+        .pInitialData = data,
+    };
+    VkPipelineCache source_cache = VK_NULL_HANDLE;
+    CALL_VK(vkCreatePipelineCache(logical_device_, &pipeline_cache_create_info,
+                                  nullptr, &source_cache));
+    if (source_cache == VK_NULL_HANDLE) {
+      return;
+    }
+    CALL_VK(vkMergePipelineCaches(logical_device_, pipeline_cache_, 1,
+                                  &source_cache));
+    vkDestroyPipelineCache(logical_device_, source_cache, nullptr);
+  }
+
+  /**
+   * Gets the serialized pipeline cache.
+   *
+   * @param data Buffer where the data is written. When it is null, only the
+   *        size is returned.
+   * @param size Size of @p data in bytes. It is set to the number of bytes
+   *        written, or to the size of the whole data when @p data is null.
+   */
+  void GetPipelineCacheData(uint8_t* data, size_t* size) const {
+    if (pipeline_cache_ == VK_NULL_HANDLE) {
+      *size = 0;
+      return;
+    }
+    const VkResult result =
+        vkGetPipelineCacheData(logical_device_, pipeline_cache_, size, data);
+    // VK_INCOMPLETE means that @p data was too small, and that as much data as
+    // fits was written.
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE) {
+      CARDBOARD_LOGE("Failed to get the pipeline cache data. Error Code[%d]",
+                     result);
+      *size = 0;
+    }
+  }
+
  private:
   void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
                     VkMemoryPropertyFlags properties, VkBuffer& buffer,
@@ -316,16 +524,105 @@ class VulkanDistortionRenderer : public DistortionRenderer {
   }
 
   /**
-   * Create the graphics pipeline for the given eye.
-   * It cleans the previous pipeline if it exists.
+   * Create the pipeline cache, starting from the data saved by the last
+   * destroyed renderer when it is compatible with the device.
+   */
+  void CreatePipelineCache() {
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device_, &properties);
+
+    std::vector<uint8_t> initial_data;
+    {
+      std::lock_guard<std::mutex> lock(GetSavedPipelineCacheMutex());
+      initial_data = GetSavedPipelineCacheData();
+    }
+    if (!IsPipelineCacheDataCompatible(initial_data.data(),
+                                       initial_data.size(), properties)) {
+      initial_data.clear();
+    }
+
+    const VkPipelineCacheCreateInfo pipeline_cache_create_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.empty() ? nullptr : initial_data.data(),
+    };
+    CALL_VK(vkCreatePipelineCache(logical_device_, &pipeline_cache_create_info,
+                                  nullptr, &pipeline_cache_));
+  }
+
+  /**
+   * Saves the pipeline cache data for the next renderer, and to the pipeline
+   * cache file if there is one.
+   */
+  void SavePipelineCache() {
+    size_t size = 0;
+    GetPipelineCacheData(nullptr, &size);
+    std::vector<uint8_t> data(size);
+    GetPipelineCacheData(data.data(), &size);
+    data.resize(size);
+    if (data.empty()) {
+      return;
+    }
+
+    if (!pipeline_cache_path_.empty() &&
+        !WriteFile(pipeline_cache_path_, data)) {
+      CARDBOARD_LOGE("Failed to write the pipeline cache to %s",
+                     pipeline_cache_path_.c_str());
+    }
+    std::lock_guard<std::mutex> lock(GetSavedPipelineCacheMutex());
+    GetSavedPipelineCacheData() = std::move(data);
+  }
+
+  /**
+   * Sets the render pass the pipelines are built for. The pipelines of the
+   * previous render pass are destroyed.
    *
-   * @param eye CardboardEye input.
+   * Only the pipelines of the last render pass are kept: a render pass handle
+   * may be reused for an incompatible render pass once the old one is
+   * destroyed, so pipelines cannot be looked up by handle. Rebuilding a
+   * pipeline that was built before is a pipeline cache hit.
    *
-   * @return VkPipeline the graphics pipeline output.
+   * @param render_pass Render pass the pipelines are used with.
    */
-  void CreateGraphicsPipeline(CardboardEye eye) {
-    CleanPipeline(eye);
+  void SetRenderPass(VkRenderPass render_pass) {
+    if (render_pass == current_render_pass_) {
+      return;
+    }
+    for (VkPipeline& pipeline : pipelines_) {
+      vkDestroyPipeline(logical_device_, pipeline, nullptr);
+      pipeline = VK_NULL_HANDLE;
+    }
+    current_render_pass_ = render_pass;
+  }
+
+  /**
+   * Gets the graphics pipeline of a vertex layout for the current render pass,
+   * building it the first time. Eyes with the same layout share it.
+   *
+   * @param layout Vertex layout of the mesh drawn with the pipeline.
+   *
+   * @return The graphics pipeline.
+   */
+  VkPipeline GetGraphicsPipeline(VertexLayout layout) {
+    if (pipelines_[layout] == VK_NULL_HANDLE) {
+      pipelines_[layout] = CreateGraphicsPipeline(current_render_pass_, layout);
+    }
+    return pipelines_[layout];
+  }
 
+  /**
+   * Create the graphics pipeline for the given render pass and vertex layout
+   * through the pipeline cache.
+   *
+   * @param render_pass Render pass the pipeline is used with.
+   * @param layout Vertex layout of the mesh drawn with the pipeline.
+   *
+   * @return VkPipeline the graphics pipeline output.
+   */
+  VkPipeline CreateGraphicsPipeline(VkRenderPass render_pass,
+                                    VertexLayout layout) {
     VkShaderModule vertex_shader =
         LoadShader(distortion_vert, sizeof(distortion_vert));
     VkShaderModule fragment_shader =
@@ -412,10 +709,14 @@ class VulkanDistortionRenderer : public DistortionRenderer {
         .primitiveRestartEnable = VK_FALSE,
     };
 
-    // Specify vertex input state
+    // Specify vertex input state. Compact components are normalized shorts.
+    const bool is_compact = layout == kCompactVertexLayout;
+    const VkFormat vertex_format =
+        is_compact ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32_SFLOAT;
     VkVertexInputBindingDescription vertex_input_bindings = {
         .binding = 0,
-        .stride = 4 * sizeof(float),
+        .stride = static_cast<uint32_t>(is_compact ? sizeof(CompactVertex)
+                                                   : sizeof(Vertex)),
         .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
     };
 
@@ -423,14 +724,18 @@ class VulkanDistortionRenderer : public DistortionRenderer {
         {
             .location = 0,
             .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = 0,
+            .format = vertex_format,
+            .offset = static_cast<uint32_t>(
+                is_compact ? offsetof(CompactVertex, pos_x)
+                           : offsetof(Vertex, pos_x)),
         },
         {
             .location = 1,
             .binding = 0,
-            .format = VK_FORMAT_R32G32_SFLOAT,
-            .offset = sizeof(float) * 2,
+            .format = vertex_format,
+            .offset = static_cast<uint32_t>(
+                is_compact ? offsetof(CompactVertex, tex_u)
+                           : offsetof(Vertex, tex_u)),
         }};
 
     VkPipelineVertexInputStateCreateInfo vertex_input_info = {
@@ -480,17 +785,19 @@ class VulkanDistortionRenderer : public DistortionRenderer {
         .pColorBlendState = &color_blend_info,
         .pDynamicState = &dynamic_state_info,
         .layout = pipeline_layout_,
-        .renderPass = current_render_pass_,
+        .renderPass = render_pass,
         .subpass = 0,
         .basePipelineHandle = VK_NULL_HANDLE,
         .basePipelineIndex = 0,
     };
-    CALL_VK(vkCreateGraphicsPipelines(logical_device_, VK_NULL_HANDLE, 1,
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    CALL_VK(vkCreateGraphicsPipelines(logical_device_, pipeline_cache_, 1,
                                       &pipeline_create_info, nullptr,
-                                      &graphics_pipeline_[eye]));
+                                      &pipeline));
 
     vkDestroyShaderModule(logical_device_, vertex_shader, nullptr);
     vkDestroyShaderModule(logical_device_, fragment_shader, nullptr);
+    return pipeline;
   }
 
   VkShaderModule LoadShader(const uint32_t* const content, size_t size) const {
@@ -609,13 +916,18 @@ class VulkanDistortionRenderer : public DistortionRenderer {
 
     vkUpdateDescriptorSets(logical_device_, 1, descriptor_writes, 0, nullptr);
 
-    // Update Viewport and scissor
-    VkViewport viewport = {.x = static_cast<float>(x),
-                           .y = static_cast<float>(y),
-                           .width = static_cast<float>(width),
-                           .height = static_cast<float>(height),
-                           .minDepth = 0.0,
-                           .maxDepth = 1.0};
+    // Update Viewport and scissor. Compact mesh positions are stored divided
+    // by position_scale_, so the viewport is scaled about its center to map
+    // them back to their location. The scissor keeps the eye's half of the
+    // screen.
+    const float scale = position_scale_[eye];
+    VkViewport viewport = {
+        .x = static_cast<float>(x) + 0.5f * width * (1.0f - scale),
+        .y = static_cast<float>(y) + 0.5f * height * (1.0f - scale),
+        .width = static_cast<float>(width) * scale,
+        .height = static_cast<float>(height) * scale,
+        .minDepth = 0.0,
+        .maxDepth = 1.0};
 
     VkRect2D scissor = {
         .extent = {.width = static_cast<uint32_t>(width / 2),
@@ -629,7 +941,7 @@ class VulkanDistortionRenderer : public DistortionRenderer {
 
     // Bind to the command buffer.
     vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      graphics_pipeline_[eye]);
+                      GetGraphicsPipeline(vertex_layout_[eye]));
     vkCmdSetViewport(command_buffer, 0, 1, &viewport);
     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
@@ -647,18 +959,6 @@ class VulkanDistortionRenderer : public DistortionRenderer {
                      0, 0, 0);
   }
 
-  /**
-   * Clean the graphics pipeline of the given eye.
-   *
-   * @param eye CardboardEye input.
-   */
-  void CleanPipeline(CardboardEye eye) {
-    if (graphics_pipeline_[eye] != VK_NULL_HANDLE) {
-      vkDestroyPipeline(logical_device_, graphics_pipeline_[eye], nullptr);
-      graphics_pipeline_[eye] = VK_NULL_HANDLE;
-    }
-  }
-
   /**
    * Clean the image view of the given eye and swapchain image index.
    *
@@ -677,15 +977,20 @@ class VulkanDistortionRenderer : public DistortionRenderer {
   VkPhysicalDevice physical_device_;
   VkDevice logical_device_;
   VkSwapchainKHR swapchain_;
-  VkRenderPass current_render_pass_;
+  VkRenderPass current_render_pass_ = VK_NULL_HANDLE;
   int indices_count_;
+  float position_scale_[2] = {1.0f, 1.0f};
+  VertexLayout vertex_layout_[2] = {kFloatVertexLayout, kFloatVertexLayout};
 
   // Variables created and maintained by the distortion renderer.
   uint32_t swapchain_image_count_;
   VkSampler texture_sampler_;
   VkDescriptorSetLayout descriptor_set_layout_;
   VkPipelineLayout pipeline_layout_;
-  VkPipeline graphics_pipeline_[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+  VkPipelineCache pipeline_cache_ = VK_NULL_HANDLE;
+  std::string pipeline_cache_path_;
+  // Pipelines for current_render_pass_, indexed by VertexLayout.
+  std::array<VkPipeline, 2> pipelines_{VK_NULL_HANDLE, VK_NULL_HANDLE};
   VkBuffer vertex_buffers_[2];
   VkDeviceMemory vertex_buffers_memory_[2];
   VkBuffer index_buffers_[2];
@@ -709,4 +1014,41 @@ CardboardDistortionRenderer* CardboardVulkanDistortionRenderer_create(
       new cardboard::rendering::VulkanDistortionRenderer(config));
 }
 
+void CardboardVulkanDistortionRenderer_prepareRenderPass(
+    CardboardDistortionRenderer* renderer, uint64_t vk_render_pass) {
+  const VkRenderPass* render_pass =
+      reinterpret_cast<const VkRenderPass*>(vk_render_pass);
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer) ||
+      CARDBOARD_IS_ARG_NULL(render_pass)) {
+    return;
+  }
+
+  reinterpret_cast<cardboard::rendering::VulkanDistortionRenderer*>(renderer)
+      ->PrepareRenderPass(*render_pass);
+}
+
+void CardboardVulkanDistortionRenderer_setPipelineCache(
+    CardboardDistortionRenderer* renderer, const uint8_t* data, int32_t size,
+    const char* path) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer)) {
+    return;
+  }
+
+  reinterpret_cast<cardboard::rendering::VulkanDistortionRenderer*>(renderer)
+      ->SetPipelineCache(data, data == nullptr ? 0 : std::max(size, 0), path);
+}
+
+void CardboardVulkanDistortionRenderer_getPipelineCacheData(
+    CardboardDistortionRenderer* renderer, uint8_t* data, int32_t* size) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer) ||
+      CARDBOARD_IS_ARG_NULL(size)) {
+    return;
+  }
+
+  size_t data_size = data == nullptr ? 0 : std::max(*size, 0);
+  reinterpret_cast<cardboard::rendering::VulkanDistortionRenderer*>(renderer)
+      ->GetPipelineCacheData(data, &data_size);
+  *size = static_cast<int32_t>(data_size);
+}
+
 }  // extern "C"
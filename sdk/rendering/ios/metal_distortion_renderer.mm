@@ -28,6 +28,9 @@ namespace {
 typedef enum VertexInputIndex {
   VertexInputIndexPosition = 0,
   VertexInputIndexTexCoords,
+  VertexInputIndexPositionScale,
+  // Compact vertices are interleaved in a single buffer.
+  VertexInputIndexVertices = VertexInputIndexPosition,
 } VertexInputIndex;
 
 /// @note This enum must be kept in sync with the shader counterpart.
@@ -38,10 +41,11 @@ typedef enum FragmentInputIndex {
 } FragmentInputIndex;
 
 /// @note This struct must be kept in sync with the shader counterpart.
-typedef struct Vertex {
-  vector_float2 position;
-  vector_float2 tex_coords;
-} Vertex;
+/// Vertex layout of CardboardCompactMesh, with normalized 16-bit components.
+typedef struct CompactVertex {
+  vector_short2 position;
+  vector_short2 tex_coords;
+} CompactVertex;
 
 // TODO(b/178125083): Revisit Metal shader approach.
 constexpr const char* kMetalShaders =
@@ -53,6 +57,8 @@ constexpr const char* kMetalShaders =
     typedef enum VertexInputIndex {
       VertexInputIndexPosition = 0,
       VertexInputIndexTexCoords,
+      VertexInputIndexPositionScale,
+      VertexInputIndexVertices = VertexInputIndexPosition,
     } VertexInputIndex;
 
     typedef enum FragmentInputIndex {
@@ -61,10 +67,10 @@ constexpr const char* kMetalShaders =
       FragmentInputIndexEnd,
     } FragmentInputIndex;
 
-    typedef struct Vertex {
-      vector_float2 position;
-      vector_float2 tex_coords;
-    } Vertex;
+    typedef struct CompactVertex {
+      vector_short2 position;
+      vector_short2 tex_coords;
+    } CompactVertex;
 
     struct VertexOut {
       float4 position [[position]];
@@ -81,6 +87,19 @@ constexpr const char* kMetalShaders =
       return out;
     }
 
+    vertex VertexOut compactVertexShader(uint vertexID [[vertex_id]],
+                                         constant CompactVertex *vertices [[buffer(VertexInputIndexVertices)]],
+                                         constant float *position_scale [[buffer(VertexInputIndexPositionScale)]]) {
+      VertexOut out;
+      // Components are signed normalized shorts.
+      float2 position = max(float2(vertices[vertexID].position) / 32767.0, -1.0);
+      float2 tex_coords = max(float2(vertices[vertexID].tex_coords) / 32767.0, -1.0);
+      out.position = vector_float4(position * *position_scale, 0.0, 1.0);
+      // The v coordinate of the distortion mesh is reversed compared to what Metal expects, so we invert it.
+      out.tex_coords = vector_float2(tex_coords.x, 1.0 - tex_coords.y);
+      return out;
+    }
+
     fragment float4 fragmentShader(VertexOut in [[stage_in]],
                                    texture2d<half> colorTexture [[texture(FragmentInputIndexTexture)]],
                                    constant vector_float2 *start [[buffer(FragmentInputIndexStart)]],
@@ -116,6 +135,8 @@ class MetalDistortionRenderer : public DistortionRenderer {
     }
 
     id<MTLFunction> vertex_function = [mtl_library newFunctionWithName:@"vertexShader"];
+    id<MTLFunction> compact_vertex_function =
+        [mtl_library newFunctionWithName:@"compactVertexShader"];
     id<MTLFunction> fragment_function = [mtl_library newFunctionWithName:@"fragmentShader"];
 
     // Create pipeline.
@@ -132,7 +153,10 @@ class MetalDistortionRenderer : public DistortionRenderer {
         static_cast<MTLPixelFormat>(config->stencil_attachment_pixel_format);
     mtl_render_pipeline_state_ =
         [mtl_device_ newRenderPipelineStateWithDescriptor:mtl_render_pipeline_descriptor error:nil];
-    if (mtl_render_pipeline_state_ == nil) {
+    mtl_render_pipeline_descriptor.vertexFunction = compact_vertex_function;
+    mtl_compact_render_pipeline_state_ =
+        [mtl_device_ newRenderPipelineStateWithDescriptor:mtl_render_pipeline_descriptor error:nil];
+    if (mtl_render_pipeline_state_ == nil || mtl_compact_render_pipeline_state_ == nil) {
       CARDBOARD_LOGE("Failed to create Metal render pipeline.");
       return;
     }
@@ -155,6 +179,20 @@ class MetalDistortionRenderer : public DistortionRenderer {
                                                     length:(mesh->n_indices * sizeof(int))
                                                    options:MTLResourceStorageModeShared];
     indices_count_[eye] = mesh->n_indices;
+    is_compact_[eye] = false;
+  }
+
+  void SetCompactMesh(const CardboardCompactMesh* mesh, CardboardEye eye) override {
+    vertices_buffer_[eye] = [mtl_device_ newBufferWithBytes:mesh->vertices
+                                                     length:(mesh->n_vertices * sizeof(CompactVertex))
+                                                    options:MTLResourceStorageModeShared];
+    uvs_buffer_[eye] = nil;
+    indices_buffer_[eye] = [mtl_device_ newBufferWithBytes:mesh->indices
+                                                    length:(mesh->n_indices * sizeof(uint16_t))
+                                                   options:MTLResourceStorageModeShared];
+    indices_count_[eye] = mesh->n_indices;
+    position_scale_[eye] = mesh->position_scale;
+    is_compact_[eye] = true;
   }
 
   void RenderEyeToDisplay(uint64_t target, int x, int y, int width, int height,
@@ -181,8 +219,6 @@ class MetalDistortionRenderer : public DistortionRenderer {
         (__bridge id<MTLRenderCommandEncoder>)reinterpret_cast<CFTypeRef>(
             target_config->render_command_encoder);
 
-    [mtl_render_command_encoder setRenderPipelineState:mtl_render_pipeline_state_];
-
     // Translate y coordinate of the rectangle since in Metal the (0,0) coordinate is
     // located on the top-left corner instead of the bottom-left corner.
     const int mtl_viewport_y = target_config->screen_height - height - y;
@@ -200,13 +236,28 @@ class MetalDistortionRenderer : public DistortionRenderer {
   void RenderDistortionMesh(id<MTLRenderCommandEncoder> mtl_render_command_encoder,
                             const CardboardEyeTextureDescription* eye_description,
                             CardboardEye eye) const {
-    [mtl_render_command_encoder setVertexBuffer:vertices_buffer_[eye]
-                                         offset:0
-                                        atIndex:VertexInputIndexPosition];
-
-    [mtl_render_command_encoder setVertexBuffer:uvs_buffer_[eye]
-                                         offset:0
-                                        atIndex:VertexInputIndexTexCoords];
+    if (is_compact_[eye]) {
+      [mtl_render_command_encoder setRenderPipelineState:mtl_compact_render_pipeline_state_];
+
+      [mtl_render_command_encoder setVertexBuffer:vertices_buffer_[eye]
+                                           offset:0
+                                          atIndex:VertexInputIndexVertices];
+
+      const float position_scale = position_scale_[eye];
+      [mtl_render_command_encoder setVertexBytes:&position_scale
+                                          length:sizeof(position_scale)
+                                         atIndex:VertexInputIndexPositionScale];
+    } else {
+      [mtl_render_command_encoder setRenderPipelineState:mtl_render_pipeline_state_];
+
+      [mtl_render_command_encoder setVertexBuffer:vertices_buffer_[eye]
+                                           offset:0
+                                          atIndex:VertexInputIndexPosition];
+
+      [mtl_render_command_encoder setVertexBuffer:uvs_buffer_[eye]
+                                           offset:0
+                                          atIndex:VertexInputIndexTexCoords];
+    }
 
     [mtl_render_command_encoder
         setFragmentTexture:(__bridge id<MTLTexture>)reinterpret_cast<CFTypeRef>(
@@ -225,19 +276,24 @@ class MetalDistortionRenderer : public DistortionRenderer {
 
     [mtl_render_command_encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangleStrip
                                            indexCount:indices_count_[eye]
-                                            indexType:MTLIndexTypeUInt32
+                                            indexType:is_compact_[eye] ? MTLIndexTypeUInt16
+                                                                       : MTLIndexTypeUInt32
                                           indexBuffer:indices_buffer_[eye]
                                     indexBufferOffset:0];
   }
 
   id<MTLDevice> mtl_device_;
   id<MTLRenderPipelineState> mtl_render_pipeline_state_;
+  id<MTLRenderPipelineState> mtl_compact_render_pipeline_state_;
 
   // Mesh buffers. One per eye.
   std::array<id<MTLBuffer>, 2> vertices_buffer_;
-  std::array<id<MTLBuffer>, 2> uvs_buffer_;
+  std::array<id<MTLBuffer>, 2> uvs_buffer_;  // Unused by compact meshes.
   std::array<id<MTLBuffer>, 2> indices_buffer_;
   std::array<int, 2> indices_count_{0, 0};
+  std::array<float, 2> position_scale_{1.0f, 1.0f};
+  // Whether the mesh of each eye was set with SetCompactMesh().
+  std::array<bool, 2> is_compact_{false, false};
 
   bool is_initialized_{false};
 };
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
 #ifdef CARDBOARD_USE_CUSTOM_GL_BINDINGS
@@ -26,28 +28,42 @@
 #endif
 #ifdef __APPLE__
 #include <OpenGLES/ES2/gl.h>
+#include <OpenGLES/ES2/glext.h>
 #endif
 #ifdef __ANDROID__
+#define GL_GLEXT_PROTOTYPES
 #include <GLES2/gl2ext.h>
 #endif
 #endif  // CARDBOARD_USE_CUSTOM_GL_BINDINGS
+
+// glDiscardFramebufferEXT() is declared by the extension header of iOS, and by
+// the other ones when GL_GLEXT_PROTOTYPES is defined.
+#if defined(GL_EXT_discard_framebuffer) && \
+    (defined(__APPLE__) || defined(GL_GLEXT_PROTOTYPES))
+#define CARDBOARD_HAS_DISCARD_FRAMEBUFFER
+#endif
 #include "distortion_renderer.h"
 #include "include/cardboard.h"
+#include "stereo_mesh.h"
 #include "util/is_arg_null.h"
 #include "util/is_initialized.h"
 #include "util/logging.h"
+#include "vignette_mesh.h"
 
 namespace {
 
 constexpr const char* kDistortionVertexShader =
     R"glsl(
+    uniform float u_PositionScale;
+    uniform mat3 u_Reprojection;
     attribute vec2 a_Position;
     attribute vec2 a_TexCoords;
     varying vec2 v_TexCoords;
 
     void main() {
-      gl_Position = vec4(a_Position, 0, 1);
-      v_TexCoords = a_TexCoords;
+      gl_Position = vec4(a_Position * u_PositionScale, 0, 1);
+      vec3 tex_coords = u_Reprojection * vec3(a_TexCoords, 1);
+      v_TexCoords = tex_coords.xy / tex_coords.z;
     })glsl";
 
 constexpr const char* kDistortionFragmentShaderTexture2D =
@@ -81,6 +97,90 @@ constexpr const char* kDistortionFragmentShaderTextureExternalOes =
     })glsl";
 #endif
 
+// Draws the meshes of both eyes at once. See StereoMesh.
+constexpr const char* kStereoDistortionVertexShader =
+    R"glsl(
+    uniform vec2 u_PositionScale;
+    uniform vec4 u_LeftUvRect;
+    uniform vec4 u_RightUvRect;
+    uniform mat3 u_LeftReprojection;
+    uniform mat3 u_RightReprojection;
+    attribute vec2 a_Position;
+    attribute vec2 a_TexCoords;
+    attribute float a_Eye;
+    varying vec2 v_TexCoords;
+    varying float v_Eye;
+    invariant gl_Position;
+
+    void main() {
+      float position_scale = mix(u_PositionScale.x, u_PositionScale.y, a_Eye);
+      vec4 uv_rect = mix(u_LeftUvRect, u_RightUvRect, a_Eye);
+      mat3 reprojection =
+          a_Eye < 0.5 ? u_LeftReprojection : u_RightReprojection;
+      gl_Position = vec4(a_Position * position_scale, 0, 1);
+      vec3 tex_coords = reprojection * vec3(a_TexCoords, 1);
+      v_TexCoords = mix(uv_rect.xy, uv_rect.zw, tex_coords.xy / tex_coords.z);
+      v_Eye = a_Eye;
+    })glsl";
+
+// Both textures are sampled and the eye is selected afterwards, since
+// implicit derivatives are undefined in non-uniform control flow.
+constexpr const char* kStereoDistortionFragmentShaderTexture2D =
+    R"glsl(
+    precision mediump float;
+
+    uniform sampler2D u_LeftTexture;
+    uniform sampler2D u_RightTexture;
+    varying vec2 v_TexCoords;
+    varying float v_Eye;
+
+    void main() {
+      vec4 left_color = texture2D(u_LeftTexture, v_TexCoords);
+      vec4 right_color = texture2D(u_RightTexture, v_TexCoords);
+      gl_FragColor = mix(left_color, right_color, step(0.5, v_Eye));
+    })glsl";
+
+#ifdef __ANDROID__
+constexpr const char* kStereoDistortionFragmentShaderTextureExternalOes =
+    R"glsl(
+    #extension GL_OES_EGL_image_external : require
+    precision mediump float;
+
+    uniform samplerExternalOES u_LeftTexture;
+    uniform samplerExternalOES u_RightTexture;
+    varying vec2 v_TexCoords;
+    varying float v_Eye;
+
+    void main() {
+      vec4 left_color = texture2D(u_LeftTexture, v_TexCoords);
+      vec4 right_color = texture2D(u_RightTexture, v_TexCoords);
+      gl_FragColor = mix(left_color, right_color, step(0.5, v_Eye));
+    })glsl";
+#endif
+
+// Fills the part of the viewport the meshes do not cover. See VignetteMesh.
+// Positions are computed like in kStereoDistortionVertexShader, so that the
+// edges shared with the meshes are rasterized alike.
+constexpr const char* kVignetteVertexShader =
+    R"glsl(
+    uniform vec2 u_PositionScale;
+    attribute vec2 a_Position;
+    attribute float a_Eye;
+    invariant gl_Position;
+
+    void main() {
+      float position_scale = mix(u_PositionScale.x, u_PositionScale.y, a_Eye);
+      gl_Position = vec4(a_Position * position_scale, 0, 1);
+    })glsl";
+
+constexpr const char* kVignetteFragmentShader =
+    R"glsl(
+    precision mediump float;
+
+    void main() {
+      gl_FragColor = vec4(0, 0, 0, 1);
+    })glsl";
+
 void CheckGlError(const char* label) {
   int gl_error = glGetError();
   if (gl_error != GL_NO_ERROR) {
@@ -169,17 +269,31 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
         uvs_vbo_{0, 0},
         elements_vbo_{0, 0},
         elements_count_{0, 0},
-        eye_texture_type_{GL_TEXTURE_2D} {
+        elements_type_{GL_UNSIGNED_INT, GL_UNSIGNED_INT},
+        position_scale_{1.0f, 1.0f},
+        is_compact_{false, false},
+        stereo_vertices_vbo_{0},
+        stereo_elements_vbo_{0},
+        stereo_elements_count_{0},
+        vignette_vertices_vbo_{0},
+        vignette_elements_vbo_{0},
+        vignette_elements_count_{0},
+        eye_texture_type_{GL_TEXTURE_2D},
+        discard_framebuffer_supported_{false} {
     const char* fragment_shader;
+    const char* stereo_fragment_shader;
 
     switch (config->texture_type) {
       case kGlTexture2D:
         fragment_shader = kDistortionFragmentShaderTexture2D;
+        stereo_fragment_shader = kStereoDistortionFragmentShaderTexture2D;
         eye_texture_type_ = GL_TEXTURE_2D;
         break;
 #ifdef __ANDROID__
       case kGlTextureExternalOes:
         fragment_shader = kDistortionFragmentShaderTextureExternalOes;
+        stereo_fragment_shader =
+            kStereoDistortionFragmentShaderTextureExternalOes;
         eye_texture_type_ = GL_TEXTURE_EXTERNAL_OES;
         break;
 #endif
@@ -189,6 +303,7 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
             "this platform. Setting GL_TEXTURE_2D as default.");
 
         fragment_shader = kDistortionFragmentShaderTexture2D;
+        stereo_fragment_shader = kStereoDistortionFragmentShaderTexture2D;
         eye_texture_type_ = GL_TEXTURE_2D;
         break;
     }
@@ -198,11 +313,58 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
     attrib_tex_ = glGetAttribLocation(program_, "a_TexCoords");
     uniform_start_ = glGetUniformLocation(program_, "u_Start");
     uniform_end_ = glGetUniformLocation(program_, "u_End");
+    uniform_position_scale_ =
+        glGetUniformLocation(program_, "u_PositionScale");
+    uniform_reprojection_ = glGetUniformLocation(program_, "u_Reprojection");
+
+    stereo_program_ =
+        CreateProgram(kStereoDistortionVertexShader, stereo_fragment_shader);
+    stereo_attrib_pos_ = glGetAttribLocation(stereo_program_, "a_Position");
+    stereo_attrib_tex_ = glGetAttribLocation(stereo_program_, "a_TexCoords");
+    stereo_attrib_eye_ = glGetAttribLocation(stereo_program_, "a_Eye");
+    stereo_uniform_position_scale_ =
+        glGetUniformLocation(stereo_program_, "u_PositionScale");
+    stereo_uniform_left_uv_rect_ =
+        glGetUniformLocation(stereo_program_, "u_LeftUvRect");
+    stereo_uniform_right_uv_rect_ =
+        glGetUniformLocation(stereo_program_, "u_RightUvRect");
+    stereo_uniform_reprojection_[kLeft] =
+        glGetUniformLocation(stereo_program_, "u_LeftReprojection");
+    stereo_uniform_reprojection_[kRight] =
+        glGetUniformLocation(stereo_program_, "u_RightReprojection");
+
+    // The eye textures are bound to the first two texture units. Sampler
+    // uniforms are part of the program, so they are set once.
+    GLint current_program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+    glUseProgram(stereo_program_);
+    glUniform1i(glGetUniformLocation(stereo_program_, "u_LeftTexture"), 0);
+    glUniform1i(glGetUniformLocation(stereo_program_, "u_RightTexture"), 1);
+    glUseProgram(static_cast<GLuint>(current_program));
+
+    vignette_program_ =
+        CreateProgram(kVignetteVertexShader, kVignetteFragmentShader);
+    vignette_attrib_pos_ = glGetAttribLocation(vignette_program_, "a_Position");
+    vignette_attrib_eye_ = glGetAttribLocation(vignette_program_, "a_Eye");
+    vignette_uniform_position_scale_ =
+        glGetUniformLocation(vignette_program_, "u_PositionScale");
+
+#ifdef CARDBOARD_HAS_DISCARD_FRAMEBUFFER
+    const char* extensions =
+        reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    discard_framebuffer_supported_ =
+        extensions != nullptr &&
+        std::strstr(extensions, "GL_EXT_discard_framebuffer") != nullptr;
+#endif
 
-    // Gen buffers, one per eye.
+    // Gen buffers, one per eye, one for both eyes and one for the vignette.
     glGenBuffers(2, &vertices_vbo_[0]);
     glGenBuffers(2, &uvs_vbo_[0]);
     glGenBuffers(2, &elements_vbo_[0]);
+    glGenBuffers(1, &stereo_vertices_vbo_);
+    glGenBuffers(1, &stereo_elements_vbo_);
+    glGenBuffers(1, &vignette_vertices_vbo_);
+    glGenBuffers(1, &vignette_elements_vbo_);
     CheckGlError("OpenGlEs2DistortionRendererSetUp");
   }
 
@@ -210,6 +372,10 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
     glDeleteBuffers(2, &vertices_vbo_[0]);
     glDeleteBuffers(2, &uvs_vbo_[0]);
     glDeleteBuffers(2, &elements_vbo_[0]);
+    glDeleteBuffers(1, &stereo_vertices_vbo_);
+    glDeleteBuffers(1, &stereo_elements_vbo_);
+    glDeleteBuffers(1, &vignette_vertices_vbo_);
+    glDeleteBuffers(1, &vignette_elements_vbo_);
     CheckGlError("~OpenGlEs2DistortionRenderer");
   }
 
@@ -235,6 +401,71 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     CheckGlError("OpenGlEs2DistortionRenderer::SetMesh");
     elements_count_[eye] = mesh->n_indices;
+    elements_type_[eye] = GL_UNSIGNED_INT;
+    position_scale_[eye] = 1.0f;
+    is_compact_[eye] = false;
+
+    // Single pass rendering and the vignette need compact meshes.
+    stereo_elements_count_ = 0;
+    vignette_elements_count_ = 0;
+  }
+
+  /*
+   * Modifies the OpenGL global state. In particular:
+   *   - glGet(GL_ARRAY_BUFFER_BINDING)
+   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+   */
+  void SetCompactMesh(const CardboardCompactMesh* mesh,
+                      CardboardEye eye) override {
+    glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_[eye]);
+    glBufferData(GL_ARRAY_BUFFER,
+                 mesh->n_vertices * sizeof(int16_t) *
+                     4,  // Four interleaved components per vertex
+                 mesh->vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_[eye]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->n_indices * sizeof(uint16_t),
+                 mesh->indices, GL_STATIC_DRAW);
+    elements_count_[eye] = mesh->n_indices;
+    elements_type_[eye] = GL_UNSIGNED_SHORT;
+    position_scale_[eye] = mesh->position_scale;
+    is_compact_[eye] = true;
+
+    // Both eyes are packed together when they can be drawn in one pass.
+    stereo_mesh_.SetEyeMesh(eye, *mesh);
+    stereo_elements_count_ = 0;
+    if (is_compact_[kLeft] && is_compact_[kRight] &&
+        stereo_mesh_.CanDrawInOnePass()) {
+      const std::vector<int16_t>& vertices = stereo_mesh_.GetVertices();
+      const std::vector<uint16_t>& indices = stereo_mesh_.GetIndices();
+      glBindBuffer(GL_ARRAY_BUFFER, stereo_vertices_vbo_);
+      glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(int16_t),
+                   vertices.data(), GL_STATIC_DRAW);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stereo_elements_vbo_);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+                   indices.data(), GL_STATIC_DRAW);
+      stereo_elements_count_ = static_cast<int>(indices.size());
+    }
+
+    // The vignette can replace the color clear when it covers what the meshes
+    // do not. Its positions are computed like the ones of the single pass, so
+    // it is only drawn with it.
+    vignette_mesh_.SetEyeMesh(eye, *mesh);
+    vignette_elements_count_ = 0;
+    if (stereo_elements_count_ > 0 && vignette_mesh_.IsValid()) {
+      const std::vector<int16_t>& vertices = vignette_mesh_.GetVertices();
+      const std::vector<uint16_t>& indices = vignette_mesh_.GetIndices();
+      glBindBuffer(GL_ARRAY_BUFFER, vignette_vertices_vbo_);
+      glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(int16_t),
+                   vertices.data(), GL_STATIC_DRAW);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vignette_elements_vbo_);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+                   indices.data(), GL_STATIC_DRAW);
+      vignette_elements_count_ = static_cast<int>(indices.size());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    CheckGlError("OpenGlEs2DistortionRenderer::SetCompactMesh");
   }
 
   /*
@@ -249,6 +480,16 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
    *   - glGet(GL_ACTIVE_TEXTURE+i)
    *   - glGet(GL_ARRAY_BUFFER_BINDING)
    *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+   *
+   * When both eye meshes are compact and lie on their own half of the
+   * viewport, both eyes are drawn with a single call and no scissor.
+   * Otherwise, each eye is drawn with its own scissor.
+   *
+   * When the vignette fill is enabled, both eyes are drawn with a single call
+   * and the vignette mesh covers the part of the viewport that they do not,
+   * the color buffer is discarded if GL_EXT_discard_framebuffer is supported,
+   * the vignette is drawn in black and only the depth buffer is cleared.
+   * Otherwise, the color buffer is cleared too.
    */
   void RenderEyeToDisplay(
       uint64_t target, int x, int y, int width, int height,
@@ -266,16 +507,28 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
     glDisable(GL_SCISSOR_TEST);
     glDisable(GL_CULL_FACE);
     glClearColor(.0f, .0f, .0f, 1.0f);
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    if (IsVignetteFillEnabled() && vignette_elements_count_ > 0) {
+      DiscardColorBuffer(static_cast<GLuint>(target));
+      glClear(GL_DEPTH_BUFFER_BIT);
+      glUseProgram(vignette_program_);
+      RenderVignette();
+    } else {
+      glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    }
 
-    glUseProgram(program_);
+    if (stereo_elements_count_ > 0) {
+      glUseProgram(stereo_program_);
+      RenderStereoDistortionMesh(left_eye, right_eye);
+    } else {
+      glUseProgram(program_);
 
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(x, y, width / 2, height);
-    RenderDistortionMesh(left_eye, kLeft);
+      glEnable(GL_SCISSOR_TEST);
+      glScissor(x, y, width / 2, height);
+      RenderDistortionMesh(left_eye, kLeft);
 
-    glScissor(x + width / 2, y, width / 2, height);
-    RenderDistortionMesh(right_eye, kRight);
+      glScissor(x + width / 2, y, width / 2, height);
+      RenderDistortionMesh(right_eye, kRight);
+    }
 
     // Active GL_TEXTURE0 effectively enables the first texture that is
     // deactiviated by the DistortionRenderer. Binding array buffer and element
@@ -292,6 +545,104 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
   }
 
  private:
+  /*
+   * Modifies the OpenGL global state. In particular:
+   *   - glGet(GL_ARRAY_BUFFER_BINDING)
+   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+   *   - glGetVertexAttrib(i, GL_VERTEX_ATTRIB_*)
+   *   - glGetVertextAttrib(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED)
+   */
+  void RenderVignette() const {
+    // Positions and eyes are interleaved normalized shorts.
+    glBindBuffer(GL_ARRAY_BUFFER, vignette_vertices_vbo_);
+    glVertexAttribPointer(vignette_attrib_pos_,
+                          2,  // 2 components per vertex
+                          GL_SHORT, true, kVignetteVertexStride, 0);
+    glEnableVertexAttribArray(vignette_attrib_pos_);
+    glVertexAttribPointer(
+        vignette_attrib_eye_, 1, GL_SHORT, true, kVignetteVertexStride,
+        reinterpret_cast<const void*>(VignetteMesh::kEyeOffset));
+    glEnableVertexAttribArray(vignette_attrib_eye_);
+
+    glUniform2f(vignette_uniform_position_scale_,
+                vignette_mesh_.GetPositionScale(kLeft),
+                vignette_mesh_.GetPositionScale(kRight));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vignette_elements_vbo_);
+    glDrawElements(GL_TRIANGLES, vignette_elements_count_, GL_UNSIGNED_SHORT,
+                   0);
+    CheckGlError("OpenGlEs2DistortionRenderer::RenderVignette");
+  }
+
+  // Discards the color buffer of @p framebuffer, so that tile-based GPUs do
+  // not load it before the vignette is drawn. GL_EXT_discard_framebuffer has
+  // no rectangle, so the whole color buffer is discarded.
+  void DiscardColorBuffer(GLuint framebuffer) const {
+#ifdef CARDBOARD_HAS_DISCARD_FRAMEBUFFER
+    if (!discard_framebuffer_supported_) {
+      return;
+    }
+    const GLenum attachment =
+        framebuffer == 0 ? GL_COLOR_EXT : GL_COLOR_ATTACHMENT0;
+    glDiscardFramebufferEXT(GL_FRAMEBUFFER, 1, &attachment);
+    CheckGlError("OpenGlEs2DistortionRenderer::DiscardColorBuffer");
+#else
+    (void)framebuffer;
+#endif
+  }
+
+  /*
+   * Modifies the OpenGL global state. In particular:
+   *   - glGet(GL_ARRAY_BUFFER_BINDING)
+   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+   *   - glGetVertexAttrib(i, GL_VERTEX_ATTRIB_*)
+   *   - glGetVertextAttrib(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED)
+   *   - glGet(GL_ACTIVE_TEXTURE+i)
+   *   - glGet(GL_TEXTURE_BINDING_2D) of texture units 0 and 1
+   *   - glGetUniform(program, location)
+   */
+  void RenderStereoDistortionMesh(
+      const CardboardEyeTextureDescription* left_eye,
+      const CardboardEyeTextureDescription* right_eye) const {
+    // Positions, uvs and eyes are interleaved normalized shorts.
+    glBindBuffer(GL_ARRAY_BUFFER, stereo_vertices_vbo_);
+    glVertexAttribPointer(stereo_attrib_pos_,
+                          2,  // 2 components per vertex
+                          GL_SHORT, true, kStereoVertexStride, 0);
+    glEnableVertexAttribArray(stereo_attrib_pos_);
+    glVertexAttribPointer(stereo_attrib_tex_,
+                          2,  // 2 components per uv
+                          GL_SHORT, true, kStereoVertexStride,
+                          reinterpret_cast<const void*>(kUvOffset));
+    glEnableVertexAttribArray(stereo_attrib_tex_);
+    glVertexAttribPointer(
+        stereo_attrib_eye_, 1, GL_SHORT, true, kStereoVertexStride,
+        reinterpret_cast<const void*>(StereoMesh::kEyeOffset));
+    glEnableVertexAttribArray(stereo_attrib_eye_);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(eye_texture_type_, static_cast<GLuint>(left_eye->texture));
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(eye_texture_type_, static_cast<GLuint>(right_eye->texture));
+
+    glUniform2f(stereo_uniform_position_scale_,
+                stereo_mesh_.GetPositionScale(kLeft),
+                stereo_mesh_.GetPositionScale(kRight));
+    glUniform4f(stereo_uniform_left_uv_rect_, left_eye->left_u,
+                left_eye->bottom_v, left_eye->right_u, left_eye->top_v);
+    glUniform4f(stereo_uniform_right_uv_rect_, right_eye->left_u,
+                right_eye->bottom_v, right_eye->right_u, right_eye->top_v);
+    for (CardboardEye eye : {kLeft, kRight}) {
+      glUniformMatrix3fv(stereo_uniform_reprojection_[eye], 1, GL_FALSE,
+                         GetReprojectionMatrix(eye).data());
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stereo_elements_vbo_);
+    glDrawElements(GL_TRIANGLE_STRIP, stereo_elements_count_,
+                   GL_UNSIGNED_SHORT, 0);
+    CheckGlError("OpenGlEs2DistortionRenderer::RenderStereoDistortionMesh");
+  }
+
   /*
    * Modifies the OpenGL global state. In particular:
    *   - glGet(GL_ARRAY_BUFFER_BINDING)
@@ -308,18 +659,28 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
       const CardboardEyeTextureDescription* eye_description,
       CardboardEye eye) const {
     glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_[eye]);
-    glVertexAttribPointer(
-        attrib_pos_,
-        2,  // 2 components per vertex
-        GL_FLOAT, false,
-        0,  // Stride and offset 0, as we are using different vbos.
-        0);
+    if (is_compact_[eye]) {
+      // Positions and uvs are interleaved normalized shorts.
+      glVertexAttribPointer(attrib_pos_,
+                            2,  // 2 components per vertex
+                            GL_SHORT, true, kVertexStride, 0);
+      glVertexAttribPointer(attrib_tex_,
+                            2,  // 2 components per uv
+                            GL_SHORT, true, kVertexStride,
+                            reinterpret_cast<const void*>(kUvOffset));
+    } else {
+      glVertexAttribPointer(
+          attrib_pos_,
+          2,  // 2 components per vertex
+          GL_FLOAT, false,
+          0,  // Stride and offset 0, as we are using different vbos.
+          0);
+      glBindBuffer(GL_ARRAY_BUFFER, uvs_vbo_[eye]);
+      glVertexAttribPointer(attrib_tex_,
+                            2,  // 2 components per uv
+                            GL_FLOAT, false, 0, 0);
+    }
     glEnableVertexAttribArray(attrib_pos_);
-
-    glBindBuffer(GL_ARRAY_BUFFER, uvs_vbo_[eye]);
-    glVertexAttribPointer(attrib_tex_,
-                          2,  // 2 components per uv
-                          GL_FLOAT, false, 0, 0);
     glEnableVertexAttribArray(attrib_tex_);
 
     glActiveTexture(GL_TEXTURE0);
@@ -329,25 +690,70 @@ class OpenGlEs2DistortionRenderer : public DistortionRenderer {
     glUniform2f(uniform_start_, eye_description->left_u,
                 eye_description->bottom_v);
     glUniform2f(uniform_end_, eye_description->right_u, eye_description->top_v);
+    glUniform1f(uniform_position_scale_, position_scale_[eye]);
+    glUniformMatrix3fv(uniform_reprojection_, 1, GL_FALSE,
+                       GetReprojectionMatrix(eye).data());
 
     // Draw with indices
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_[eye]);
-    glDrawElements(GL_TRIANGLE_STRIP, elements_count_[eye], GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLE_STRIP, elements_count_[eye], elements_type_[eye],
+                   0);
     CheckGlError("OpenGlEs2DistortionRenderer::RenderDistortionMesh");
   }
 
+  // Vertex layout of CardboardCompactMesh.
+  static constexpr GLsizei kVertexStride = 4 * sizeof(int16_t);
+  static constexpr intptr_t kUvOffset = 2 * sizeof(int16_t);
+  // Vertex layout of StereoMesh.
+  static constexpr GLsizei kStereoVertexStride =
+      StereoMesh::kComponentsPerVertex * sizeof(int16_t);
+  // Vertex layout of VignetteMesh.
+  static constexpr GLsizei kVignetteVertexStride =
+      VignetteMesh::kComponentsPerVertex * sizeof(int16_t);
+
   std::array<GLuint, 2> vertices_vbo_;  // One per eye.
-  std::array<GLuint, 2> uvs_vbo_;
+  std::array<GLuint, 2> uvs_vbo_;       // Unused by compact meshes.
   std::array<GLuint, 2> elements_vbo_;
   std::array<int, 2> elements_count_;
+  std::array<GLenum, 2> elements_type_;
+  std::array<float, 2> position_scale_;
+  // Whether the mesh of each eye was set with SetCompactMesh().
+  std::array<bool, 2> is_compact_;
 
   GLuint program_;
   GLuint attrib_pos_;
   GLuint attrib_tex_;
   GLuint uniform_start_;
   GLuint uniform_end_;
+  GLuint uniform_position_scale_;
+  GLuint uniform_reprojection_;
+
+  // Single pass rendering of both eyes.
+  StereoMesh stereo_mesh_;
+  GLuint stereo_vertices_vbo_;
+  GLuint stereo_elements_vbo_;
+  int stereo_elements_count_;  // 0 when the eyes are drawn one by one.
+  GLuint stereo_program_;
+  GLuint stereo_attrib_pos_;
+  GLuint stereo_attrib_tex_;
+  GLuint stereo_attrib_eye_;
+  GLuint stereo_uniform_position_scale_;
+  GLuint stereo_uniform_left_uv_rect_;
+  GLuint stereo_uniform_right_uv_rect_;
+  std::array<GLuint, 2> stereo_uniform_reprojection_;
+
+  // Fill of the part of the viewport the meshes do not cover.
+  VignetteMesh vignette_mesh_;
+  GLuint vignette_vertices_vbo_;
+  GLuint vignette_elements_vbo_;
+  int vignette_elements_count_;  // 0 when the color buffer is cleared.
+  GLuint vignette_program_;
+  GLuint vignette_attrib_pos_;
+  GLuint vignette_attrib_eye_;
+  GLuint vignette_uniform_position_scale_;
 
   GLenum eye_texture_type_;
+  bool discard_framebuffer_supported_;
 };
 
 }  // namespace cardboard::rendering
@@ -17,6 +17,7 @@
  * the contents of this file if OpenGL ES 3.0 support is not needed.
  */
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #ifdef CARDBOARD_USE_CUSTOM_GL_BINDINGS
@@ -36,21 +37,34 @@
 #endif  // CARDBOARD_USE_CUSTOM_GL_BINDINGS
 #include "distortion_renderer.h"
 #include "include/cardboard.h"
+#include "stereo_mesh.h"
 #include "util/is_arg_null.h"
 #include "util/is_initialized.h"
 #include "util/logging.h"
+#include "vignette_mesh.h"
+
+// Issues an OpenGL ES call from the distortion pass and counts it in the
+// calls issued by the current frame.
+#define CALL_GL(call) \
+  do {                \
+    ++gl_call_count_; \
+    call;             \
+  } while (0)
 
 namespace {
 
 constexpr const char* kDistortionVertexShader =
     R"glsl(#version 300 es
+    uniform float u_PositionScale;
+    uniform mat3 u_Reprojection;
     layout (location = 0) in vec2 a_Position;
     layout (location = 1) in vec2 a_TexCoords;
     out vec2 v_TexCoords;
 
     void main() {
-      gl_Position = vec4(a_Position, 0, 1);
-      v_TexCoords = a_TexCoords;
+      gl_Position = vec4(a_Position * u_PositionScale, 0, 1);
+      vec3 tex_coords = u_Reprojection * vec3(a_TexCoords, 1);
+      v_TexCoords = tex_coords.xy / tex_coords.z;
     })glsl";
 
 constexpr const char* kDistortionFragmentShaderTexture2D =
@@ -85,6 +99,94 @@ constexpr const char* kDistortionFragmentShaderTextureExternalOes =
     })glsl";
 #endif
 
+// Draws the meshes of both eyes at once. See StereoMesh.
+constexpr const char* kStereoDistortionVertexShader =
+    R"glsl(#version 300 es
+    uniform vec2 u_PositionScale;
+    uniform vec4 u_LeftUvRect;
+    uniform vec4 u_RightUvRect;
+    uniform mat3 u_LeftReprojection;
+    uniform mat3 u_RightReprojection;
+    layout (location = 0) in vec2 a_Position;
+    layout (location = 1) in vec2 a_TexCoords;
+    layout (location = 2) in float a_Eye;
+    out vec2 v_TexCoords;
+    flat out float v_Eye;
+    invariant gl_Position;
+
+    void main() {
+      float position_scale = mix(u_PositionScale.x, u_PositionScale.y, a_Eye);
+      vec4 uv_rect = mix(u_LeftUvRect, u_RightUvRect, a_Eye);
+      mat3 reprojection =
+          a_Eye < 0.5 ? u_LeftReprojection : u_RightReprojection;
+      gl_Position = vec4(a_Position * position_scale, 0, 1);
+      vec3 tex_coords = reprojection * vec3(a_TexCoords, 1);
+      v_TexCoords = mix(uv_rect.xy, uv_rect.zw, tex_coords.xy / tex_coords.z);
+      v_Eye = a_Eye;
+    })glsl";
+
+// Both textures are sampled and the eye is selected afterwards, since
+// implicit derivatives are undefined in non-uniform control flow.
+constexpr const char* kStereoDistortionFragmentShaderTexture2D =
+    R"glsl(#version 300 es
+    precision mediump float;
+
+    uniform sampler2D u_LeftTexture;
+    uniform sampler2D u_RightTexture;
+    in vec2 v_TexCoords;
+    flat in float v_Eye;
+    out vec4 o_FragColor;
+
+    void main() {
+      vec4 left_color = texture(u_LeftTexture, v_TexCoords);
+      vec4 right_color = texture(u_RightTexture, v_TexCoords);
+      o_FragColor = mix(left_color, right_color, step(0.5, v_Eye));
+    })glsl";
+
+#ifdef __ANDROID__
+constexpr const char* kStereoDistortionFragmentShaderTextureExternalOes =
+    R"glsl(#version 300 es
+    #extension GL_OES_EGL_image_external_essl3 : require
+    precision mediump float;
+
+    uniform samplerExternalOES u_LeftTexture;
+    uniform samplerExternalOES u_RightTexture;
+    in vec2 v_TexCoords;
+    flat in float v_Eye;
+    out vec4 o_FragColor;
+
+    void main() {
+      vec4 left_color = texture(u_LeftTexture, v_TexCoords);
+      vec4 right_color = texture(u_RightTexture, v_TexCoords);
+      o_FragColor = mix(left_color, right_color, step(0.5, v_Eye));
+    })glsl";
+#endif
+
+// Fills the part of the viewport the meshes do not cover. See VignetteMesh.
+// Positions are computed like in kStereoDistortionVertexShader, so that the
+// edges shared with the meshes are rasterized alike.
+constexpr const char* kVignetteVertexShader =
+    R"glsl(#version 300 es
+    uniform vec2 u_PositionScale;
+    layout (location = 0) in vec2 a_Position;
+    layout (location = 1) in float a_Eye;
+    invariant gl_Position;
+
+    void main() {
+      float position_scale = mix(u_PositionScale.x, u_PositionScale.y, a_Eye);
+      gl_Position = vec4(a_Position * position_scale, 0, 1);
+    })glsl";
+
+constexpr const char* kVignetteFragmentShader =
+    R"glsl(#version 300 es
+    precision mediump float;
+
+    out vec4 o_FragColor;
+
+    void main() {
+      o_FragColor = vec4(0, 0, 0, 1);
+    })glsl";
+
 void CheckGlError(const char* label) {
   int gl_error = glGetError();
   if (gl_error != GL_NO_ERROR) {
@@ -165,6 +267,9 @@ GLuint CreateProgram(const char* vertex, const char* fragment) {
 namespace cardboard::rendering {
 
 // @brief OpenGL ES 3.0 concrete implementation of DistortionRenderer.
+//
+// The vertex layouts of the meshes are kept in vertex array objects, so a
+// draw only binds one of them.
 class OpenGlEs3DistortionRenderer : public DistortionRenderer {
  public:
   OpenGlEs3DistortionRenderer(
@@ -173,17 +278,46 @@ class OpenGlEs3DistortionRenderer : public DistortionRenderer {
         uvs_vbo_{0, 0},
         elements_vbo_{0, 0},
         elements_count_{0, 0},
-        eye_texture_type_{GL_TEXTURE_2D} {
+        elements_type_{GL_UNSIGNED_INT, GL_UNSIGNED_INT},
+        position_scale_{1.0f, 1.0f},
+        is_compact_{false, false},
+        vertex_arrays_{0, 0},
+        stereo_vertices_vbo_{0},
+        stereo_elements_vbo_{0},
+        stereo_elements_count_{0},
+        stereo_vertex_array_{0},
+        stereo_uniforms_valid_{false},
+        stereo_uv_rects_{},
+        stereo_reprojections_{},
+        vignette_vertices_vbo_{0},
+        vignette_elements_vbo_{0},
+        vignette_elements_count_{0},
+        vignette_vertex_array_{0},
+        vignette_uniforms_valid_{false},
+        eye_texture_type_{GL_TEXTURE_2D},
+        caller_guarantees_state_{config->caller_guarantees_state != 0},
+        fixed_state_set_{false},
+        viewport_{-1, -1, -1, -1},
+        bound_framebuffer_{kUnknownObject},
+        current_program_{kUnknownObject},
+        bound_vertex_array_{kUnknownObject},
+        active_texture_unit_{-1},
+        bound_textures_{kUnknownObject, kUnknownObject},
+        gl_call_count_{0} {
     const char* fragment_shader;
+    const char* stereo_fragment_shader;
 
     switch (config->texture_type) {
       case kGlTexture2D:
         fragment_shader = kDistortionFragmentShaderTexture2D;
+        stereo_fragment_shader = kStereoDistortionFragmentShaderTexture2D;
         eye_texture_type_ = GL_TEXTURE_2D;
         break;
 #ifdef __ANDROID__
       case kGlTextureExternalOes:
         fragment_shader = kDistortionFragmentShaderTextureExternalOes;
+        stereo_fragment_shader =
+            kStereoDistortionFragmentShaderTextureExternalOes;
         eye_texture_type_ = GL_TEXTURE_EXTERNAL_OES;
         break;
 #endif
@@ -193,6 +327,7 @@ class OpenGlEs3DistortionRenderer : public DistortionRenderer {
             "this platform. Setting GL_TEXTURE_2D as default.");
 
         fragment_shader = kDistortionFragmentShaderTexture2D;
+        stereo_fragment_shader = kStereoDistortionFragmentShaderTexture2D;
         eye_texture_type_ = GL_TEXTURE_2D;
         break;
     }
@@ -202,43 +337,215 @@ class OpenGlEs3DistortionRenderer : public DistortionRenderer {
     attrib_tex_ = glGetAttribLocation(program_, "a_TexCoords");
     uniform_start_ = glGetUniformLocation(program_, "u_Start");
     uniform_end_ = glGetUniformLocation(program_, "u_End");
-
-    // Gen buffers, one per eye.
+    uniform_position_scale_ =
+        glGetUniformLocation(program_, "u_PositionScale");
+    uniform_reprojection_ = glGetUniformLocation(program_, "u_Reprojection");
+
+    stereo_program_ =
+        CreateProgram(kStereoDistortionVertexShader, stereo_fragment_shader);
+    stereo_attrib_pos_ = glGetAttribLocation(stereo_program_, "a_Position");
+    stereo_attrib_tex_ = glGetAttribLocation(stereo_program_, "a_TexCoords");
+    stereo_attrib_eye_ = glGetAttribLocation(stereo_program_, "a_Eye");
+    stereo_uniform_position_scale_ =
+        glGetUniformLocation(stereo_program_, "u_PositionScale");
+    stereo_uniform_left_uv_rect_ =
+        glGetUniformLocation(stereo_program_, "u_LeftUvRect");
+    stereo_uniform_right_uv_rect_ =
+        glGetUniformLocation(stereo_program_, "u_RightUvRect");
+    stereo_uniform_reprojection_[kLeft] =
+        glGetUniformLocation(stereo_program_, "u_LeftReprojection");
+    stereo_uniform_reprojection_[kRight] =
+        glGetUniformLocation(stereo_program_, "u_RightReprojection");
+
+    // The eye textures are bound to the first two texture units. Sampler
+    // uniforms are part of the program, so they are set once.
+    GLint current_program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+    glUseProgram(stereo_program_);
+    glUniform1i(glGetUniformLocation(stereo_program_, "u_LeftTexture"), 0);
+    glUniform1i(glGetUniformLocation(stereo_program_, "u_RightTexture"), 1);
+    glUseProgram(static_cast<GLuint>(current_program));
+
+    vignette_program_ =
+        CreateProgram(kVignetteVertexShader, kVignetteFragmentShader);
+    vignette_attrib_pos_ = glGetAttribLocation(vignette_program_, "a_Position");
+    vignette_attrib_eye_ = glGetAttribLocation(vignette_program_, "a_Eye");
+    vignette_uniform_position_scale_ =
+        glGetUniformLocation(vignette_program_, "u_PositionScale");
+
+    // Gen buffers and vertex arrays, one per eye, one for both eyes and one
+    // for the vignette.
     glGenBuffers(2, &vertices_vbo_[0]);
     glGenBuffers(2, &uvs_vbo_[0]);
     glGenBuffers(2, &elements_vbo_[0]);
+    glGenVertexArrays(2, &vertex_arrays_[0]);
+    glGenBuffers(1, &stereo_vertices_vbo_);
+    glGenBuffers(1, &stereo_elements_vbo_);
+    glGenVertexArrays(1, &stereo_vertex_array_);
+    glGenBuffers(1, &vignette_vertices_vbo_);
+    glGenBuffers(1, &vignette_elements_vbo_);
+    glGenVertexArrays(1, &vignette_vertex_array_);
     CheckGlError("OpenGlEs3DistortionRendererSetUp");
   }
 
   ~OpenGlEs3DistortionRenderer() {
+    glDeleteVertexArrays(2, &vertex_arrays_[0]);
+    glDeleteVertexArrays(1, &stereo_vertex_array_);
+    glDeleteVertexArrays(1, &vignette_vertex_array_);
     glDeleteBuffers(2, &vertices_vbo_[0]);
     glDeleteBuffers(2, &uvs_vbo_[0]);
     glDeleteBuffers(2, &elements_vbo_[0]);
+    glDeleteBuffers(1, &stereo_vertices_vbo_);
+    glDeleteBuffers(1, &stereo_elements_vbo_);
+    glDeleteBuffers(1, &vignette_vertices_vbo_);
+    glDeleteBuffers(1, &vignette_elements_vbo_);
     CheckGlError("~OpenGlEs3DistortionRenderer");
   }
 
   /*
    * Modifies the OpenGL global state. In particular:
    *   - glGet(GL_ARRAY_BUFFER_BINDING)
-   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+   *   - glGet(GL_VERTEX_ARRAY_BINDING)
    */
   void SetMesh(const CardboardMesh* mesh, CardboardEye eye) override {
+    // The element array buffer binding is part of the vertex array, so it is
+    // bound first.
+    glBindVertexArray(vertex_arrays_[eye]);
     glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_[eye]);
     glBufferData(
         GL_ARRAY_BUFFER,
         mesh->n_vertices * sizeof(float) * 2,  // Two components per vertex
         mesh->vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(
+        attrib_pos_,
+        2,  // 2 components per vertex
+        GL_FLOAT, false,
+        0,  // Stride and offset 0, as we are using different vbos.
+        0);
+    glEnableVertexAttribArray(attrib_pos_);
     glBindBuffer(GL_ARRAY_BUFFER, uvs_vbo_[eye]);
     glBufferData(GL_ARRAY_BUFFER,
                  mesh->n_vertices * sizeof(float) * 2,  // Two components per uv
                  mesh->uvs, GL_STATIC_DRAW);
+    glVertexAttribPointer(attrib_tex_,
+                          2,  // 2 components per uv
+                          GL_FLOAT, false, 0, 0);
+    glEnableVertexAttribArray(attrib_tex_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_[eye]);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->n_indices * sizeof(int),
                  mesh->indices, GL_STATIC_DRAW);
+    elements_count_[eye] = mesh->n_indices;
+    elements_type_[eye] = GL_UNSIGNED_INT;
+    position_scale_[eye] = 1.0f;
+    is_compact_[eye] = false;
+
+    // Single pass rendering and the vignette need compact meshes.
+    stereo_elements_count_ = 0;
+    vignette_elements_count_ = 0;
+
+    glBindVertexArray(0);
+    bound_vertex_array_ = 0;
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     CheckGlError("OpenGlEs3DistortionRenderer::SetMesh");
+  }
+
+  /*
+   * Modifies the OpenGL global state. In particular:
+   *   - glGet(GL_ARRAY_BUFFER_BINDING)
+   *   - glGet(GL_VERTEX_ARRAY_BINDING)
+   */
+  void SetCompactMesh(const CardboardCompactMesh* mesh,
+                      CardboardEye eye) override {
+    // The element array buffer binding is part of the vertex array, so it is
+    // bound first.
+    glBindVertexArray(vertex_arrays_[eye]);
+    glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_[eye]);
+    glBufferData(GL_ARRAY_BUFFER,
+                 mesh->n_vertices * sizeof(int16_t) *
+                     4,  // Four interleaved components per vertex
+                 mesh->vertices, GL_STATIC_DRAW);
+    // Positions and uvs are interleaved normalized shorts.
+    glVertexAttribPointer(attrib_pos_,
+                          2,  // 2 components per vertex
+                          GL_SHORT, true, kVertexStride, 0);
+    glEnableVertexAttribArray(attrib_pos_);
+    glVertexAttribPointer(attrib_tex_,
+                          2,  // 2 components per uv
+                          GL_SHORT, true, kVertexStride,
+                          reinterpret_cast<const void*>(kUvOffset));
+    glEnableVertexAttribArray(attrib_tex_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_[eye]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->n_indices * sizeof(uint16_t),
+                 mesh->indices, GL_STATIC_DRAW);
     elements_count_[eye] = mesh->n_indices;
+    elements_type_[eye] = GL_UNSIGNED_SHORT;
+    position_scale_[eye] = mesh->position_scale;
+    is_compact_[eye] = true;
+
+    // Both eyes are packed together when they can be drawn in one pass.
+    stereo_mesh_.SetEyeMesh(eye, *mesh);
+    stereo_elements_count_ = 0;
+    stereo_uniforms_valid_ = false;
+    if (is_compact_[kLeft] && is_compact_[kRight] &&
+        stereo_mesh_.CanDrawInOnePass()) {
+      const std::vector<int16_t>& vertices = stereo_mesh_.GetVertices();
+      const std::vector<uint16_t>& indices = stereo_mesh_.GetIndices();
+      glBindVertexArray(stereo_vertex_array_);
+      glBindBuffer(GL_ARRAY_BUFFER, stereo_vertices_vbo_);
+      glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(int16_t),
+                   vertices.data(), GL_STATIC_DRAW);
+      // Positions, uvs and eyes are interleaved normalized shorts.
+      glVertexAttribPointer(stereo_attrib_pos_,
+                            2,  // 2 components per vertex
+                            GL_SHORT, true, kStereoVertexStride, 0);
+      glEnableVertexAttribArray(stereo_attrib_pos_);
+      glVertexAttribPointer(stereo_attrib_tex_,
+                            2,  // 2 components per uv
+                            GL_SHORT, true, kStereoVertexStride,
+                            reinterpret_cast<const void*>(kUvOffset));
+      glEnableVertexAttribArray(stereo_attrib_tex_);
+      glVertexAttribPointer(
+          stereo_attrib_eye_, 1, GL_SHORT, true, kStereoVertexStride,
+          reinterpret_cast<const void*>(StereoMesh::kEyeOffset));
+      glEnableVertexAttribArray(stereo_attrib_eye_);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stereo_elements_vbo_);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+                   indices.data(), GL_STATIC_DRAW);
+      stereo_elements_count_ = static_cast<int>(indices.size());
+    }
+
+    // The vignette can replace the color clear when it covers what the meshes
+    // do not. Its positions are computed like the ones of the single pass, so
+    // it is only drawn with it.
+    vignette_mesh_.SetEyeMesh(eye, *mesh);
+    vignette_elements_count_ = 0;
+    vignette_uniforms_valid_ = false;
+    if (stereo_elements_count_ > 0 && vignette_mesh_.IsValid()) {
+      const std::vector<int16_t>& vertices = vignette_mesh_.GetVertices();
+      const std::vector<uint16_t>& indices = vignette_mesh_.GetIndices();
+      glBindVertexArray(vignette_vertex_array_);
+      glBindBuffer(GL_ARRAY_BUFFER, vignette_vertices_vbo_);
+      glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(int16_t),
+                   vertices.data(), GL_STATIC_DRAW);
+      // Positions and eyes are interleaved normalized shorts.
+      glVertexAttribPointer(vignette_attrib_pos_,
+                            2,  // 2 components per vertex
+                            GL_SHORT, true, kVignetteVertexStride, 0);
+      glEnableVertexAttribArray(vignette_attrib_pos_);
+      glVertexAttribPointer(
+          vignette_attrib_eye_, 1, GL_SHORT, true, kVignetteVertexStride,
+          reinterpret_cast<const void*>(VignetteMesh::kEyeOffset));
+      glEnableVertexAttribArray(vignette_attrib_eye_);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vignette_elements_vbo_);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+                   indices.data(), GL_STATIC_DRAW);
+      vignette_elements_count_ = static_cast<int>(indices.size());
+    }
+
+    glBindVertexArray(0);
+    bound_vertex_array_ = 0;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CheckGlError("OpenGlEs3DistortionRenderer::SetCompactMesh");
   }
 
   /*
@@ -251,8 +558,21 @@ class OpenGlEs3DistortionRenderer : public DistortionRenderer {
    *   - glGet(GL_CURRENT_PROGRAM)
    *   - glGet(GL_SCISSOR_BOX)
    *   - glGet(GL_ACTIVE_TEXTURE+i)
-   *   - glGet(GL_ARRAY_BUFFER_BINDING)
-   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+   *   - glGet(GL_VERTEX_ARRAY_BINDING)
+   *
+   * When both eye meshes are compact and lie on their own half of the
+   * viewport, both eyes are drawn with a single call and no scissor.
+   * Otherwise, each eye is drawn with its own scissor.
+   *
+   * When the vignette fill is enabled, both eyes are drawn with a single call
+   * and the vignette mesh covers the part of the viewport that they do not,
+   * the color buffer is invalidated in the viewport, the vignette is drawn in
+   * black and only the depth buffer is cleared. Otherwise, the color buffer
+   * is cleared too.
+   *
+   * When the caller guarantees the state, the state set by a previous call is
+   * not set again and it is not restored at the end of the call, so the
+   * active texture unit and the vertex array binding are left as used.
    */
   void RenderEyeToDisplay(
       uint64_t target, int x, int y, int width, int height,
@@ -264,94 +584,271 @@ class OpenGlEs3DistortionRenderer : public DistortionRenderer {
           "not called yet.");
       return;
     }
+    gl_call_count_ = 0;
+
+    SetViewport(x, y, width, height);
+    BindFramebuffer(static_cast<GLuint>(target));
+    if (!caller_guarantees_state_ || !fixed_state_set_) {
+      CALL_GL(glDisable(GL_SCISSOR_TEST));
+      CALL_GL(glDisable(GL_CULL_FACE));
+      CALL_GL(glClearColor(.0f, .0f, .0f, 1.0f));
+      fixed_state_set_ = true;
+    }
+    if (IsVignetteFillEnabled() && vignette_elements_count_ > 0) {
+      // Tile-based GPUs then do not load the previous color of the viewport.
+      const GLenum attachment = target == 0 ? GL_COLOR : GL_COLOR_ATTACHMENT0;
+      CALL_GL(glInvalidateSubFramebuffer(GL_FRAMEBUFFER, 1, &attachment, x, y,
+                                         width, height));
+      CALL_GL(glClear(GL_DEPTH_BUFFER_BIT));
+      UseProgram(vignette_program_);
+      if (!vignette_uniforms_valid_) {
+        CALL_GL(glUniform2f(vignette_uniform_position_scale_,
+                            vignette_mesh_.GetPositionScale(kLeft),
+                            vignette_mesh_.GetPositionScale(kRight)));
+        vignette_uniforms_valid_ = true;
+      }
+      BindVertexArray(vignette_vertex_array_);
+      CALL_GL(glDrawElements(GL_TRIANGLES, vignette_elements_count_,
+                             GL_UNSIGNED_SHORT, 0));
+    } else {
+      CALL_GL(glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT));
+    }
 
-    glViewport(x, y, width, height);
-    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(target));
-    glDisable(GL_SCISSOR_TEST);
-    glDisable(GL_CULL_FACE);
-    glClearColor(.0f, .0f, .0f, 1.0f);
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    if (stereo_elements_count_ > 0) {
+      UseProgram(stereo_program_);
+      RenderStereoDistortionMesh(left_eye, right_eye);
+    } else {
+      UseProgram(program_);
 
-    glUseProgram(program_);
+      CALL_GL(glEnable(GL_SCISSOR_TEST));
+      CALL_GL(glScissor(x, y, width / 2, height));
+      RenderDistortionMesh(left_eye, kLeft);
 
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(x, y, width / 2, height);
-    RenderDistortionMesh(left_eye, kLeft);
+      CALL_GL(glScissor(x + width / 2, y, width / 2, height));
+      RenderDistortionMesh(right_eye, kRight);
 
-    glScissor(x + width / 2, y, width / 2, height);
-    RenderDistortionMesh(right_eye, kRight);
+      // Disable scissor test.
+      CALL_GL(glDisable(GL_SCISSOR_TEST));
+    }
 
-    // Active GL_TEXTURE0 effectively enables the first texture that is
-    // deactiviated by the DistortionRenderer. Binding array buffer and element
-    // array buffer to the reserved value zero effectively unbinds the buffer
-    // objects that are previously bound by the DistortionRenderer.
-    glActiveTexture(GL_TEXTURE0);
+    if (!caller_guarantees_state_) {
+      // Active GL_TEXTURE0 effectively enables the first texture that is
+      // deactiviated by the DistortionRenderer. Binding the vertex array to
+      // the reserved value zero effectively unbinds the vertex array object
+      // that is previously bound by the DistortionRenderer.
+      CALL_GL(glActiveTexture(GL_TEXTURE0));
+      CALL_GL(glBindVertexArray(0));
+    }
+    CALL_GL(CheckGlError("OpenGlEs3DistortionRenderer::RenderEyeToDisplay"));
+  }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // Returns the number of OpenGL ES calls issued by the last call to
+  // RenderEyeToDisplay().
+  int GetGlCallCount() const { return gl_call_count_; }
 
-    // Disable scissor test.
-    glDisable(GL_SCISSOR_TEST);
-    CheckGlError("OpenGlEs3DistortionRenderer::RenderEyeToDisplay");
+ private:
+  /*
+   * Modifies the OpenGL global state. In particular:
+   *   - glGet(GL_VERTEX_ARRAY_BINDING)
+   *   - glGet(GL_ACTIVE_TEXTURE+i)
+   *   - glGet(GL_TEXTURE_BINDING_2D) of texture units 0 and 1
+   *   - glGetUniform(program, location)
+   */
+  void RenderStereoDistortionMesh(
+      const CardboardEyeTextureDescription* left_eye,
+      const CardboardEyeTextureDescription* right_eye) {
+    BindEyeTexture(0, static_cast<GLuint>(left_eye->texture));
+    BindEyeTexture(1, static_cast<GLuint>(right_eye->texture));
+
+    // Uniforms are part of the program, which is only used by this renderer,
+    // so they are only set when their values change.
+    const std::array<float, 4> left_uv_rect{
+        left_eye->left_u, left_eye->bottom_v, left_eye->right_u,
+        left_eye->top_v};
+    const std::array<float, 4> right_uv_rect{
+        right_eye->left_u, right_eye->bottom_v, right_eye->right_u,
+        right_eye->top_v};
+    if (!stereo_uniforms_valid_) {
+      CALL_GL(glUniform2f(stereo_uniform_position_scale_,
+                          stereo_mesh_.GetPositionScale(kLeft),
+                          stereo_mesh_.GetPositionScale(kRight)));
+    }
+    if (!stereo_uniforms_valid_ || left_uv_rect != stereo_uv_rects_[kLeft]) {
+      CALL_GL(glUniform4fv(stereo_uniform_left_uv_rect_, 1,
+                           left_uv_rect.data()));
+      stereo_uv_rects_[kLeft] = left_uv_rect;
+    }
+    if (!stereo_uniforms_valid_ || right_uv_rect != stereo_uv_rects_[kRight]) {
+      CALL_GL(glUniform4fv(stereo_uniform_right_uv_rect_, 1,
+                           right_uv_rect.data()));
+      stereo_uv_rects_[kRight] = right_uv_rect;
+    }
+    for (CardboardEye eye : {kLeft, kRight}) {
+      const std::array<float, 9>& reprojection = GetReprojectionMatrix(eye);
+      if (!stereo_uniforms_valid_ ||
+          reprojection != stereo_reprojections_[eye]) {
+        CALL_GL(glUniformMatrix3fv(stereo_uniform_reprojection_[eye], 1,
+                                   GL_FALSE, reprojection.data()));
+        stereo_reprojections_[eye] = reprojection;
+      }
+    }
+    stereo_uniforms_valid_ = true;
+
+    BindVertexArray(stereo_vertex_array_);
+    CALL_GL(glDrawElements(GL_TRIANGLE_STRIP, stereo_elements_count_,
+                           GL_UNSIGNED_SHORT, 0));
   }
 
- private:
   /*
    * Modifies the OpenGL global state. In particular:
-   *   - glGet(GL_ARRAY_BUFFER_BINDING)
-   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
-   *   - glGetVertexAttrib(i, GL_VERTEX_ATTRIB_*)
-   *   - glGetVertextAttrib(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED)
+   *   - glGet(GL_VERTEX_ARRAY_BINDING)
    *   - glGet(GL_ACTIVE_TEXTURE+i)
    *   - glGet(GL_TEXTURE_BINDING_2D)
    *   - glGetUniform(program, location)
-   *   - glGet(GL_ARRAY_BUFFER_BINDING)
-   *   - glGet(GL_ELEMENT_ARRAY_BUFFER_BINDING)
    */
   void RenderDistortionMesh(
       const CardboardEyeTextureDescription* eye_description,
-      CardboardEye eye) const {
-    glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_[eye]);
-    glVertexAttribPointer(
-        attrib_pos_,
-        2,  // 2 components per vertex
-        GL_FLOAT, false,
-        0,  // Stride and offset 0, as we are using different vbos.
-        0);
-    glEnableVertexAttribArray(attrib_pos_);
+      CardboardEye eye) {
+    BindEyeTexture(0, static_cast<GLuint>(eye_description->texture));
 
-    glBindBuffer(GL_ARRAY_BUFFER, uvs_vbo_[eye]);
-    glVertexAttribPointer(attrib_tex_,
-                          2,  // 2 components per uv
-                          GL_FLOAT, false, 0, 0);
-    glEnableVertexAttribArray(attrib_tex_);
+    CALL_GL(glUniform2f(uniform_start_, eye_description->left_u,
+                        eye_description->bottom_v));
+    CALL_GL(glUniform2f(uniform_end_, eye_description->right_u,
+                        eye_description->top_v));
+    CALL_GL(glUniform1f(uniform_position_scale_, position_scale_[eye]));
+    CALL_GL(glUniformMatrix3fv(uniform_reprojection_, 1, GL_FALSE,
+                               GetReprojectionMatrix(eye).data()));
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(eye_texture_type_,
-                  static_cast<GLuint>(eye_description->texture));
+    // Draw with indices
+    BindVertexArray(vertex_arrays_[eye]);
+    CALL_GL(glDrawElements(GL_TRIANGLE_STRIP, elements_count_[eye],
+                           elements_type_[eye], 0));
+  }
 
-    glUniform2f(uniform_start_, eye_description->left_u,
-                eye_description->bottom_v);
-    glUniform2f(uniform_end_, eye_description->right_u, eye_description->top_v);
+  // The following functions set a piece of state. When the caller guarantees
+  // the state, they skip the call if the value is the one they set last.
+  void SetViewport(int x, int y, int width, int height) {
+    const std::array<GLint, 4> viewport{x, y, width, height};
+    if (caller_guarantees_state_ && viewport == viewport_) {
+      return;
+    }
+    CALL_GL(glViewport(x, y, width, height));
+    viewport_ = viewport;
+  }
 
-    // Draw with indices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_[eye]);
-    glDrawElements(GL_TRIANGLE_STRIP, elements_count_[eye], GL_UNSIGNED_INT, 0);
-    CheckGlError("OpenGlEs3DistortionRenderer::RenderDistortionMesh");
+  void BindFramebuffer(GLuint framebuffer) {
+    if (caller_guarantees_state_ && framebuffer == bound_framebuffer_) {
+      return;
+    }
+    CALL_GL(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    bound_framebuffer_ = framebuffer;
   }
 
+  void UseProgram(GLuint program) {
+    if (caller_guarantees_state_ && program == current_program_) {
+      return;
+    }
+    CALL_GL(glUseProgram(program));
+    current_program_ = program;
+  }
+
+  void BindVertexArray(GLuint vertex_array) {
+    if (caller_guarantees_state_ && vertex_array == bound_vertex_array_) {
+      return;
+    }
+    CALL_GL(glBindVertexArray(vertex_array));
+    bound_vertex_array_ = vertex_array;
+  }
+
+  void BindEyeTexture(int unit, GLuint texture) {
+    if (caller_guarantees_state_ && texture == bound_textures_[unit]) {
+      return;
+    }
+    if (!caller_guarantees_state_ || unit != active_texture_unit_) {
+      CALL_GL(glActiveTexture(GL_TEXTURE0 + unit));
+      active_texture_unit_ = unit;
+    }
+    CALL_GL(glBindTexture(eye_texture_type_, texture));
+    bound_textures_[unit] = texture;
+  }
+
+  // Vertex layout of CardboardCompactMesh.
+  static constexpr GLsizei kVertexStride = 4 * sizeof(int16_t);
+  static constexpr intptr_t kUvOffset = 2 * sizeof(int16_t);
+  // Vertex layout of StereoMesh.
+  static constexpr GLsizei kStereoVertexStride =
+      StereoMesh::kComponentsPerVertex * sizeof(int16_t);
+  // Vertex layout of VignetteMesh.
+  static constexpr GLsizei kVignetteVertexStride =
+      VignetteMesh::kComponentsPerVertex * sizeof(int16_t);
+  // Object name that is never generated, used before an object is bound.
+  static constexpr GLuint kUnknownObject = 0xFFFFFFFF;
+
   std::array<GLuint, 2> vertices_vbo_;  // One per eye.
-  std::array<GLuint, 2> uvs_vbo_;
+  std::array<GLuint, 2> uvs_vbo_;       // Unused by compact meshes.
   std::array<GLuint, 2> elements_vbo_;
   std::array<int, 2> elements_count_;
+  std::array<GLenum, 2> elements_type_;
+  std::array<float, 2> position_scale_;
+  // Whether the mesh of each eye was set with SetCompactMesh().
+  std::array<bool, 2> is_compact_;
+  std::array<GLuint, 2> vertex_arrays_;
 
   GLuint program_;
   GLuint attrib_pos_;
   GLuint attrib_tex_;
   GLuint uniform_start_;
   GLuint uniform_end_;
+  GLuint uniform_position_scale_;
+  GLuint uniform_reprojection_;
+
+  // Single pass rendering of both eyes.
+  StereoMesh stereo_mesh_;
+  GLuint stereo_vertices_vbo_;
+  GLuint stereo_elements_vbo_;
+  int stereo_elements_count_;  // 0 when the eyes are drawn one by one.
+  GLuint stereo_vertex_array_;
+  GLuint stereo_program_;
+  GLuint stereo_attrib_pos_;
+  GLuint stereo_attrib_tex_;
+  GLuint stereo_attrib_eye_;
+  GLuint stereo_uniform_position_scale_;
+  GLuint stereo_uniform_left_uv_rect_;
+  GLuint stereo_uniform_right_uv_rect_;
+  std::array<GLuint, 2> stereo_uniform_reprojection_;
+  // Values of the stereo program uniforms, valid once they are set.
+  bool stereo_uniforms_valid_;
+  std::array<std::array<float, 4>, 2> stereo_uv_rects_;
+  std::array<std::array<float, 9>, 2> stereo_reprojections_;
+
+  // Fill of the part of the viewport the meshes do not cover.
+  VignetteMesh vignette_mesh_;
+  GLuint vignette_vertices_vbo_;
+  GLuint vignette_elements_vbo_;
+  int vignette_elements_count_;  // 0 when the color buffer is cleared.
+  GLuint vignette_vertex_array_;
+  GLuint vignette_program_;
+  GLuint vignette_attrib_pos_;
+  GLuint vignette_attrib_eye_;
+  GLuint vignette_uniform_position_scale_;
+  // Whether the vignette program uniform is set.
+  bool vignette_uniforms_valid_;
 
   GLenum eye_texture_type_;
+
+  // State left by the previous call to RenderEyeToDisplay(). It is only used
+  // when the caller guarantees that it is not modified between calls.
+  bool caller_guarantees_state_;
+  bool fixed_state_set_;  // Scissor test, face culling and clear color.
+  std::array<GLint, 4> viewport_;
+  GLuint bound_framebuffer_;
+  GLuint current_program_;
+  GLuint bound_vertex_array_;
+  int active_texture_unit_;
+  std::array<GLuint, 2> bound_textures_;
+
+  // OpenGL ES calls issued by the last call to RenderEyeToDisplay().
+  int gl_call_count_;
 };
 
 }  // namespace cardboard::rendering
@@ -367,4 +864,14 @@ CardboardDistortionRenderer* CardboardOpenGlEs3DistortionRenderer_create(
       new cardboard::rendering::OpenGlEs3DistortionRenderer(config));
 }
 
+int CardboardOpenGlEs3DistortionRenderer_getGlCallCount(
+    const CardboardDistortionRenderer* renderer) {
+  if (CARDBOARD_IS_NOT_INITIALIZED() || CARDBOARD_IS_ARG_NULL(renderer)) {
+    return 0;
+  }
+  return reinterpret_cast<
+             const cardboard::rendering::OpenGlEs3DistortionRenderer*>(renderer)
+      ->GetGlCallCount();
+}
+
 }  // extern "C"
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "rendering/testing/fake_gl.h"
+
+#include <GLES3/gl3.h>
+
+#include <map>
+#include <string>
+
+namespace cardboard::rendering::testing {
+namespace {
+
+std::map<std::string, int>& CallCounts() {
+  static std::map<std::string, int> call_counts;
+  return call_counts;
+}
+
+std::map<GLenum, int>& DrawCounts() {
+  static std::map<GLenum, int> draw_counts;
+  return draw_counts;
+}
+
+GLuint GenerateName() {
+  static GLuint next_name = 1;
+  return next_name++;
+}
+
+void GenerateNames(GLsizei n, GLuint* names) {
+  for (GLsizei i = 0; i < n; ++i) {
+    names[i] = GenerateName();
+  }
+}
+
+}  // namespace
+
+void ResetGlCallCounts() {
+  CallCounts().clear();
+  DrawCounts().clear();
+}
+
+int GetGlCallCount(const char* function_name) {
+  const auto it = CallCounts().find(function_name);
+  return it == CallCounts().end() ? 0 : it->second;
+}
+
+int GetGlDrawCount(unsigned int mode) {
+  const auto it = DrawCounts().find(mode);
+  return it == DrawCounts().end() ? 0 : it->second;
+}
+
+}  // namespace cardboard::rendering::testing
+
+#define COUNT_GL_CALL() \
+  ++cardboard::rendering::testing::CallCounts()[__func__]
+
+extern "C" {
+
+void glActiveTexture(GLenum) { COUNT_GL_CALL(); }
+void glAttachShader(GLuint, GLuint) { COUNT_GL_CALL(); }
+void glBindBuffer(GLenum, GLuint) { COUNT_GL_CALL(); }
+void glBindFramebuffer(GLenum, GLuint) { COUNT_GL_CALL(); }
+void glBindTexture(GLenum, GLuint) { COUNT_GL_CALL(); }
+void glBindVertexArray(GLuint) { COUNT_GL_CALL(); }
+void glBufferData(GLenum, GLsizeiptr, const void*, GLenum) {
+  COUNT_GL_CALL();
+}
+void glClear(GLbitfield) { COUNT_GL_CALL(); }
+void glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) { COUNT_GL_CALL(); }
+void glCompileShader(GLuint) { COUNT_GL_CALL(); }
+GLuint glCreateProgram() {
+  COUNT_GL_CALL();
+  return cardboard::rendering::testing::GenerateName();
+}
+GLuint glCreateShader(GLenum) {
+  COUNT_GL_CALL();
+  return cardboard::rendering::testing::GenerateName();
+}
+void glDeleteBuffers(GLsizei, const GLuint*) { COUNT_GL_CALL(); }
+void glDeleteProgram(GLuint) { COUNT_GL_CALL(); }
+void glDeleteShader(GLuint) { COUNT_GL_CALL(); }
+void glDeleteVertexArrays(GLsizei, const GLuint*) { COUNT_GL_CALL(); }
+void glDetachShader(GLuint, GLuint) { COUNT_GL_CALL(); }
+void glDisable(GLenum) { COUNT_GL_CALL(); }
+void glDisableVertexAttribArray(GLuint) { COUNT_GL_CALL(); }
+void glDiscardFramebufferEXT(GLenum, GLsizei, const GLenum*) {
+  COUNT_GL_CALL();
+}
+void glDrawElements(GLenum mode, GLsizei, GLenum, const void*) {
+  COUNT_GL_CALL();
+  ++cardboard::rendering::testing::DrawCounts()[mode];
+}
+void glEnable(GLenum) { COUNT_GL_CALL(); }
+void glEnableVertexAttribArray(GLuint) { COUNT_GL_CALL(); }
+void glGenBuffers(GLsizei n, GLuint* buffers) {
+  COUNT_GL_CALL();
+  cardboard::rendering::testing::GenerateNames(n, buffers);
+}
+void glGenVertexArrays(GLsizei n, GLuint* arrays) {
+  COUNT_GL_CALL();
+  cardboard::rendering::testing::GenerateNames(n, arrays);
+}
+GLint glGetAttribLocation(GLuint, const GLchar*) {
+  COUNT_GL_CALL();
+  return 0;
+}
+// Not counted, since the renderers only call it to log errors.
+GLenum glGetError() { return GL_NO_ERROR; }
+void glGetIntegerv(GLenum, GLint* data) {
+  COUNT_GL_CALL();
+  *data = 0;
+}
+void glGetProgramInfoLog(GLuint, GLsizei, GLsizei*, GLchar*) {
+  COUNT_GL_CALL();
+}
+void glGetProgramiv(GLuint, GLenum, GLint* params) {
+  COUNT_GL_CALL();
+  *params = GL_TRUE;
+}
+void glGetShaderInfoLog(GLuint, GLsizei, GLsizei*, GLchar*) {
+  COUNT_GL_CALL();
+}
+void glGetShaderiv(GLuint, GLenum, GLint* params) {
+  COUNT_GL_CALL();
+  *params = GL_TRUE;
+}
+const GLubyte* glGetString(GLenum name) {
+  COUNT_GL_CALL();
+  return reinterpret_cast<const GLubyte*>(
+      name == GL_EXTENSIONS ? "GL_EXT_discard_framebuffer" : "");
+}
+GLint glGetUniformLocation(GLuint, const GLchar*) {
+  COUNT_GL_CALL();
+  return 0;
+}
+void glInvalidateSubFramebuffer(GLenum, GLsizei, const GLenum*, GLint, GLint,
+                                GLsizei, GLsizei) {
+  COUNT_GL_CALL();
+}
+void glLinkProgram(GLuint) { COUNT_GL_CALL(); }
+void glScissor(GLint, GLint, GLsizei, GLsizei) { COUNT_GL_CALL(); }
+void glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {
+  COUNT_GL_CALL();
+}
+void glUniform1f(GLint, GLfloat) { COUNT_GL_CALL(); }
+void glUniform1i(GLint, GLint) { COUNT_GL_CALL(); }
+void glUniform2f(GLint, GLfloat, GLfloat) { COUNT_GL_CALL(); }
+void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) {
+  COUNT_GL_CALL();
+}
+void glUniform4fv(GLint, GLsizei, const GLfloat*) { COUNT_GL_CALL(); }
+void glUniformMatrix3fv(GLint, GLsizei, GLboolean, const GLfloat*) {
+  COUNT_GL_CALL();
+}
+void glUseProgram(GLuint) { COUNT_GL_CALL(); }
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei,
+                           const void*) {
+  COUNT_GL_CALL();
+}
+void glViewport(GLint, GLint, GLsizei, GLsizei) { COUNT_GL_CALL(); }
+
+}  // extern "C"
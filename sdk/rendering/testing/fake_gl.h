@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_RENDERING_TESTING_FAKE_GL_H_
+#define CARDBOARD_SDK_RENDERING_TESTING_FAKE_GL_H_
+
+namespace cardboard::rendering::testing {
+
+// Fake OpenGL ES implementation for the renderer tests. Its functions do
+// nothing but count their calls; object names are increasing integers and
+// shaders and programs always compile and link. The only extension is
+// GL_EXT_discard_framebuffer.
+
+// Resets the call counts.
+void ResetGlCallCounts();
+
+// Returns the number of calls to the OpenGL ES function @p function_name since
+// the last ResetGlCallCounts().
+int GetGlCallCount(const char* function_name);
+
+// Returns the number of glDrawElements() calls with primitive @p mode since
+// the last ResetGlCallCounts().
+int GetGlDrawCount(unsigned int mode);
+
+}  // namespace cardboard::rendering::testing
+
+#endif  // CARDBOARD_SDK_RENDERING_TESTING_FAKE_GL_H_
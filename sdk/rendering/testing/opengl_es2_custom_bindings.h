@@ -0,0 +1,25 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_RENDERING_TESTING_OPENGL_ES2_CUSTOM_BINDINGS_H_
+#define CARDBOARD_SDK_RENDERING_TESTING_OPENGL_ES2_CUSTOM_BINDINGS_H_
+
+// OpenGL ES 2 bindings of the renderer tests. The functions are defined by
+// fake_gl.cc.
+#include <GLES2/gl2.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GLES2/gl2ext.h>
+
+#endif  // CARDBOARD_SDK_RENDERING_TESTING_OPENGL_ES2_CUSTOM_BINDINGS_H_
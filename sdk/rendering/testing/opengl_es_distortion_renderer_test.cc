@@ -0,0 +1,174 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// Checks the number of draw calls that the OpenGL ES distortion renderers
+// issue per frame, against the fake OpenGL ES implementation of fake_gl.cc.
+// Returns nonzero when a check fails.
+#include <cstdio>
+#include <vector>
+
+#include "compact_mesh.h"
+#include "distortion_renderer.h"
+#include "include/cardboard.h"
+#include "lens_distortion.h"
+#include "qrcode/cardboard_v1/cardboard_v1.h"
+#include "rendering/testing/fake_gl.h"
+#include "util/is_initialized.h"
+
+namespace cardboard::rendering {
+namespace {
+
+constexpr int kDisplayWidth = 2400;
+constexpr int kDisplayHeight = 1080;
+// GL_TRIANGLES and GL_TRIANGLE_STRIP, the primitives of the vignette and of
+// the distortion meshes.
+constexpr unsigned int kTriangles = 0x0004;
+constexpr unsigned int kTriangleStrip = 0x0005;
+
+using RendererFactory = CardboardDistortionRenderer* (*)(
+    const CardboardOpenGlEsDistortionRendererConfig*);
+
+int failures = 0;
+
+void ExpectEq(int expected, int actual, const char* what, const char* name) {
+  if (expected != actual) {
+    std::fprintf(stderr, "FAILED %s: %s is %d, expected %d\n", name, what,
+                 actual, expected);
+    ++failures;
+  }
+}
+
+// Creates a renderer with the Cardboard v1 distortion meshes. The meshes are
+// moved by @p shift towards the center of the display, so that they overlap
+// the other half when it is nonzero. The meshes are set with SetCompactMesh()
+// when @p compact is true and with SetMesh() otherwise.
+DistortionRenderer* CreateRenderer(RendererFactory create,
+                                   int caller_guarantees_state, float shift,
+                                   bool compact) {
+  const std::vector<uint8_t> device_params =
+      qrcode::getCardboardV1DeviceParams();
+  const LensDistortion lens_distortion(
+      device_params.data(), static_cast<int>(device_params.size()),
+      kDisplayWidth, kDisplayHeight);
+  const CardboardOpenGlEsDistortionRendererConfig config{
+      kGlTexture2D, caller_guarantees_state};
+  DistortionRenderer* renderer =
+      reinterpret_cast<DistortionRenderer*>(create(&config));
+
+  for (CardboardEye eye : {kLeft, kRight}) {
+    CardboardMesh mesh = lens_distortion.GetDistortionMesh(eye);
+    std::vector<float> vertices(mesh.vertices,
+                                mesh.vertices + 2 * mesh.n_vertices);
+    for (size_t i = 0; i < vertices.size(); i += 2) {
+      vertices[i] += eye == kLeft ? shift : -shift;
+    }
+    mesh.vertices = vertices.data();
+    if (compact) {
+      const CompactMesh compact_mesh(mesh);
+      const CardboardCompactMesh compact_mesh_view = compact_mesh.GetMesh();
+      renderer->SetCompactMesh(&compact_mesh_view, eye);
+    } else {
+      renderer->SetMesh(&mesh, eye);
+    }
+  }
+  return renderer;
+}
+
+// Renders a frame and resets the call counts before it.
+void RenderFrame(DistortionRenderer* renderer) {
+  const CardboardEyeTextureDescription left_eye{1, 0, 1, 0, 1};
+  const CardboardEyeTextureDescription right_eye{2, 0, 1, 0, 1};
+  testing::ResetGlCallCounts();
+  renderer->RenderEyeToDisplay(0, 0, 0, kDisplayWidth, kDisplayHeight,
+                               &left_eye, &right_eye);
+}
+
+// Renders three frames and checks the number of distortion mesh draws of each
+// one. The vignette fill is disabled, so the color buffer is cleared and no
+// vignette is drawn. See CreateRenderer() for the other parameters.
+void CheckDrawCount(const char* name, RendererFactory create,
+                    int caller_guarantees_state, float shift, bool compact,
+                    int expected_draw_count) {
+  DistortionRenderer* renderer =
+      CreateRenderer(create, caller_guarantees_state, shift, compact);
+  for (int frame = 0; frame < 3; ++frame) {
+    RenderFrame(renderer);
+    ExpectEq(expected_draw_count, testing::GetGlDrawCount(kTriangleStrip),
+             "distortion mesh draw count", name);
+    ExpectEq(0, testing::GetGlDrawCount(kTriangles), "vignette draw count",
+             name);
+    ExpectEq(1, testing::GetGlCallCount("glClear"), "glClear count", name);
+  }
+  delete renderer;
+}
+
+// Renders three frames with the vignette fill enabled and checks that each
+// one invalidates the color buffer with @p invalidate_function before it draws
+// the vignette. With @p shift, the meshes overlap the other half and the
+// color buffer is cleared instead.
+void CheckVignetteFill(const char* name, RendererFactory create,
+                       int caller_guarantees_state, float shift,
+                       const char* invalidate_function) {
+  DistortionRenderer* renderer =
+      CreateRenderer(create, caller_guarantees_state, shift, /*compact=*/true);
+  renderer->SetVignetteFill(true);
+  const int expected_vignette_draw_count = shift == 0.0f ? 1 : 0;
+  for (int frame = 0; frame < 3; ++frame) {
+    RenderFrame(renderer);
+    ExpectEq(expected_vignette_draw_count, testing::GetGlDrawCount(kTriangles),
+             "vignette draw count", name);
+    ExpectEq(expected_vignette_draw_count,
+             testing::GetGlCallCount(invalidate_function),
+             invalidate_function, name);
+  }
+  delete renderer;
+}
+
+void CheckRenderer(RendererFactory create, int caller_guarantees_state,
+                   const char* invalidate_function) {
+  // Each mesh lies on its own half of the display: one draw for both eyes.
+  CheckDrawCount("compact meshes", create, caller_guarantees_state, 0.0f,
+                 /*compact=*/true, 1);
+  // The meshes overlap the other half: one scissored draw per eye.
+  CheckDrawCount("overlapping compact meshes", create,
+                 caller_guarantees_state, 0.3f, /*compact=*/true, 2);
+  // Float meshes are drawn one eye at a time.
+  CheckDrawCount("float meshes", create, caller_guarantees_state, 0.0f,
+                 /*compact=*/false, 2);
+
+  CheckVignetteFill("vignette fill", create, caller_guarantees_state, 0.0f,
+                    invalidate_function);
+  CheckVignetteFill("vignette fill of overlapping meshes", create,
+                    caller_guarantees_state, 0.3f, invalidate_function);
+}
+
+}  // namespace
+}  // namespace cardboard::rendering
+
+int main() {
+  cardboard::util::SetIsInitialized();
+  cardboard::rendering::CheckRenderer(
+      CardboardOpenGlEs2DistortionRenderer_create,
+      /*caller_guarantees_state=*/0, "glDiscardFramebufferEXT");
+  for (int caller_guarantees_state : {0, 1}) {
+    cardboard::rendering::CheckRenderer(
+        CardboardOpenGlEs3DistortionRenderer_create, caller_guarantees_state,
+        "glInvalidateSubFramebuffer");
+  }
+  if (cardboard::rendering::failures == 0) {
+    std::printf("PASSED\n");
+  }
+  return cardboard::rendering::failures == 0 ? 0 : 1;
+}
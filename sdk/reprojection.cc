@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "reprojection.h"
+
+#include <cmath>
+
+#include "util/matrix_3x3.h"
+#include "util/matrixutils.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+
+namespace cardboard {
+
+namespace {
+
+Rotationf RotationFromQuaternion(const float quaternion[4]) {
+  return Rotationf::FromQuaternion(
+      Vector4f(quaternion[0], quaternion[1], quaternion[2], quaternion[3]));
+}
+
+}  // namespace
+
+std::array<float, 9> ComputeReprojectionMatrix(
+    const CardboardReprojection& reprojection, CardboardEye eye) {
+  // Head orientations rotate world directions into the head frame, so a
+  // direction in the head frame at display time is moved into the head frame
+  // at render time by this rotation.
+  const Rotationf delta =
+      RotationFromQuaternion(reprojection.render_orientation) *
+      -RotationFromQuaternion(reprojection.display_orientation);
+
+  // Texture coordinates span the tangents of the field of view half angles,
+  // looking down the -z axis:
+  //   x = u * width - tan(left), y = v * height - tan(bottom), z = -1.
+  const float* field_of_view = reprojection.field_of_view[eye];
+  const float tan_left = std::tan(field_of_view[0]);
+  const float tan_bottom = std::tan(field_of_view[2]);
+  const float width = tan_left + std::tan(field_of_view[1]);
+  const float height = tan_bottom + std::tan(field_of_view[3]);
+  const Matrix3x3f uv_to_direction(width, 0.0f, -tan_left, 0.0f, height,
+                                   -tan_bottom, 0.0f, 0.0f, -1.0f);
+  const Matrix3x3f direction_to_uv(1.0f / width, 0.0f, -tan_left / width, 0.0f,
+                                   1.0f / height, -tan_bottom / height, 0.0f,
+                                   0.0f, -1.0f);
+  const Matrix3x3f matrix =
+      direction_to_uv * RotationMatrixNH(delta) * uv_to_direction;
+
+  std::array<float, 9> column_major;
+  for (int column = 0; column < 3; column++) {
+    for (int row = 0; row < 3; row++) {
+      column_major[column * 3 + row] = matrix(row, column);
+    }
+  }
+  return column_major;
+}
+
+void ReprojectTextureCoordinates(const std::array<float, 9>& matrix,
+                                 const float* uvs, int count, float* out_uvs) {
+  for (int i = 0; i < count; i++) {
+    const float u = uvs[2 * i];
+    const float v = uvs[2 * i + 1];
+    const float x = matrix[0] * u + matrix[3] * v + matrix[6];
+    const float y = matrix[1] * u + matrix[4] * v + matrix[7];
+    const float w = matrix[2] * u + matrix[5] * v + matrix[8];
+    out_uvs[2 * i] = x / w;
+    out_uvs[2 * i + 1] = y / w;
+  }
+}
+
+}  // namespace cardboard
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_REPROJECTION_H_
+#define CARDBOARD_SDK_REPROJECTION_H_
+
+#include <array>
+
+#include "include/cardboard.h"
+
+namespace cardboard {
+
+// Rotational reprojection of the eye textures.
+//
+// An eye texture rendered with the head orientation of a
+// CardboardReprojection is reprojected to its display orientation by a
+// homography of its [0, 1] texture coordinates, which the renderers apply to
+// the texture coordinates of the distortion mesh vertices. Matrices are 3x3
+// and column-major, as glUniformMatrix3fv() expects them.
+
+// Identity reprojection matrix.
+constexpr std::array<float, 9> kIdentityReprojectionMatrix = {
+    1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+// Returns the matrix that maps the texture coordinates of @p eye that a
+// display pixel samples when the head has the display orientation of
+// @p reprojection to the coordinates in the eye texture rendered with its
+// render orientation.
+std::array<float, 9> ComputeReprojectionMatrix(
+    const CardboardReprojection& reprojection, CardboardEye eye);
+
+// CPU reference of the reprojection the renderers apply in their vertex
+// shaders. Writes to @p out_uvs the @p count pairs of texture coordinates
+// of @p uvs transformed by @p matrix. @p uvs and @p out_uvs may be the same
+// buffer.
+void ReprojectTextureCoordinates(const std::array<float, 9>& matrix,
+                                 const float* uvs, int count, float* out_uvs);
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_REPROJECTION_H_
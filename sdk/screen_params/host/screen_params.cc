@@ -0,0 +1,34 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "screen_params.h"
+
+namespace cardboard::screen_params {
+
+namespace {
+
+// Pixel density of the fake screen. Hosts have no display to query, so the
+// typical density of a phone supported by Cardboard is used.
+constexpr float kScreenDpi = 400.0f;
+
+}  // anonymous namespace
+
+void getScreenSizeInMeters(int width_pixels, int height_pixels,
+                           float* out_width_meters, float* out_height_meters) {
+  *out_width_meters = (width_pixels / kScreenDpi) * kMetersPerInch;
+  *out_height_meters = (height_pixels / kScreenDpi) * kMetersPerInch;
+}
+
+}  // namespace cardboard::screen_params
@@ -151,7 +151,8 @@ namespace {
 
 bool ParseGyroEvent(const ASensorEvent& event, GyroscopeData* sample) {
   if (event.type == ASENSOR_TYPE_ADDITIONAL_INFO) {
-    CARDBOARD_LOGI("ParseGyroEvent discarding additional info sensor event");
+    CARDBOARD_LOGI_EVERY_N_SEC(
+        10.0, "ParseGyroEvent discarding additional info sensor event");
     return false;
   }
 
@@ -169,8 +170,9 @@ bool ParseGyroEvent(const ASensorEvent& event, GyroscopeData* sample) {
     sample->data = {event.vector.x, event.vector.y, event.vector.z};
     return true;
   } else {
-    CARDBOARD_LOGE("ParseGyroEvent discarding unexpected sensor event type %d",
-                   event.type);
+    CARDBOARD_LOGE_EVERY_N_SEC(
+        10.0, "ParseGyroEvent discarding unexpected sensor event type %d",
+        event.type);
   }
 
   return false;
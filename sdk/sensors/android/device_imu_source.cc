@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/device_imu_source.h"
+
+namespace cardboard {
+
+DeviceImuSource::DeviceImuSource()
+    : is_accelerometer_started_(false), is_gyroscope_started_(false) {}
+
+DeviceImuSource::~DeviceImuSource() { Stop(); }
+
+bool DeviceImuSource::Start() {
+  is_accelerometer_started_ = accelerometer_sensor_.Start();
+  is_gyroscope_started_ = gyroscope_sensor_.Start();
+  return is_accelerometer_started_ || is_gyroscope_started_;
+}
+
+void DeviceImuSource::PollForSensorData(
+    int timeout_ms, std::vector<AccelerometerData>* accelerometer_samples,
+    std::vector<GyroscopeData>* gyroscope_samples) {
+  accelerometer_samples->clear();
+  gyroscope_samples->clear();
+
+  // Both sensor queues are attached to the looper of this thread, so the first
+  // poll wakes up with events of either sensor. The second one only drains the
+  // events that are already queued.
+  if (is_accelerometer_started_) {
+    accelerometer_sensor_.PollForSensorData(timeout_ms, accelerometer_samples);
+    timeout_ms = 0;
+  }
+  if (is_gyroscope_started_) {
+    gyroscope_sensor_.PollForSensorData(timeout_ms, gyroscope_samples);
+  }
+
+  // On other devices and platforms we estimate the clock bias.
+  // TODO(b/135468657): Investigate clock conversion. Old cardboard doesn't have
+  // this.
+  for (AccelerometerData& sample : *accelerometer_samples) {
+    sample.system_timestamp = sample.sensor_timestamp_ns;
+  }
+  for (GyroscopeData& sample : *gyroscope_samples) {
+    sample.system_timestamp = sample.sensor_timestamp_ns;
+  }
+}
+
+void DeviceImuSource::Stop() {
+  if (is_accelerometer_started_) {
+    accelerometer_sensor_.Stop();
+    is_accelerometer_started_ = false;
+  }
+  if (is_gyroscope_started_) {
+    gyroscope_sensor_.Stop();
+    is_gyroscope_started_ = false;
+  }
+}
+
+}  // namespace cardboard
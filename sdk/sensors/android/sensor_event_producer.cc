@@ -19,6 +19,7 @@
 #include <memory>
 #include <mutex>   // NOLINT
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "sensors/accelerometer_data.h"
@@ -87,6 +88,12 @@ void SensorEventProducer<DataType>::StopSensorPollingLocked() {
   event_producer_->thread.reset();
 }
 
+template <typename DataType>
+void SensorEventProducer<DataType>::SetTraceWriter(
+    std::shared_ptr<ImuTraceWriter> trace_writer) {
+  std::atomic_store(&trace_writer_, std::move(trace_writer));
+}
+
 template <>
 void SensorEventProducer<AccelerometerData>::WorkFn() {
   DeviceAccelerometerSensor sensor;
@@ -102,8 +109,13 @@ void SensorEventProducer<AccelerometerData>::WorkFn() {
   // this.
   while (event_producer_->run_thread) {
     sensor.PollForSensorData(kMaxWaitMilliseconds, &sensor_events_vec);
+    const std::shared_ptr<ImuTraceWriter> trace_writer =
+        std::atomic_load(&trace_writer_);
     for (AccelerometerData& event : sensor_events_vec) {
       event.system_timestamp = event.sensor_timestamp_ns;
+      if (trace_writer) {
+        trace_writer->Write(event);
+      }
       if (on_event_callback_) {
         (*on_event_callback_)(event);
       }
@@ -127,8 +139,13 @@ void SensorEventProducer<GyroscopeData>::WorkFn() {
   // this.
   while (event_producer_->run_thread) {
     sensor.PollForSensorData(kMaxWaitMilliseconds, &sensor_events_vec);
+    const std::shared_ptr<ImuTraceWriter> trace_writer =
+        std::atomic_load(&trace_writer_);
     for (GyroscopeData& event : sensor_events_vec) {
       event.system_timestamp = event.sensor_timestamp_ns;
+      if (trace_writer) {
+        trace_writer->Write(event);
+      }
       if (on_event_callback_) {
         (*on_event_callback_)(event);
       }
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/angular_acceleration_estimator.h"
+
+#include <cmath>
+
+#include "util/vectorutils.h"
+
+namespace cardboard {
+
+namespace {
+
+// Number of standard deviations of the smoothed estimate below which the
+// estimate is considered to be noise.
+constexpr double kNoiseGateSigmas = 2.0;
+
+constexpr double kNanosToSeconds = 1e-9;
+
+}  // namespace
+
+constexpr int64_t AngularAccelerationEstimator::kMaxSampleGapNs;
+
+AngularAccelerationEstimator::AngularAccelerationEstimator(
+    double time_constant_s)
+    : time_constant_s_(time_constant_s) {
+  Reset();
+}
+
+void AngularAccelerationEstimator::AddSample(const Vector3& velocity,
+                                             int64_t timestamp_ns) {
+  if (has_previous_sample_ && timestamp_ns <= previous_timestamp_ns_) {
+    return;
+  }
+  if (!has_previous_sample_ ||
+      timestamp_ns - previous_timestamp_ns_ > kMaxSampleGapNs) {
+    has_previous_sample_ = true;
+    previous_velocity_ = velocity;
+    previous_timestamp_ns_ = timestamp_ns;
+    return;
+  }
+
+  const double timestep_s =
+      static_cast<double>(timestamp_ns - previous_timestamp_ns_) *
+      kNanosToSeconds;
+  const Vector3 acceleration = (velocity - previous_velocity_) / timestep_s;
+  previous_velocity_ = velocity;
+  previous_timestamp_ns_ = timestamp_ns;
+
+  if (!is_initialized_) {
+    smoothed_acceleration_ = acceleration;
+    residual_variance_ = 0.0;
+    latest_weight_ = 1.0;
+    is_initialized_ = true;
+    return;
+  }
+
+  const double weight = timestep_s / (time_constant_s_ + timestep_s);
+  const Vector3 residual = acceleration - smoothed_acceleration_;
+  smoothed_acceleration_ += weight * residual;
+  residual_variance_ += weight * (LengthSquared(residual) - residual_variance_);
+  latest_weight_ = weight;
+}
+
+Vector3 AngularAccelerationEstimator::GetAcceleration() const {
+  if (!is_initialized_) {
+    return Vector3::Zero();
+  }
+  // Once settled, an exponential moving average with weight w of white noise
+  // with variance v has variance v * w / (2 - w).
+  const double noise_sigma = std::sqrt(
+      residual_variance_ * latest_weight_ / (2.0 - latest_weight_));
+  const double threshold = kNoiseGateSigmas * noise_sigma;
+  const double magnitude = Length(smoothed_acceleration_);
+  if (magnitude <= threshold) {
+    return Vector3::Zero();
+  }
+  return smoothed_acceleration_ * ((magnitude - threshold) / magnitude);
+}
+
+void AngularAccelerationEstimator::SetTimeConstant(double time_constant_s) {
+  time_constant_s_ = time_constant_s;
+}
+
+void AngularAccelerationEstimator::Reset() {
+  has_previous_sample_ = false;
+  previous_velocity_ = Vector3::Zero();
+  previous_timestamp_ns_ = 0;
+  is_initialized_ = false;
+  smoothed_acceleration_ = Vector3::Zero();
+  residual_variance_ = 0.0;
+  latest_weight_ = 1.0;
+}
+
+}  // namespace cardboard
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_ANGULAR_ACCELERATION_ESTIMATOR_H_
+#define CARDBOARD_SDK_SENSORS_ANGULAR_ACCELERATION_ESTIMATOR_H_
+
+#include <cstdint>
+
+#include "util/vector.h"
+
+namespace cardboard {
+
+// Estimates the angular acceleration from a stream of angular velocities.
+// Consecutive velocities are differentiated and the derivatives are smoothed
+// with a first order low pass filter. The spread of the raw derivatives around
+// the smoothed value is tracked as well, and the estimate is shrunk towards
+// zero when it is not significant with respect to it, so that gyroscope noise
+// does not turn into prediction jitter.
+class AngularAccelerationEstimator {
+ public:
+  // Initializes an estimator whose low pass filter has the given time constant
+  // in seconds.
+  explicit AngularAccelerationEstimator(double time_constant_s);
+
+  // Updates the estimate with the given angular velocity. Samples with
+  // non-monotonic timestamps are ignored, and a gap of more than
+  // kMaxSampleGapNs restarts the differentiation.
+  //
+  // @param velocity angular velocity in radians per second.
+  // @param timestamp_ns timestamp associated to this sample in nanoseconds.
+  void AddSample(const Vector3& velocity, int64_t timestamp_ns);
+
+  // Returns the angular acceleration in radians per second squared. A vector
+  // with zeros is returned until two samples have been added.
+  Vector3 GetAcceleration() const;
+
+  // Changes the time constant of the low pass filter. The current estimate is
+  // kept.
+  void SetTimeConstant(double time_constant_s);
+
+  // Resets the estimator state.
+  void Reset();
+
+ private:
+  // Longest time between two samples that are differentiated.
+  static constexpr int64_t kMaxSampleGapNs = 100000000;
+
+  double time_constant_s_;
+
+  bool has_previous_sample_;
+  Vector3 previous_velocity_;
+  int64_t previous_timestamp_ns_;
+
+  bool is_initialized_;
+  Vector3 smoothed_acceleration_;
+  // Low pass filtered squared distance between the raw derivatives and
+  // smoothed_acceleration_.
+  double residual_variance_;
+  // Weight given to the latest derivative, needed to derive the noise of
+  // smoothed_acceleration_ from residual_variance_.
+  double latest_weight_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_ANGULAR_ACCELERATION_ESTIMATOR_H_
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_DEVICE_IMU_SOURCE_H_
+#define CARDBOARD_SDK_SENSORS_DEVICE_IMU_SOURCE_H_
+
+#include <vector>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/device_accelerometer_sensor.h"
+#include "sensors/device_gyroscope_sensor.h"
+#include "sensors/gyroscope_data.h"
+#include "sensors/imu_sample_source.h"
+
+namespace cardboard {
+
+// ImuSampleSource that reads the device accelerometer and gyroscope through the
+// native sensor framework. It must be created, polled and destroyed on the same
+// thread.
+class DeviceImuSource : public ImuSampleSource {
+ public:
+  DeviceImuSource();
+
+  ~DeviceImuSource() override;
+
+  bool Start() override;
+
+  void PollForSensorData(int timeout_ms,
+                         std::vector<AccelerometerData>* accelerometer_samples,
+                         std::vector<GyroscopeData>* gyroscope_samples) override;
+
+  void Stop() override;
+
+ private:
+  DeviceAccelerometerSensor accelerometer_sensor_;
+  DeviceGyroscopeSensor gyroscope_sensor_;
+  bool is_accelerometer_started_;
+  bool is_gyroscope_started_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_DEVICE_IMU_SOURCE_H_
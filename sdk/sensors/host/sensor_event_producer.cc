@@ -0,0 +1,160 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/sensor_event_producer.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+#include "sensors/synthetic_imu_source.h"
+
+namespace cardboard {
+
+// Host builds have no inertial sensors. Each producer generates the samples of
+// its sensor from a SyntheticImuSource instead, so the head tracker can be
+// exercised, e.g. by benchmarks, without a device.
+namespace {
+
+constexpr int64_t kAccelerometerPeriodNs = 10000000;  // 100 Hz.
+constexpr int64_t kGyroscopePeriodNs = 2500000;       // 400 Hz.
+// Slow yaw, so that poses keep changing.
+const Vector3 kAngularVelocity(0.0, 0.5, 0.0);
+
+// Returns the samples of the sensor of @p DataType.
+template <typename DataType>
+std::vector<DataType>* GetSamples(
+    std::vector<AccelerometerData>* accelerometer_samples,
+    std::vector<GyroscopeData>* gyroscope_samples);
+
+template <>
+std::vector<AccelerometerData>* GetSamples<AccelerometerData>(
+    std::vector<AccelerometerData>* accelerometer_samples,
+    std::vector<GyroscopeData>* /*gyroscope_samples*/) {
+  return accelerometer_samples;
+}
+
+template <>
+std::vector<GyroscopeData>* GetSamples<GyroscopeData>(
+    std::vector<AccelerometerData>* /*accelerometer_samples*/,
+    std::vector<GyroscopeData>* gyroscope_samples) {
+  return gyroscope_samples;
+}
+
+}  // namespace
+
+template <typename DataType>
+struct SensorEventProducer<DataType>::EventProducer {
+  EventProducer() : run_thread(false) {}
+  // Capture thread. This will be created when polling is started, and
+  // destroyed when polling is stopped.
+  std::unique_ptr<std::thread> thread;
+  std::mutex mutex;
+  // Flag indicating if the capture thread should run.
+  std::atomic<bool> run_thread;
+};
+
+template <typename DataType>
+SensorEventProducer<DataType>::SensorEventProducer()
+    : event_producer_(new EventProducer()) {}
+
+template <typename DataType>
+SensorEventProducer<DataType>::~SensorEventProducer() {
+  StopSensorPolling();
+}
+
+template <typename DataType>
+void SensorEventProducer<DataType>::StartSensorPolling(
+    const std::function<void(DataType)>* on_event_callback) {
+  on_event_callback_ = on_event_callback;
+  std::unique_lock<std::mutex> lock(event_producer_->mutex);
+  StartSensorPollingLocked();
+}
+
+template <typename DataType>
+void SensorEventProducer<DataType>::StopSensorPolling() {
+  std::unique_lock<std::mutex> lock(event_producer_->mutex);
+  StopSensorPollingLocked();
+  on_event_callback_ = nullptr;
+}
+
+template <typename DataType>
+void SensorEventProducer<DataType>::StartSensorPollingLocked() {
+  // If the thread is started already there is nothing left to do.
+  if (event_producer_->run_thread.exchange(true)) {
+    return;
+  }
+
+  event_producer_->thread.reset(new std::thread([&]() { WorkFn(); }));
+}
+
+template <typename DataType>
+void SensorEventProducer<DataType>::StopSensorPollingLocked() {
+  // If the thread is already stop nothing needs to be done.
+  if (!event_producer_->run_thread.exchange(false)) {
+    return;
+  }
+
+  if (!event_producer_->thread || !event_producer_->thread->joinable()) {
+    return;
+  }
+  event_producer_->thread->join();
+  event_producer_->thread.reset();
+}
+
+template <typename DataType>
+void SensorEventProducer<DataType>::SetTraceWriter(
+    std::shared_ptr<ImuTraceWriter> trace_writer) {
+  std::atomic_store(&trace_writer_, std::move(trace_writer));
+}
+
+template <typename DataType>
+void SensorEventProducer<DataType>::WorkFn() {
+  SyntheticImuSource source(kAccelerometerPeriodNs, kGyroscopePeriodNs,
+                            kAngularVelocity);
+  if (!source.Start()) {
+    return;
+  }
+
+  std::vector<AccelerometerData> accelerometer_samples;
+  std::vector<GyroscopeData> gyroscope_samples;
+  while (event_producer_->run_thread) {
+    source.PollForSensorData(kMaxWaitMilliseconds, &accelerometer_samples,
+                             &gyroscope_samples);
+    const std::shared_ptr<ImuTraceWriter> trace_writer =
+        std::atomic_load(&trace_writer_);
+    for (const DataType& event :
+         *GetSamples<DataType>(&accelerometer_samples, &gyroscope_samples)) {
+      if (trace_writer) {
+        trace_writer->Write(event);
+      }
+      if (on_event_callback_) {
+        (*on_event_callback_)(event);
+      }
+    }
+  }
+  source.Stop();
+}
+
+// Forcing instantiation of SensorEventProducer for each sensor type.
+template class SensorEventProducer<AccelerometerData>;
+template class SensorEventProducer<GyroscopeData>;
+
+}  // namespace cardboard
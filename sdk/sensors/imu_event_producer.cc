@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/imu_event_producer.h"
+
+#include <utility>
+
+#include "sensors/imu_sample_merger.h"
+#include "util/logging.h"
+
+namespace cardboard {
+
+ImuEventProducer::ImuEventProducer(SourceFactory source_factory)
+    : source_factory_(std::move(source_factory)),
+      run_thread_(false),
+      on_event_callback_(nullptr) {}
+
+ImuEventProducer::~ImuEventProducer() { StopSensorPolling(); }
+
+void ImuEventProducer::StartSensorPolling(const Callback* on_event_callback) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  on_event_callback_ = on_event_callback;
+
+  // If the thread is started already there is nothing left to do.
+  if (run_thread_.exchange(true)) {
+    return;
+  }
+
+  thread_.reset(new std::thread([this]() { WorkFn(); }));
+}
+
+void ImuEventProducer::StopSensorPolling() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // If the thread is already stopped nothing needs to be done.
+  if (run_thread_.exchange(false)) {
+    if (thread_ && thread_->joinable()) {
+      thread_->join();
+    }
+    thread_.reset();
+  }
+  on_event_callback_ = nullptr;
+}
+
+void ImuEventProducer::SetTraceWriter(
+    std::shared_ptr<ImuTraceWriter> trace_writer) {
+  std::atomic_store(&trace_writer_, std::move(trace_writer));
+}
+
+void ImuEventProducer::WorkFn() {
+  std::unique_ptr<ImuSampleSource> source = source_factory_();
+  if (!source || !source->Start()) {
+    CARDBOARD_LOGE("Could not start the inertial sensors.");
+    return;
+  }
+
+  ImuSampleMerger merger;
+  std::vector<AccelerometerData> accelerometer_samples;
+  std::vector<GyroscopeData> gyroscope_samples;
+  std::vector<ImuSample> batch;
+
+  while (run_thread_) {
+    source->PollForSensorData(kMaxWaitMilliseconds, &accelerometer_samples,
+                              &gyroscope_samples);
+
+    const std::shared_ptr<ImuTraceWriter> trace_writer =
+        std::atomic_load(&trace_writer_);
+    if (trace_writer) {
+      for (const AccelerometerData& sample : accelerometer_samples) {
+        trace_writer->Write(sample);
+      }
+      for (const GyroscopeData& sample : gyroscope_samples) {
+        trace_writer->Write(sample);
+      }
+    }
+
+    batch.clear();
+    if (accelerometer_samples.empty() && gyroscope_samples.empty()) {
+      // Sensors are idle, nothing newer can be waited for.
+      merger.Flush(&batch);
+    } else {
+      merger.AddAccelerometerSamples(accelerometer_samples);
+      merger.AddGyroscopeSamples(gyroscope_samples);
+      merger.Release(&batch);
+    }
+
+    if (!batch.empty() && on_event_callback_) {
+      (*on_event_callback_)(batch);
+    }
+  }
+  source->Stop();
+}
+
+}  // namespace cardboard
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_IMU_EVENT_PRODUCER_H_
+#define CARDBOARD_SDK_SENSORS_IMU_EVENT_PRODUCER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "sensors/imu_sample.h"
+#include "sensors/imu_sample_source.h"
+#include "sensors/imu_trace.h"
+
+namespace cardboard {
+
+// Stream publisher that polls both inertial sensors from a single thread and
+// delivers their samples merged in timestamp order, in batches.
+//
+// The source is created on the polling thread, so sources that bind to
+// thread-local resources (e.g. an Android looper) can be used.
+class ImuEventProducer {
+ public:
+  using SourceFactory = std::function<std::unique_ptr<ImuSampleSource>()>;
+  using Callback = std::function<void(const std::vector<ImuSample>&)>;
+
+  // @param source_factory function called on the polling thread to create the
+  //        sample source each time polling starts.
+  explicit ImuEventProducer(SourceFactory source_factory);
+
+  ~ImuEventProducer();
+
+  // Registers callback and starts polling if it is not running yet. The
+  // callback is called on the polling thread with each non empty batch.
+  void StartSensorPolling(const Callback* on_event_callback);
+
+  // This stops sensor polling if it is currently running. This method blocks
+  // until the polling thread is finished.
+  void StopSensorPolling();
+
+  // Records every polled sample into @p trace_writer, before samples are
+  // merged. A nullptr stops recording. Safe to call while polling.
+  void SetTraceWriter(std::shared_ptr<ImuTraceWriter> trace_writer);
+
+ private:
+  // Worker method that polls the source, merges the samples and executes the
+  // callback.
+  void WorkFn();
+
+  // Maximum waiting time for sensor events.
+  static const int kMaxWaitMilliseconds = 100;
+
+  const SourceFactory source_factory_;
+
+  // Polling thread. This will be created when polling is started, and
+  // destroyed when polling is stopped.
+  std::unique_ptr<std::thread> thread_;
+  std::mutex mutex_;
+  // Flag indicating if the polling thread should run.
+  std::atomic<bool> run_thread_;
+
+  // Callback to call with each batch of samples.
+  const Callback* on_event_callback_;
+
+  // Optional trace recorder. Accessed atomically.
+  std::shared_ptr<ImuTraceWriter> trace_writer_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_IMU_EVENT_PRODUCER_H_
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_IMU_SAMPLE_H_
+#define CARDBOARD_SDK_SENSORS_IMU_SAMPLE_H_
+
+#include <cstdint>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+
+namespace cardboard {
+
+// One sample of either inertial sensor, as delivered in the time ordered
+// batches of ImuEventProducer.
+struct ImuSample {
+  enum class Type {
+    kAccelerometer,
+    kGyroscope,
+  };
+
+  // Sensor that produced the sample.
+  Type type;
+
+  // Sample data. Only the member matching type is meaningful.
+  AccelerometerData accelerometer;
+  GyroscopeData gyroscope;
+
+  // Sensor clock time of the sample in nanoseconds.
+  uint64_t sensor_timestamp_ns() const {
+    return type == Type::kAccelerometer ? accelerometer.sensor_timestamp_ns
+                                        : gyroscope.sensor_timestamp_ns;
+  }
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_IMU_SAMPLE_H_
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/imu_sample_merger.h"
+
+namespace cardboard {
+
+ImuSampleMerger::ImuSampleMerger(int64_t max_accelerometer_delay_ns)
+    : max_accelerometer_delay_ns_(max_accelerometer_delay_ns),
+      latest_accelerometer_timestamp_ns_(0),
+      latest_gyroscope_timestamp_ns_(0) {}
+
+void ImuSampleMerger::AddAccelerometerSamples(
+    const std::vector<AccelerometerData>& samples) {
+  for (const AccelerometerData& sample : samples) {
+    pending_accelerometer_samples_.push_back(sample);
+    latest_accelerometer_timestamp_ns_ = sample.sensor_timestamp_ns;
+  }
+}
+
+void ImuSampleMerger::AddGyroscopeSamples(
+    const std::vector<GyroscopeData>& samples) {
+  for (const GyroscopeData& sample : samples) {
+    pending_gyroscope_samples_.push_back(sample);
+    latest_gyroscope_timestamp_ns_ = sample.sensor_timestamp_ns;
+  }
+}
+
+void ImuSampleMerger::Release(std::vector<ImuSample>* samples) {
+  size_t accelerometer_count = 0;
+  for (const AccelerometerData& sample : pending_accelerometer_samples_) {
+    const bool is_reached_by_gyroscope =
+        sample.sensor_timestamp_ns <= latest_gyroscope_timestamp_ns_;
+    const bool is_overdue =
+        static_cast<int64_t>(latest_accelerometer_timestamp_ns_ -
+                             sample.sensor_timestamp_ns) >
+        max_accelerometer_delay_ns_;
+    if (!is_reached_by_gyroscope && !is_overdue) {
+      break;
+    }
+    ++accelerometer_count;
+  }
+  Merge(accelerometer_count, samples);
+}
+
+void ImuSampleMerger::Flush(std::vector<ImuSample>* samples) {
+  Merge(pending_accelerometer_samples_.size(), samples);
+}
+
+void ImuSampleMerger::Reset() {
+  pending_accelerometer_samples_.clear();
+  pending_gyroscope_samples_.clear();
+  latest_accelerometer_timestamp_ns_ = 0;
+  latest_gyroscope_timestamp_ns_ = 0;
+}
+
+void ImuSampleMerger::Merge(size_t accelerometer_count,
+                            std::vector<ImuSample>* samples) {
+  ImuSample sample;
+  size_t accelerometer_index = 0;
+  size_t gyroscope_index = 0;
+  while (accelerometer_index < accelerometer_count ||
+         gyroscope_index < pending_gyroscope_samples_.size()) {
+    const bool take_accelerometer =
+        gyroscope_index == pending_gyroscope_samples_.size() ||
+        (accelerometer_index < accelerometer_count &&
+         pending_accelerometer_samples_[accelerometer_index]
+                 .sensor_timestamp_ns <
+             pending_gyroscope_samples_[gyroscope_index].sensor_timestamp_ns);
+    if (take_accelerometer) {
+      sample.type = ImuSample::Type::kAccelerometer;
+      sample.accelerometer =
+          pending_accelerometer_samples_[accelerometer_index++];
+    } else {
+      sample.type = ImuSample::Type::kGyroscope;
+      sample.gyroscope = pending_gyroscope_samples_[gyroscope_index++];
+    }
+    samples->push_back(sample);
+  }
+
+  pending_accelerometer_samples_.erase(
+      pending_accelerometer_samples_.begin(),
+      pending_accelerometer_samples_.begin() + accelerometer_count);
+  pending_gyroscope_samples_.clear();
+}
+
+}  // namespace cardboard
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_IMU_SAMPLE_MERGER_H_
+#define CARDBOARD_SDK_SENSORS_IMU_SAMPLE_MERGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+#include "sensors/imu_sample.h"
+
+namespace cardboard {
+
+// Merges the accelerometer and gyroscope streams into a single stream ordered
+// by sensor timestamp.
+//
+// Gyroscope samples drive the predicted pose, so they are released as soon as
+// they are added. Accelerometer samples are held back until the gyroscope
+// stream reaches their timestamp, so that no gyroscope sample released later
+// is older than them. If the gyroscope stalls, accelerometer samples are
+// released once a newer accelerometer sample arrives more than
+// max_accelerometer_delay_ns later, or when Flush() is called.
+class ImuSampleMerger {
+ public:
+  // Default bound on how long an accelerometer sample waits for the gyroscope.
+  static constexpr int64_t kDefaultMaxAccelerometerDelayNs = 20000000;
+
+  explicit ImuSampleMerger(
+      int64_t max_accelerometer_delay_ns = kDefaultMaxAccelerometerDelayNs);
+
+  // Adds samples of one sensor. Samples of a sensor must be added in
+  // timestamp order.
+  void AddAccelerometerSamples(const std::vector<AccelerometerData>& samples);
+  void AddGyroscopeSamples(const std::vector<GyroscopeData>& samples);
+
+  // Appends to @p samples, in timestamp order, the samples that can be
+  // delivered without breaking the order of the merged stream.
+  void Release(std::vector<ImuSample>* samples);
+
+  // Appends to @p samples, in timestamp order, all the pending samples.
+  void Flush(std::vector<ImuSample>* samples);
+
+  // Drops the pending samples and forgets the stream positions.
+  void Reset();
+
+ private:
+  // Merges the pending gyroscope samples with the first
+  // @p accelerometer_count pending accelerometer samples.
+  void Merge(size_t accelerometer_count, std::vector<ImuSample>* samples);
+
+  const int64_t max_accelerometer_delay_ns_;
+
+  std::deque<AccelerometerData> pending_accelerometer_samples_;
+  std::vector<GyroscopeData> pending_gyroscope_samples_;
+
+  // Timestamp of the newest sample added for each sensor.
+  uint64_t latest_accelerometer_timestamp_ns_;
+  uint64_t latest_gyroscope_timestamp_ns_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_IMU_SAMPLE_MERGER_H_
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_IMU_SAMPLE_SOURCE_H_
+#define CARDBOARD_SDK_SENSORS_IMU_SAMPLE_SOURCE_H_
+
+#include <vector>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+
+namespace cardboard {
+
+// Interface of a source of accelerometer and gyroscope samples that can be
+// polled from a single thread.
+class ImuSampleSource {
+ public:
+  virtual ~ImuSampleSource() = default;
+
+  // Starts the sample capture process. This must be called successfully
+  // before calling PollForSensorData().
+  //
+  // @return false if no sensor could be started.
+  virtual bool Start() = 0;
+
+  // Waits up to timeout_ms for samples of either sensor and returns all the
+  // samples available by then. If timeout_ms < 0, it waits indefinitely.
+  //
+  // @param timeout_ms timeout period in milliseconds.
+  // @param accelerometer_samples accelerometer samples in timestamp order.
+  // @param gyroscope_samples gyroscope samples in timestamp order.
+  virtual void PollForSensorData(
+      int timeout_ms, std::vector<AccelerometerData>* accelerometer_samples,
+      std::vector<GyroscopeData>* gyroscope_samples) = 0;
+
+  // Stops the sample capture process.
+  virtual void Stop() = 0;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_IMU_SAMPLE_SOURCE_H_
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/imu_trace.h"
+
+#include <cstring>
+
+#include "util/logging.h"
+
+namespace cardboard {
+
+namespace {
+
+constexpr char kMagic[4] = {'C', 'B', 'I', 'T'};
+constexpr uint32_t kVersion = 1;
+
+// Size of the type and timestamp fields of a record.
+constexpr size_t kRecordHeaderSize = sizeof(uint8_t) + sizeof(uint64_t);
+// Largest number of float values of a record.
+constexpr int kMaxValueCount = 4;
+
+int GetValueCount(ImuTraceRecord::Type type) {
+  switch (type) {
+    case ImuTraceRecord::Type::kAccelerometer:
+    case ImuTraceRecord::Type::kGyroscope:
+      return 3;
+    case ImuTraceRecord::Type::kGroundTruth:
+      return 4;
+  }
+  return -1;
+}
+
+}  // namespace
+
+AccelerometerData ImuTraceRecord::ToAccelerometerData() const {
+  AccelerometerData sample;
+  sample.sensor_timestamp_ns = timestamp_ns;
+  sample.system_timestamp = timestamp_ns;
+  sample.data = data;
+  return sample;
+}
+
+GyroscopeData ImuTraceRecord::ToGyroscopeData() const {
+  GyroscopeData sample;
+  sample.sensor_timestamp_ns = timestamp_ns;
+  sample.system_timestamp = timestamp_ns;
+  sample.data = data;
+  return sample;
+}
+
+ImuTraceWriter::ImuTraceWriter() : file_(nullptr) {}
+
+ImuTraceWriter::~ImuTraceWriter() { Close(); }
+
+bool ImuTraceWriter::Open(const std::string& path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+  file_ = fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    CARDBOARD_LOGE("Could not create IMU trace %s.", path.c_str());
+    return false;
+  }
+  if (fwrite(kMagic, sizeof(kMagic), 1, file_) != 1 ||
+      fwrite(&kVersion, sizeof(kVersion), 1, file_) != 1) {
+    CARDBOARD_LOGE("Could not write IMU trace %s.", path.c_str());
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void ImuTraceWriter::Close() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+void ImuTraceWriter::Write(const AccelerometerData& sample) {
+  const float values[3] = {static_cast<float>(sample.data[0]),
+                           static_cast<float>(sample.data[1]),
+                           static_cast<float>(sample.data[2])};
+  WriteRecord(ImuTraceRecord::Type::kAccelerometer, sample.sensor_timestamp_ns,
+              values, 3);
+}
+
+void ImuTraceWriter::Write(const GyroscopeData& sample) {
+  const float values[3] = {static_cast<float>(sample.data[0]),
+                           static_cast<float>(sample.data[1]),
+                           static_cast<float>(sample.data[2])};
+  WriteRecord(ImuTraceRecord::Type::kGyroscope, sample.sensor_timestamp_ns,
+              values, 3);
+}
+
+void ImuTraceWriter::WriteGroundTruth(
+    uint64_t timestamp_ns, const Rotation& sensor_from_start_rotation) {
+  const Rotation::QuaternionType& quaternion =
+      sensor_from_start_rotation.GetQuaternion();
+  const float values[4] = {
+      static_cast<float>(quaternion[0]), static_cast<float>(quaternion[1]),
+      static_cast<float>(quaternion[2]), static_cast<float>(quaternion[3])};
+  WriteRecord(ImuTraceRecord::Type::kGroundTruth, timestamp_ns, values, 4);
+}
+
+void ImuTraceWriter::WriteRecord(ImuTraceRecord::Type type,
+                                 uint64_t timestamp_ns, const float* values,
+                                 int value_count) {
+  uint8_t buffer[kRecordHeaderSize + kMaxValueCount * sizeof(float)];
+  buffer[0] = static_cast<uint8_t>(type);
+  std::memcpy(buffer + sizeof(uint8_t), &timestamp_ns, sizeof(timestamp_ns));
+  std::memcpy(buffer + kRecordHeaderSize, values, value_count * sizeof(float));
+  const size_t size = kRecordHeaderSize + value_count * sizeof(float);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (file_ == nullptr) {
+    return;
+  }
+  if (fwrite(buffer, size, 1, file_) != 1) {
+    CARDBOARD_LOGE("Could not write IMU trace record, closing the trace.");
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+ImuTraceReader::ImuTraceReader() : file_(nullptr) {}
+
+ImuTraceReader::~ImuTraceReader() {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+}
+
+bool ImuTraceReader::Open(const std::string& path) {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+  file_ = fopen(path.c_str(), "rb");
+  if (file_ == nullptr) {
+    CARDBOARD_LOGE("Could not open IMU trace %s.", path.c_str());
+    return false;
+  }
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  if (fread(magic, sizeof(magic), 1, file_) != 1 ||
+      fread(&version, sizeof(version), 1, file_) != 1 ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion) {
+    CARDBOARD_LOGE("%s is not a supported IMU trace.", path.c_str());
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool ImuTraceReader::ReadNext(ImuTraceRecord* record) {
+  if (file_ == nullptr) {
+    return false;
+  }
+  uint8_t header[kRecordHeaderSize];
+  if (fread(header, sizeof(header), 1, file_) != 1) {
+    return false;
+  }
+  record->type = static_cast<ImuTraceRecord::Type>(header[0]);
+  const int value_count = GetValueCount(record->type);
+  if (value_count < 0) {
+    CARDBOARD_LOGE("Unknown IMU trace record type %d.", header[0]);
+    return false;
+  }
+  std::memcpy(&record->timestamp_ns, header + sizeof(uint8_t),
+              sizeof(record->timestamp_ns));
+
+  float values[kMaxValueCount];
+  if (fread(values, sizeof(float), value_count, file_) !=
+      static_cast<size_t>(value_count)) {
+    CARDBOARD_LOGE("Truncated IMU trace record.");
+    return false;
+  }
+  if (record->type == ImuTraceRecord::Type::kGroundTruth) {
+    record->sensor_from_start_rotation = Rotation::FromQuaternion(
+        Rotation::QuaternionType(values[0], values[1], values[2], values[3]));
+  } else {
+    record->data = Vector3(values[0], values[1], values[2]);
+  }
+  return true;
+}
+
+}  // namespace cardboard
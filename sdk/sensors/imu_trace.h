@@ -0,0 +1,121 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_IMU_TRACE_H_
+#define CARDBOARD_SDK_SENSORS_IMU_TRACE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+
+namespace cardboard {
+
+// Binary IMU trace format.
+//
+// A trace starts with the 4 byte magic "CBIT" and a uint32_t version, followed
+// by a sequence of records. Each record is a uint8_t record type and a uint64_t
+// timestamp in nanoseconds, followed by:
+//  - Accelerometer and gyroscope records: the x,y,z values as floats.
+//  - Ground truth records: the sensor from start rotation quaternion as x,y,z,w
+//    floats.
+// Fields are packed and stored in native byte order, which is little endian on
+// every supported platform.
+struct ImuTraceRecord {
+  enum class Type : uint8_t {
+    kAccelerometer = 1,
+    kGyroscope = 2,
+    kGroundTruth = 3,
+  };
+
+  Type type;
+
+  // Sensor clock time in nanoseconds.
+  uint64_t timestamp_ns;
+
+  // Sensor values of accelerometer and gyroscope records.
+  Vector3 data;
+
+  // Rotation from Start Space to Sensor Space of ground truth records.
+  Rotation sensor_from_start_rotation;
+
+  // Returns the record as sensor data. Timestamps are assumed to be in system
+  // time, as on every supported platform.
+  AccelerometerData ToAccelerometerData() const;
+  GyroscopeData ToGyroscopeData() const;
+};
+
+// Appends records to a trace file. All methods are thread safe, so sensor
+// threads can record concurrently.
+class ImuTraceWriter {
+ public:
+  ImuTraceWriter();
+  ~ImuTraceWriter();
+
+  // Creates or truncates the trace at @p path and writes its header.
+  //
+  // @return false if the file could not be written.
+  bool Open(const std::string& path);
+
+  // Flushes and closes the trace. Writes after this call are ignored.
+  void Close();
+
+  void Write(const AccelerometerData& sample);
+  void Write(const GyroscopeData& sample);
+  void WriteGroundTruth(uint64_t timestamp_ns,
+                        const Rotation& sensor_from_start_rotation);
+
+ private:
+  void WriteRecord(ImuTraceRecord::Type type, uint64_t timestamp_ns,
+                   const float* values, int value_count);
+
+  std::mutex mutex_;
+  FILE* file_;
+
+  ImuTraceWriter(const ImuTraceWriter&) = delete;
+  ImuTraceWriter& operator=(const ImuTraceWriter&) = delete;
+};
+
+// Reads the records of a trace file in order.
+class ImuTraceReader {
+ public:
+  ImuTraceReader();
+  ~ImuTraceReader();
+
+  // Opens the trace at @p path and checks its header.
+  //
+  // @return false if the file is missing or is not a supported trace.
+  bool Open(const std::string& path);
+
+  // Reads the next record.
+  //
+  // @return false at the end of the trace or on a malformed record.
+  bool ReadNext(ImuTraceRecord* record);
+
+ private:
+  FILE* file_;
+
+  ImuTraceReader(const ImuTraceReader&) = delete;
+  ImuTraceReader& operator=(const ImuTraceReader&) = delete;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_IMU_TRACE_H_
@@ -20,6 +20,7 @@
 #import <UIKit/UIKit.h>
 
 #include <atomic>
+#include <utility>
 #include <vector>
 
 #import "sensors/accelerometer_data.h"
@@ -135,14 +136,23 @@ void SensorEventProducer<GyroscopeData>::StopSensorPolling() {
                                           callback:event_producer_->workfn_block];
 }
 
+template <typename DataType>
+void SensorEventProducer<DataType>::SetTraceWriter(std::shared_ptr<ImuTraceWriter> trace_writer) {
+  std::atomic_store(&trace_writer_, std::move(trace_writer));
+}
+
 template <typename DataType>
 void SensorEventProducer<DataType>::WorkFn() {
   event_producer_->sensor.value->PollForSensorData(kMaxWaitMilliseconds,
                                                    &event_producer_->sensor_events_vec);
 
+  const std::shared_ptr<ImuTraceWriter> trace_writer = std::atomic_load(&trace_writer_);
   for (DataType& event : event_producer_->sensor_events_vec) {
     // iOS hardware timestamps are already in system time.
     event.system_timestamp = event.sensor_timestamp_ns;
+    if (trace_writer) {
+      trace_writer->Write(event);
+    }
     if (on_event_callback_) {
       (*on_event_callback_)(event);
     }
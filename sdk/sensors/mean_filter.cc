@@ -17,25 +17,41 @@
 
 namespace cardboard {
 
-MeanFilter::MeanFilter(size_t filter_size) : filter_size_(filter_size) {}
+MeanFilter::MeanFilter(size_t filter_size)
+    : filter_size_(filter_size),
+      buffer_(filter_size),
+      next_index_(0),
+      size_(0),
+      sum_(Vector3::Zero()) {}
 
 void MeanFilter::AddSample(const Vector3& sample) {
-  buffer_.push_back(sample);
-  if (buffer_.size() > filter_size_) {
-    buffer_.pop_front();
+  if (filter_size_ == 0) {
+    return;
   }
-}
 
-bool MeanFilter::IsValid() const { return buffer_.size() == filter_size_; }
+  if (size_ == filter_size_) {
+    sum_ -= buffer_[next_index_];
+  } else {
+    ++size_;
+  }
+  buffer_[next_index_] = sample;
+  sum_ += sample;
 
-Vector3 MeanFilter::GetFilteredData() const {
-  // Compute mean of the samples stored in buffer_.
-  Vector3 mean = Vector3::Zero();
-  for (auto sample : buffer_) {
-    mean += sample;
+  next_index_ = (next_index_ + 1) % filter_size_;
+  if (next_index_ == 0) {
+    // Recomputes the sum once per window so that rounding errors of the
+    // running sum do not accumulate.
+    sum_ = Vector3::Zero();
+    for (size_t i = 0; i < size_; ++i) {
+      sum_ += buffer_[i];
+    }
   }
+}
+
+bool MeanFilter::IsValid() const { return size_ == filter_size_; }
 
-  return mean / static_cast<double>(filter_size_);
+Vector3 MeanFilter::GetFilteredData() const {
+  return sum_ / static_cast<double>(filter_size_);
 }
 
 }  // namespace cardboard
@@ -16,13 +16,17 @@
 #ifndef CARDBOARD_SDK_SENSORS_MEAN_FILTER_H_
 #define CARDBOARD_SDK_SENSORS_MEAN_FILTER_H_
 
-#include <deque>
+#include <cstddef>
+#include <vector>
 
 #include "util/vector.h"
 
 namespace cardboard {
 
 // Fixed window FIFO mean filter for vectors of the given dimension.
+// Samples are kept in a ring buffer allocated at construction and the mean is
+// maintained as a running sum, so adding samples and reading the mean are O(1)
+// and never allocate.
 class MeanFilter {
  public:
   // Create a mean filter of size filter_size.
@@ -40,7 +44,14 @@ class MeanFilter {
 
  private:
   const size_t filter_size_;
-  std::deque<Vector3> buffer_;
+  // Ring buffer of the latest samples.
+  std::vector<Vector3> buffer_;
+  // Index of buffer_ where the next sample is stored.
+  size_t next_index_;
+  // Number of samples stored in buffer_.
+  size_t size_;
+  // Sum of the samples stored in buffer_.
+  Vector3 sum_;
 };
 
 }  // namespace cardboard
@@ -16,6 +16,7 @@
 #include "sensors/median_filter.h"
 
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "util/vector.h"
@@ -23,42 +24,68 @@
 
 namespace cardboard {
 
-MedianFilter::MedianFilter(size_t filter_size) : filter_size_(filter_size) {}
+MedianFilter::MedianFilter(size_t filter_size)
+    : filter_size_(filter_size),
+      buffer_(filter_size),
+      norms_(filter_size),
+      next_index_(0),
+      size_(0) {
+  // Reserved once so that insertions never reallocate.
+  sorted_norms_.reserve(filter_size);
+}
 
 void MedianFilter::AddSample(const Vector3& sample) {
-  buffer_.push_back(sample);
-  norms_.push_back(Length(sample));
-  if (buffer_.size() > filter_size_) {
-    buffer_.pop_front();
-    norms_.pop_front();
+  if (filter_size_ == 0) {
+    return;
+  }
+
+  // NaN norms would break the ordering of the sorted window, so the norm of
+  // the oldest sample could not be found when dropping it.
+  const float norm = Length(sample);
+  if (!std::isfinite(norm)) {
+    return;
+  }
+
+  // Drops the norm of the oldest sample from the sorted window.
+  if (size_ == filter_size_) {
+    sorted_norms_.erase(std::lower_bound(sorted_norms_.begin(),
+                                         sorted_norms_.end(),
+                                         norms_[next_index_]));
+  } else {
+    ++size_;
   }
+
+  buffer_[next_index_] = sample;
+  norms_[next_index_] = norm;
+  sorted_norms_.insert(
+      std::upper_bound(sorted_norms_.begin(), sorted_norms_.end(), norm),
+      norm);
+
+  next_index_ = (next_index_ + 1) % filter_size_;
 }
 
-bool MedianFilter::IsValid() const { return buffer_.size() == filter_size_; }
+bool MedianFilter::IsValid() const { return size_ == filter_size_; }
 
 Vector3 MedianFilter::GetFilteredData() const {
-  std::vector<float> norms(norms_.begin(), norms_.end());
-
   // Get median of value of the norms.
-  std::nth_element(norms.begin(), norms.begin() + filter_size_ / 2,
-                   norms.end());
-  const float median_norm = norms[filter_size_ / 2];
+  const float median_norm = sorted_norms_[filter_size_ / 2];
 
-  // Get median value based on their norm.
-  auto median_it = buffer_.begin();
-  for (const auto norm : norms_) {
-    if (norm == median_norm) {
-      break;
+  // Get median value based on their norm, taking the oldest sample on ties.
+  const size_t oldest_index = size_ == filter_size_ ? next_index_ : 0;
+  for (size_t i = 0; i < size_; ++i) {
+    const size_t index = (oldest_index + i) % filter_size_;
+    if (norms_[index] == median_norm) {
+      return buffer_[index];
     }
-    ++median_it;
   }
 
-  return *median_it;
+  return buffer_[oldest_index];
 }
 
 void MedianFilter::Reset() {
-  buffer_.clear();
-  norms_.clear();
+  sorted_norms_.clear();
+  next_index_ = 0;
+  size_ = 0;
 }
 
 }  // namespace cardboard
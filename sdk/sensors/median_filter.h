@@ -16,13 +16,17 @@
 #ifndef CARDBOARD_SDK_SENSORS_MEDIAN_FILTER_H_
 #define CARDBOARD_SDK_SENSORS_MEDIAN_FILTER_H_
 
-#include <deque>
+#include <cstddef>
+#include <vector>
 
 #include "util/vector.h"
 
 namespace cardboard {
 
 // Fixed window FIFO median filter for vectors of the given dimension = 3.
+// Samples are kept in a ring buffer allocated at construction, and their norms
+// in a sorted window updated incrementally with every sample, so the filter
+// never allocates after construction.
 class MedianFilter {
  public:
   // Creates a median filter of size filter_size.
@@ -30,6 +34,7 @@ class MedianFilter {
   explicit MedianFilter(size_t filter_size);
 
   // Adds sample to buffer_ if buffer_ is full it drops the oldest sample.
+  // Samples with a non-finite norm are ignored.
   void AddSample(const Vector3& sample);
 
   // Returns true if buffer has filter_size_ sample, false otherwise.
@@ -43,9 +48,17 @@ class MedianFilter {
 
  private:
   const size_t filter_size_;
-  std::deque<Vector3> buffer_;
-  // Contains norms of the elements stored in buffer_.
-  std::deque<float> norms_;
+  // Ring buffer of the latest samples.
+  std::vector<Vector3> buffer_;
+  // Contains norms of the elements stored in buffer_, at the same indices.
+  std::vector<float> norms_;
+  // Norms of the elements stored in buffer_, in ascending order.
+  std::vector<float> sorted_norms_;
+  // Index of buffer_ where the next sample is stored. When the buffer is full,
+  // it is also the index of the oldest sample.
+  size_t next_index_;
+  // Number of samples stored in buffer_.
+  size_t size_;
 };
 
 }  // namespace cardboard
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/rotation_history.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace cardboard {
+
+namespace {
+
+// Number of times a query is attempted when the writer keeps wrapping around
+// onto the entries read, which only happens if the reader is preempted for
+// about kCapacity - kQueryableCount samples.
+constexpr int kMaxQueryAttempts = 4;
+
+}  // namespace
+
+RotationHistory::RotationHistory()
+    : begin_(0),
+      end_(0),
+      latest_timestamp_(std::numeric_limits<int64_t>::min()) {}
+
+void RotationHistory::Add(int64_t timestamp, const Rotation& rotation) {
+  if (timestamp <= latest_timestamp_) {
+    return;
+  }
+  latest_timestamp_ = timestamp;
+
+  const uint64_t end = end_.load(std::memory_order_relaxed);
+  entries_[end % kCapacity].Store({timestamp, rotation});
+  end_.store(end + 1, std::memory_order_release);
+}
+
+void RotationHistory::Clear() {
+  latest_timestamp_ = std::numeric_limits<int64_t>::min();
+  begin_.store(end_.load(std::memory_order_relaxed),
+               std::memory_order_release);
+}
+
+bool RotationHistory::GetRotation(int64_t timestamp,
+                                  Rotation* rotation) const {
+  for (int attempt = 0; attempt < kMaxQueryAttempts; ++attempt) {
+    const uint64_t end = end_.load(std::memory_order_acquire);
+    const uint64_t begin =
+        std::max(begin_.load(std::memory_order_acquire),
+                 end > kQueryableCount ? end - kQueryableCount : 0);
+    if (begin == end) {
+      return false;
+    }
+
+    // Finds the first entry not older than the timestamp.
+    uint64_t low = begin;
+    uint64_t high = end;
+    while (low < high) {
+      const uint64_t middle = low + (high - low) / 2;
+      if (LoadEntry(middle).timestamp < timestamp) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+
+    bool found = false;
+    Rotation result;
+    if (low != end) {
+      const Entry next = LoadEntry(low);
+      if (next.timestamp == timestamp) {
+        result = next.rotation;
+        found = true;
+      } else if (low != begin) {
+        const Entry previous = LoadEntry(low - 1);
+        result = Rotation::Slerp(
+            previous.rotation, next.rotation,
+            static_cast<double>(timestamp - previous.timestamp) /
+                static_cast<double>(next.timestamp - previous.timestamp));
+        found = true;
+      }
+    }
+
+    // The entries read are consistent unless the writer has overwritten the
+    // oldest of them or the history has been cleared in the meantime. Seeing
+    // an overwritten entry implies seeing the end_ value that preceded it.
+    if (end_.load(std::memory_order_acquire) - begin < kCapacity &&
+        begin_.load(std::memory_order_acquire) <= begin) {
+      if (found) {
+        *rotation = result;
+      }
+      return found;
+    }
+  }
+  return false;
+}
+
+RotationHistory::Entry RotationHistory::LoadEntry(uint64_t index) const {
+  return entries_[index % kCapacity].Load();
+}
+
+}  // namespace cardboard
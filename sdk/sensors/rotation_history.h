@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_ROTATION_HISTORY_H_
+#define CARDBOARD_SDK_SENSORS_ROTATION_HISTORY_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "util/rotation.h"
+#include "util/seqlock.h"
+
+namespace cardboard {
+
+// Ring buffer of the latest timestamped rotations, which can be queried at any
+// timestamp between the oldest and the newest one.
+//
+// There must be a single writer at a time, which never waits for readers.
+// Readers never take a lock either: each entry is published through its own
+// SeqLock, and a query is retried if the writer wrapped around onto the
+// entries it read.
+class RotationHistory {
+ public:
+  // Number of entries kept.
+  static constexpr int kCapacity = 1024;
+  // Number of newest entries that can be queried. The other ones are a margin
+  // that the writer can fill while a query is in progress. At 1 kHz, it spans
+  // 512 ms.
+  static constexpr int kQueryableCount = kCapacity / 2;
+
+  RotationHistory();
+
+  // Appends a rotation. It is ignored unless @p timestamp is greater than the
+  // one of the newest entry. Must not be called concurrently with Add() or
+  // Clear().
+  //
+  // @param timestamp timestamp of the rotation in nanoseconds.
+  // @param rotation rotation at @p timestamp.
+  void Add(int64_t timestamp, const Rotation& rotation);
+
+  // Removes all entries. Must not be called concurrently with Add() or
+  // Clear().
+  void Clear();
+
+  // Gets the rotation at @p timestamp, spherically interpolated between the
+  // entries around it. Safe to call from any thread.
+  //
+  // @param timestamp timestamp in nanoseconds.
+  // @param[out] rotation interpolated rotation.
+  // @return false if @p timestamp is out of the queryable entries.
+  bool GetRotation(int64_t timestamp, Rotation* rotation) const;
+
+ private:
+  struct Entry {
+    int64_t timestamp;
+    Rotation rotation;
+  };
+
+  // Returns the entry with the given index, counted from the first entry ever
+  // added.
+  Entry LoadEntry(uint64_t index) const;
+
+  std::array<SeqLock<Entry>, kCapacity> entries_;
+  // Index of the oldest entry kept since the last Clear().
+  std::atomic<uint64_t> begin_;
+  // Index following the newest entry.
+  std::atomic<uint64_t> end_;
+  // Timestamp of the newest entry. Only accessed by the writer.
+  int64_t latest_timestamp_;
+
+  RotationHistory(const RotationHistory&) = delete;
+  RotationHistory& operator=(const RotationHistory&) = delete;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_ROTATION_HISTORY_H_
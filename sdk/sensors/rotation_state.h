@@ -33,6 +33,10 @@ struct RotationState {
   // First derivative of the rotation. It is measured in radians per second
   // (rad/s).
   Vector3 sensor_from_start_rotation_velocity;
+
+  // Second derivative of the rotation, estimated from the first one. It is
+  // measured in radians per second squared (rad/s^2).
+  Vector3 sensor_from_start_rotation_acceleration;
 };
 
 }  // namespace cardboard
@@ -19,6 +19,8 @@
 #include <functional>
 #include <memory>
 
+#include "sensors/imu_trace.h"
+
 namespace cardboard {
 
 // Stream publisher that reads sensor data from the device sensors.
@@ -47,6 +49,10 @@ class SensorEventProducer {
   // running. This method blocks until the sensor capture thread is finished.
   void StopSensorPolling();
 
+  // Records every event into @p trace_writer. A nullptr stops recording. Safe
+  // to call while polling.
+  void SetTraceWriter(std::shared_ptr<ImuTraceWriter> trace_writer);
+
  private:
   // Internal function to start sensor polling with the assumption that the lock
   // has already been obtained. Not implemented for iOS.
@@ -70,6 +76,9 @@ class SensorEventProducer {
 
   // Callbacks to call when OnEvent() is called.
   const std::function<void(DataType)>* on_event_callback_;
+
+  // Optional trace recorder. Accessed atomically.
+  std::shared_ptr<ImuTraceWriter> trace_writer_;
 };
 
 }  // namespace cardboard
@@ -32,6 +32,9 @@ namespace {
 
 const double kFiniteDifferencingEpsilon = 1e-7;
 const double kEpsilon = 1e-15;
+// Below this sine of the angle between the predicted and the measured gravity
+// directions, the analytic Jacobian uses its small angle limit.
+const double kSmallAngleSine = 1e-6;
 // Default gyroscope frequency. This corresponds to 100 Hz.
 const double kDefaultGyroscopeTimestep_s = 0.01f;
 // Maximum time between gyroscope before we start limiting the integration.
@@ -55,6 +58,11 @@ const double kTimestepFilterCoeff = 0.95;
 // Minimum number of sample for timestep filtering.
 const int kTimestepFilterMinSamples = 10;
 
+// Bounds of the prediction parameters.
+const double kMaxPredictionHorizon_s = 0.2;
+const double kMinAccelerationTimeConstant_s = 0.001;
+const double kMaxAccelerationTimeConstant_s = 1.0;
+
 // Z direction in start space.
 const Vector3 kCanonicalZDirection(0.0, 0.0, 1.0);
 
@@ -83,7 +91,9 @@ Rotation GetRotationFromGyroscope(const Vector3& gyroscope_value,
 
   // When there is no rotation data return an identity rotation.
   if (velocity < kEpsilon) {
-    CARDBOARD_LOGI(
+    // This happens for every sample while the device is still.
+    CARDBOARD_LOGD_EVERY_N_SEC(
+        10.0,
         "PosePrediction::GetRotationFromGyroscope: Velocity really small, "
         "returning identity rotation.");
     return Rotation::Identity();
@@ -97,6 +107,18 @@ Rotation GetRotationFromGyroscope(const Vector3& gyroscope_value,
                                     -timestep_s * velocity);
 }
 
+// Returns the matrix [v]x such that [v]x * w = v x w.
+Matrix3x3 CrossProductMatrix(const Vector3& v) {
+  return Matrix3x3(0.0, -v[2], v[1], v[2], 0.0, -v[0], -v[1], v[0], 0.0);
+}
+
+// Returns the matrix a * b'.
+Matrix3x3 OuterProduct(const Vector3& a, const Vector3& b) {
+  return Matrix3x3(a[0] * b[0], a[0] * b[1], a[0] * b[2], a[1] * b[0],
+                   a[1] * b[1], a[1] * b[2], a[2] * b[0], a[2] * b[1],
+                   a[2] * b[2]);
+}
+
 // Returns the difference of @p timestamp_ns_a and @p timestamp_ns_b in
 // nanoseconds, and returns a floating point result in seconds.
 constexpr double ComputeTimeDifferenceInSeconds(int64_t timestamp_ns_a,
@@ -108,14 +130,46 @@ constexpr double ComputeTimeDifferenceInSeconds(int64_t timestamp_ns_a,
 
 SensorFusionEkf::SensorFusionEkf()
     : execute_reset_with_next_accelerometer_sample_(false),
-      gyroscope_bias_estimate_({0, 0, 0}) {
+      gyroscope_bias_estimate_({0, 0, 0}),
+      jacobian_mode_(JacobianMode::kAnalytic),
+      acceleration_estimator_(
+          PredictionParams().acceleration_time_constant_s) {
   ResetState();
+  PublishState();
 }
 
 void SensorFusionEkf::SetLowPassFilter(
     const int velocity_filter_cutoff_frequency) {
+  std::unique_lock<std::mutex> lock(mutex_);
   velocity_filter_.reset(new LowpassFilter(velocity_filter_cutoff_frequency));
   ResetState();
+  PublishState();
+}
+
+void SensorFusionEkf::SetMeasurementJacobianMode(JacobianMode mode) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  jacobian_mode_ = mode;
+}
+
+void SensorFusionEkf::SetPredictionParams(const PredictionParams& params) {
+  PredictionParams clamped = params;
+  clamped.max_horizon_s =
+      std::max(0.0, std::min(kMaxPredictionHorizon_s, params.max_horizon_s));
+  clamped.acceleration_time_constant_s =
+      std::max(kMinAccelerationTimeConstant_s,
+               std::min(kMaxAccelerationTimeConstant_s,
+                        params.acceleration_time_constant_s));
+  clamped.max_angular_acceleration =
+      std::max(0.0, params.max_angular_acceleration);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  acceleration_estimator_.SetTimeConstant(
+      clamped.acceleration_time_constant_s);
+  prediction_params_.Store(clamped);
+}
+
+SensorFusionEkf::PredictionParams SensorFusionEkf::GetPredictionParams() const {
+  return prediction_params_.Load();
 }
 
 void SensorFusionEkf::Reset() {
@@ -124,12 +178,18 @@ void SensorFusionEkf::Reset() {
 
 void SensorFusionEkf::RotateSensorSpaceToStartSpaceTransformation(
     const Rotation& rotation) {
+  std::unique_lock<std::mutex> lock(mutex_);
   current_state_.sensor_from_start_rotation *= rotation;
+  // The recorded rotations are relative to the previous start space.
+  rotation_history_.Clear();
+  PublishState();
 }
 
 void SensorFusionEkf::ResetState() {
   current_state_.sensor_from_start_rotation = Rotation::Identity();
   current_state_.sensor_from_start_rotation_velocity = Vector3::Zero();
+  current_state_.sensor_from_start_rotation_acceleration = Vector3::Zero();
+  rotation_history_.Clear();
 
   current_gyroscope_sensor_timestamp_ns_ = 0;
   current_accelerometer_sensor_timestamp_ns_ = 0;
@@ -161,35 +221,101 @@ void SensorFusionEkf::ResetState() {
   if (velocity_filter_ != nullptr) {
     velocity_filter_->Reset();
   }
+  acceleration_estimator_.Reset();
 }
 
+void SensorFusionEkf::PublishState() { published_state_.Store(current_state_); }
+
 // Here I am doing something wrong relative to time stamps. The state timestamps
 // always correspond to the gyrostamps because it would require additional
 // extrapolation if I wanted to do otherwise.
 RotationState SensorFusionEkf::GetLatestRotationState() const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  return current_state_;
+  return published_state_.Load();
 }
 
 Rotation SensorFusionEkf::PredictRotation(int64_t requested_timestamp) const {
-  std::unique_lock<std::mutex> lock(mutex_);
+  return PredictRotation(GetPredictionSnapshot(), requested_timestamp);
+}
+
+SensorFusionEkf::PredictionSnapshot SensorFusionEkf::GetPredictionSnapshot()
+    const {
+  return {published_state_.Load(), prediction_params_.Load()};
+}
+
+Rotation SensorFusionEkf::PredictRotation(const PredictionSnapshot& snapshot,
+                                          int64_t requested_timestamp) {
+  const RotationState& state = snapshot.state;
   // If the required timestamp is equal to zero, return the current pose.
   if (requested_timestamp == 0) {
-    return current_state_.sensor_from_start_rotation;
+    return state.sensor_from_start_rotation;
   }
 
   // Subtracting unsigned numbers is bad when the result is negative.
-  const double timestep_s = ComputeTimeDifferenceInSeconds(
-      requested_timestamp, current_state_.timestamp);
+  const double timestep_s =
+      ComputeTimeDifferenceInSeconds(requested_timestamp, state.timestamp);
+
+  Vector3 velocity = state.sensor_from_start_rotation_velocity;
+  const PredictionParams& params = snapshot.params;
+  if (params.model == PredictionModel::kConstantAcceleration &&
+      timestep_s > 0.0) {
+    Vector3 acceleration = state.sensor_from_start_rotation_acceleration;
+    const double acceleration_norm = Length(acceleration);
+    if (acceleration_norm > params.max_angular_acceleration) {
+      acceleration *= params.max_angular_acceleration / acceleration_norm;
+    }
+    // The acceleration is applied during the first accelerated_s seconds, so
+    // the rotation angle is w * t + a * t_a * (t - t_a / 2). It is integrated
+    // as the mean velocity over the whole timestep.
+    const double accelerated_s = std::min(timestep_s, params.max_horizon_s);
+    velocity += acceleration *
+                (accelerated_s * (timestep_s - accelerated_s / 2) / timestep_s);
+  }
 
-  const Rotation update = GetRotationFromGyroscope(
-      current_state_.sensor_from_start_rotation_velocity, timestep_s);
-  return update * current_state_.sensor_from_start_rotation;
+  const Rotation update = GetRotationFromGyroscope(velocity, timestep_s);
+  return update * state.sensor_from_start_rotation;
+}
+
+bool SensorFusionEkf::GetRotationAt(int64_t timestamp,
+                                    Rotation* rotation) const {
+  if (rotation_history_.GetRotation(timestamp, rotation)) {
+    return true;
+  }
+  // Timestamps after the latest sample are predicted.
+  if (is_aligned_with_gravity_ &&
+      timestamp >= published_state_.Load().timestamp) {
+    *rotation = PredictRotation(timestamp);
+    return true;
+  }
+  return false;
 }
 
 void SensorFusionEkf::ProcessGyroscopeSample(const GyroscopeData& sample) {
   std::unique_lock<std::mutex> lock(mutex_);
+  ProcessGyroscopeSampleLocked(sample);
+  PublishState();
+}
+
+void SensorFusionEkf::ProcessAccelerometerSample(
+    const AccelerometerData& sample) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ProcessAccelerometerSampleLocked(sample);
+  PublishState();
+}
+
+void SensorFusionEkf::ProcessSamples(const std::vector<ImuSample>& samples) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const ImuSample& sample : samples) {
+    if (sample.type == ImuSample::Type::kAccelerometer) {
+      ProcessAccelerometerSampleLocked(sample.accelerometer);
+    } else {
+      ProcessGyroscopeSampleLocked(sample.gyroscope);
+    }
+  }
+  PublishState();
+}
 
+void SensorFusionEkf::ProcessGyroscopeSampleLocked(
+    const GyroscopeData& sample) {
   // Don't accept gyroscope sample when waiting for a reset.
   if (execute_reset_with_next_accelerometer_sample_) {
     return;
@@ -208,6 +334,8 @@ void SensorFusionEkf::ProcessGyroscopeSample(const GyroscopeData& sample) {
                                      current_gyroscope_sensor_timestamp_ns_))
             .count();
     if (current_timestep_s > kMaximumGyroscopeSampleDelay_s) {
+      CARDBOARD_LOG_TO_RING_BUFFER("Gyroscope sample delayed by %.1f ms.",
+                                   current_timestep_s * 1000.0);
       if (is_gyroscope_filter_valid_) {
         // Replaces the delta timestamp by the filtered estimates of the delta
         // time.
@@ -265,6 +393,17 @@ void SensorFusionEkf::ProcessGyroscopeSample(const GyroscopeData& sample) {
         sample.data[1] - gyroscope_bias_estimate_[1],
         sample.data[2] - gyroscope_bias_estimate_[2]);
   }
+
+  acceleration_estimator_.AddSample(
+      current_state_.sensor_from_start_rotation_velocity,
+      static_cast<int64_t>(current_gyroscope_sensor_timestamp_ns_));
+  current_state_.sensor_from_start_rotation_acceleration =
+      acceleration_estimator_.GetAcceleration();
+
+  if (is_aligned_with_gravity_) {
+    rotation_history_.Add(current_state_.timestamp,
+                          current_state_.sensor_from_start_rotation);
+  }
 }
 
 Vector3 SensorFusionEkf::ComputeInnovation(const Rotation& rotation_in) {
@@ -279,6 +418,65 @@ Vector3 SensorFusionEkf::ComputeInnovation(const Rotation& rotation_in) {
 }
 
 void SensorFusionEkf::ComputeMeasurementJacobian() {
+  if (jacobian_mode_ == JacobianMode::kNumeric) {
+    ComputeNumericMeasurementJacobian();
+  } else {
+    ComputeAnalyticMeasurementJacobian();
+  }
+}
+
+// The innovation is nu = theta * n, the axis angle rotation that takes the
+// predicted down direction p = R * z into the measured one a. With
+// c = p x a / |a|, s = |c| = sin(theta), d = p . a / |a| = cos(theta) and
+// n = c / s:
+//
+//   dnu/dp = n * (d * n' * A - s * a' / |a|) + (theta / s) * (I - n * n') * A
+//
+// where A = -[a / |a|]x. The state update perturbs the rotation as
+// R <- exp(delta) * R, hence dp = -[p]x * delta, and the measurement Jacobian
+// H = -dnu/ddelta = dnu/dp * [p]x. When theta tends to zero, dnu/dp tends to A.
+void SensorFusionEkf::ComputeAnalyticMeasurementJacobian() {
+  const double measurement_norm = Length(accelerometer_measurement_);
+  if (measurement_norm < kEpsilon) {
+    accelerometer_measurement_jacobian_ = Matrix3x3::Zero();
+    return;
+  }
+
+  const Vector3 predicted_down_direction =
+      current_state_.sensor_from_start_rotation * kCanonicalZDirection;
+  const Vector3 measured_down_direction =
+      accelerometer_measurement_ / measurement_norm;
+
+  const Vector3 cross =
+      Cross(predicted_down_direction, measured_down_direction);
+  const double sine = Length(cross);
+  const double cosine = Dot(predicted_down_direction, measured_down_direction);
+  const Matrix3x3 a_cross = -CrossProductMatrix(measured_down_direction);
+
+  Matrix3x3 innovation_from_down_direction;
+  if (sine < kSmallAngleSine) {
+    if (cosine < 0.0) {
+      // The innovation axis is arbitrary when the directions are opposite.
+      ComputeNumericMeasurementJacobian();
+      return;
+    }
+    innovation_from_down_direction = a_cross;
+  } else {
+    const Vector3 axis = cross / sine;
+    const double angle = std::atan2(sine, cosine);
+    const Matrix3x3 axis_axis = OuterProduct(axis, axis);
+    innovation_from_down_direction =
+        cosine * axis_axis * a_cross -
+        sine * OuterProduct(axis, measured_down_direction) +
+        (angle / sine) * (Matrix3x3::Identity() - axis_axis) * a_cross;
+  }
+
+  accelerometer_measurement_jacobian_ =
+      innovation_from_down_direction *
+      CrossProductMatrix(predicted_down_direction);
+}
+
+void SensorFusionEkf::ComputeNumericMeasurementJacobian() {
   for (int dof = 0; dof < 3; dof++) {
     Vector3 delta = Vector3::Zero();
     delta[dof] = kFiniteDifferencingEpsilon;
@@ -295,10 +493,8 @@ void SensorFusionEkf::ComputeMeasurementJacobian() {
   }
 }
 
-void SensorFusionEkf::ProcessAccelerometerSample(
+void SensorFusionEkf::ProcessAccelerometerSampleLocked(
     const AccelerometerData& sample) {
-  std::unique_lock<std::mutex> lock(mutex_);
-
   // Discard outdated samples.
   if (current_accelerometer_sensor_timestamp_ns_ >=
       sample.sensor_timestamp_ns) {
@@ -21,14 +21,19 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <vector>
 
 #include "sensors/accelerometer_data.h"
+#include "sensors/angular_acceleration_estimator.h"
 #include "sensors/gyroscope_bias_estimator.h"
 #include "sensors/gyroscope_data.h"
+#include "sensors/imu_sample.h"
 #include "sensors/lowpass_filter.h"
+#include "sensors/rotation_history.h"
 #include "sensors/rotation_state.h"
 #include "util/matrix_3x3.h"
 #include "util/rotation.h"
+#include "util/seqlock.h"
 #include "util/vector.h"
 
 namespace cardboard {
@@ -42,6 +47,44 @@ namespace cardboard {
 // good introduction: https://en.wikipedia.org/wiki/Kalman_filter
 class SensorFusionEkf {
  public:
+  // Methods to compute the Jacobian of the accelerometer measurement.
+  enum class JacobianMode {
+    // Closed form derivative of the gravity direction measurement model.
+    kAnalytic,
+    // Finite differences of the innovation, kept as a reference.
+    kNumeric,
+  };
+
+  // Models used by PredictRotation() to extrapolate the rotation.
+  enum class PredictionModel {
+    // Extrapolates the latest angular velocity.
+    kConstantVelocity,
+    // Extrapolates the latest angular velocity and angular acceleration.
+    kConstantAcceleration,
+  };
+
+  // Parameters of PredictRotation().
+  struct PredictionParams {
+    PredictionModel model = PredictionModel::kConstantVelocity;
+    // With kConstantAcceleration, the angular acceleration is applied during
+    // at most this many seconds of the extrapolation. Past it, the rotation
+    // is extrapolated with the velocity reached at that point.
+    double max_horizon_s = 0.06;
+    // Time constant in seconds of the low pass filter applied to the angular
+    // acceleration estimate.
+    double acceleration_time_constant_s = 0.03;
+    // Norm in radians per second squared above which the angular acceleration
+    // estimate is clamped.
+    double max_angular_acceleration = 40.0;
+  };
+
+  // State and parameters used by PredictRotation(), captured together so that
+  // several rotations can be predicted from the same sample.
+  struct PredictionSnapshot {
+    RotationState state;
+    PredictionParams params;
+  };
+
   SensorFusionEkf();
 
   // Resets the state of the sensor fusion. It sets the velocity for
@@ -51,13 +94,16 @@ class SensorFusionEkf {
   void Reset();
 
   // Gets the RotationState representing the latest rotation and angular
-  // velocity at a particular timestamp as estimated by SensorFusion.
+  // velocity at a particular timestamp as estimated by SensorFusion. It never
+  // waits for a sample being processed, so it is safe to call from the render
+  // thread.
   RotationState GetLatestRotationState() const;
 
   // Gets a predicted rotation for a given time in the future (e.g. rendering
-  // time) based on a linear prediction model (this EKF implementation). It uses
-  // the system current rotation state (position, velocity, etc.) from the past
-  // to extrapolate a position in the future.
+  // time) based on the prediction model set with SetPredictionParams(). It
+  // uses the system current rotation state (position, velocity, etc.) from
+  // the past to extrapolate a position in the future. Like
+  // GetLatestRotationState(), it never waits for a sample being processed.
   //
   // @param requested_timestamp time at which you want the rotation.
   // @return If the requested timestamp is equal to zero, it returns the current
@@ -65,6 +111,29 @@ class SensorFusionEkf {
   //         Space.
   Rotation PredictRotation(int64_t requested_timestamp) const;
 
+  // Gets the state and parameters that PredictRotation() would use now. Like
+  // GetLatestRotationState(), it never waits for a sample being processed.
+  PredictionSnapshot GetPredictionSnapshot() const;
+
+  // Gets a predicted rotation like PredictRotation(), but from a snapshot
+  // obtained with GetPredictionSnapshot().
+  static Rotation PredictRotation(const PredictionSnapshot& snapshot,
+                                  int64_t requested_timestamp);
+
+  // Gets the rotation at a given time. Past timestamps are interpolated
+  // between the rotations fused after each of the last
+  // RotationHistory::kQueryableCount gyroscope samples, and timestamps after
+  // the latest sample are predicted like in PredictRotation(). The history
+  // restarts on Reset() and on RotateSensorSpaceToStartSpaceTransformation().
+  // Like GetLatestRotationState(), it never waits for a sample being
+  // processed.
+  //
+  // @param timestamp time at which you want the rotation.
+  // @param[out] rotation rotation from Start to Sensor Space.
+  // @return false if @p timestamp is older than the history, or if the sensor
+  //         fusion is not aligned with gravity yet.
+  bool GetRotationAt(int64_t timestamp, Rotation* rotation) const;
+
   // Processes one gyroscope sample event. This updates the rotation of the
   // system and the prediction model. The gyroscope data is assumed to be in
   // axis angle form. Angle = ||v|| and Axis = v / ||v||, with
@@ -80,6 +149,13 @@ class SensorFusionEkf {
   // @param sample accelerometer sample data.
   void ProcessAccelerometerSample(const AccelerometerData& sample);
 
+  // Processes a batch of samples of both sensors in the given order, which
+  // should be the order of their timestamps. The state is updated under a
+  // single lock acquisition and published once for the whole batch.
+  //
+  // @param samples accelerometer and gyroscope samples.
+  void ProcessSamples(const std::vector<ImuSample>& samples);
+
   // Rotates the current transformation from Sensor Space to Start Space.
   //
   // @details The current state space rotation is post-multiplied by
@@ -97,6 +173,17 @@ class SensorFusionEkf {
   // head tracker.
   void SetLowPassFilter(int velocity_filter_cutoff_frequency);
 
+  // Sets how the accelerometer measurement Jacobian is computed. The default
+  // is JacobianMode::kAnalytic.
+  void SetMeasurementJacobianMode(JacobianMode mode);
+
+  // Sets the model and the tuning used by PredictRotation(). Values out of
+  // range are clamped.
+  void SetPredictionParams(const PredictionParams& params);
+
+  // Returns the parameters used by PredictRotation().
+  PredictionParams GetPredictionParams() const;
+
  private:
   // Estimates the average timestep between gyroscope event.
   void FilterGyroscopeTimestep(double gyroscope_timestep);
@@ -110,10 +197,18 @@ class SensorFusionEkf {
   // be set prior to calling this function.
   Vector3 ComputeInnovation(const Rotation& rotation_in);
 
-  // This computes the measurement_jacobian_ via numerical differentiation based
-  // on the current value of sensor_from_start_rotation_.
+  // This computes the measurement_jacobian_ based on the current value of
+  // sensor_from_start_rotation_, as selected by jacobian_mode_.
   void ComputeMeasurementJacobian();
 
+  // Computes the measurement_jacobian_ in closed form. It requires
+  // innovation_ to be computed for the current state.
+  void ComputeAnalyticMeasurementJacobian();
+
+  // Computes the measurement_jacobian_ via numerical differentiation. It
+  // requires innovation_ to be computed for the current state.
+  void ComputeNumericMeasurementJacobian();
+
   // Updates the accelerometer covariance matrix.
   //
   // This looks at the norm of recent accelerometer readings. If it has changed
@@ -121,13 +216,27 @@ class SensorFusionEkf {
   // just gravity, and so the down vector information gravity signal is noisier.
   void UpdateMeasurementCovariance();
 
+  // Implementations of ProcessGyroscopeSample() and
+  // ProcessAccelerometerSample(). They do not publish the updated state. Lock
+  // should be acquired outside of them.
+  void ProcessGyroscopeSampleLocked(const GyroscopeData& sample);
+  void ProcessAccelerometerSampleLocked(const AccelerometerData& sample);
+
   // Reset all internal states. This is not thread safe. Lock should be acquired
   // outside of it. This function is called in ProcessAccelerometerSample.
   void ResetState();
 
+  // Makes current_state_ visible to GetLatestRotationState() and
+  // PredictRotation(). Lock should be acquired outside of it.
+  void PublishState();
+
   // Current transformation from Sensor Space to Start Space.
   // x_sensor = sensor_from_start_rotation_ * x_start;
+  // Only accessed with mutex_ held.
   RotationState current_state_;
+  // Copy of current_state_ as of the last processed sample, for lock-free
+  // readers. Stores are serialized by mutex_.
+  SeqLock<RotationState> published_state_;
 
   // Filtering of the gyroscope timestep started?
   bool is_timestep_filter_initialized_;
@@ -192,6 +301,25 @@ class SensorFusionEkf {
   // Filter to smooth velocity vector
   std::unique_ptr<LowpassFilter> velocity_filter_;
 
+  // Method used by ComputeMeasurementJacobian().
+  JacobianMode jacobian_mode_;
+
+  // Angular acceleration estimate for the kConstantAcceleration prediction
+  // model.
+  AngularAccelerationEstimator acceleration_estimator_;
+
+  // Rotations fused after each gyroscope sample, for GetRotationAt(). Writes
+  // are serialized by mutex_.
+  RotationHistory rotation_history_;
+
+  // Parameters of PredictRotation(), for lock-free readers. Stores are
+  // serialized by mutex_.
+  SeqLock<PredictionParams> prediction_params_;
+
+  // Compares the analytic and numeric measurement Jacobians in
+  // sensors/testing/sensor_fusion_ekf_test.cc.
+  friend class SensorFusionEkfTestPeer;
+
   SensorFusionEkf(const SensorFusionEkf&) = delete;
   SensorFusionEkf& operator=(const SensorFusionEkf&) = delete;
 };
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sensors/synthetic_imu_source.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "util/rotation.h"
+#include "util/vectorutils.h"
+
+namespace cardboard {
+
+namespace {
+
+// Standard gravity in m/s^2.
+constexpr double kGravity = 9.80665;
+
+int64_t GetMonotonicTimestampNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+SyntheticImuSource::SyntheticImuSource(int64_t accelerometer_period_ns,
+                                       int64_t gyroscope_period_ns,
+                                       const Vector3& angular_velocity)
+    : accelerometer_period_ns_(accelerometer_period_ns),
+      gyroscope_period_ns_(gyroscope_period_ns),
+      angular_velocity_(angular_velocity),
+      start_timestamp_ns_(0),
+      accelerometer_sample_count_(0),
+      gyroscope_sample_count_(0) {}
+
+bool SyntheticImuSource::Start() {
+  start_timestamp_ns_ = GetMonotonicTimestampNs();
+  accelerometer_sample_count_ = 0;
+  gyroscope_sample_count_ = 0;
+  return accelerometer_period_ns_ > 0 && gyroscope_period_ns_ > 0;
+}
+
+void SyntheticImuSource::PollForSensorData(
+    int timeout_ms, std::vector<AccelerometerData>* accelerometer_samples,
+    std::vector<GyroscopeData>* gyroscope_samples) {
+  accelerometer_samples->clear();
+  gyroscope_samples->clear();
+
+  // Sleeps until the next sample is due, or until the timeout expires.
+  const int64_t next_sample_ns =
+      start_timestamp_ns_ +
+      std::min(accelerometer_sample_count_ * accelerometer_period_ns_,
+               gyroscope_sample_count_ * gyroscope_period_ns_);
+  int64_t wake_up_ns = next_sample_ns;
+  if (timeout_ms >= 0) {
+    wake_up_ns = std::min(wake_up_ns, GetMonotonicTimestampNs() +
+                                          int64_t{timeout_ms} * 1000000);
+  }
+  const int64_t sleep_ns = wake_up_ns - GetMonotonicTimestampNs();
+  if (sleep_ns > 0) {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
+  }
+
+  const int64_t now_ns = GetMonotonicTimestampNs();
+  while (start_timestamp_ns_ +
+             accelerometer_sample_count_ * accelerometer_period_ns_ <=
+         now_ns) {
+    const int64_t elapsed_ns =
+        accelerometer_sample_count_ * accelerometer_period_ns_;
+    AccelerometerData sample;
+    sample.sensor_timestamp_ns = start_timestamp_ns_ + elapsed_ns;
+    sample.system_timestamp = sample.sensor_timestamp_ns;
+    sample.data = GetAccelerometerValue(elapsed_ns);
+    accelerometer_samples->push_back(sample);
+    ++accelerometer_sample_count_;
+  }
+  while (start_timestamp_ns_ + gyroscope_sample_count_ * gyroscope_period_ns_ <=
+         now_ns) {
+    GyroscopeData sample;
+    sample.sensor_timestamp_ns =
+        start_timestamp_ns_ + gyroscope_sample_count_ * gyroscope_period_ns_;
+    sample.system_timestamp = sample.sensor_timestamp_ns;
+    sample.data = angular_velocity_;
+    gyroscope_samples->push_back(sample);
+    ++gyroscope_sample_count_;
+  }
+}
+
+void SyntheticImuSource::Stop() {}
+
+Vector3 SyntheticImuSource::GetAccelerometerValue(int64_t elapsed_ns) const {
+  const double velocity = Length(angular_velocity_);
+  // The gyroscope measures the start from sensor rotation rate, so the sensor
+  // from start rotation turns the opposite way.
+  const Rotation sensor_from_start =
+      velocity > 0.0
+          ? Rotation::FromAxisAndAngle(angular_velocity_ / velocity,
+                                       -velocity * elapsed_ns * 1e-9)
+          : Rotation::Identity();
+  return sensor_from_start * Vector3(0.0, 0.0, kGravity);
+}
+
+}  // namespace cardboard
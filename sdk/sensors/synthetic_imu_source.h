@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_SENSORS_SYNTHETIC_IMU_SOURCE_H_
+#define CARDBOARD_SDK_SENSORS_SYNTHETIC_IMU_SOURCE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "sensors/accelerometer_data.h"
+#include "sensors/gyroscope_data.h"
+#include "sensors/imu_sample_source.h"
+#include "util/vector.h"
+
+namespace cardboard {
+
+// ImuSampleSource that generates, in real time, the samples of a device
+// spinning at a constant angular velocity from an upright start pose. It does
+// not depend on any platform sensor framework, so the sensor pipeline can be
+// exercised on any host.
+class SyntheticImuSource : public ImuSampleSource {
+ public:
+  // @param accelerometer_period_ns time between accelerometer samples.
+  // @param gyroscope_period_ns time between gyroscope samples.
+  // @param angular_velocity rate of rotation around the x,y,z axes of the
+  //        sensor in rad/s.
+  SyntheticImuSource(int64_t accelerometer_period_ns,
+                     int64_t gyroscope_period_ns,
+                     const Vector3& angular_velocity);
+
+  bool Start() override;
+
+  void PollForSensorData(int timeout_ms,
+                         std::vector<AccelerometerData>* accelerometer_samples,
+                         std::vector<GyroscopeData>* gyroscope_samples) override;
+
+  void Stop() override;
+
+  // Returns the expected accelerometer reading @p elapsed_ns after start.
+  Vector3 GetAccelerometerValue(int64_t elapsed_ns) const;
+
+ private:
+  const int64_t accelerometer_period_ns_;
+  const int64_t gyroscope_period_ns_;
+  const Vector3 angular_velocity_;
+
+  // Monotonic clock time when Start() was called.
+  int64_t start_timestamp_ns_;
+  // Number of samples generated so far for each sensor.
+  int64_t accelerometer_sample_count_;
+  int64_t gyroscope_sample_count_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_SENSORS_SYNTHETIC_IMU_SOURCE_H_
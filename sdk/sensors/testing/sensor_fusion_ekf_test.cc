@@ -0,0 +1,120 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// Checks the closed form accelerometer measurement Jacobian of
+// SensorFusionEkf against its finite differences reference, over random
+// orientations and gravity measurements. Returns nonzero when a check fails.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "sensors/sensor_fusion_ekf.h"
+#include "util/matrix_3x3.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+
+namespace cardboard {
+
+// Evaluates the private measurement Jacobian of a SensorFusionEkf.
+class SensorFusionEkfTestPeer {
+ public:
+  // Returns the Jacobian for the state @p sensor_from_start_rotation and the
+  // accelerometer measurement @p measurement, computed as per @p mode.
+  static Matrix3x3 ComputeJacobian(SensorFusionEkf::JacobianMode mode,
+                                   const Rotation& sensor_from_start_rotation,
+                                   const Vector3& measurement) {
+    SensorFusionEkf sensor_fusion;
+    sensor_fusion.SetMeasurementJacobianMode(mode);
+    sensor_fusion.current_state_.sensor_from_start_rotation =
+        sensor_from_start_rotation;
+    sensor_fusion.accelerometer_measurement_ = measurement;
+    sensor_fusion.innovation_ =
+        sensor_fusion.ComputeInnovation(sensor_from_start_rotation);
+    sensor_fusion.ComputeMeasurementJacobian();
+    return sensor_fusion.accelerometer_measurement_jacobian_;
+  }
+};
+
+namespace {
+
+constexpr int kNumSamples = 10000;
+constexpr double kGravity = 9.81;
+// Largest difference allowed between the analytic and numeric Jacobians,
+// relative to the largest element of the numeric one. It bounds the
+// truncation and round-off errors of the forward differences, which stay
+// below 1e-5 on these samples.
+constexpr double kTolerance = 1e-4;
+
+int failures = 0;
+
+Vector3 RandomDirection(std::mt19937* generator) {
+  std::normal_distribution<double> normal;
+  Vector3 direction;
+  do {
+    direction.Set(normal(*generator), normal(*generator), normal(*generator));
+  } while (Length(direction) < 1e-3);
+  return direction / Length(direction);
+}
+
+double MaxAbs(const Matrix3x3& m) {
+  double max_abs = 0.0;
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col) {
+      max_abs = std::max(max_abs, std::abs(m(row, col)));
+    }
+  }
+  return max_abs;
+}
+
+void CheckAnalyticJacobian() {
+  std::mt19937 generator(2021);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::uniform_real_distribution<double> norm(0.5 * kGravity, 1.5 * kGravity);
+  double max_error = 0.0;
+  for (int i = 0; i < kNumSamples; ++i) {
+    const Rotation rotation =
+        Rotation::FromAxisAndAngle(RandomDirection(&generator),
+                                   angle(generator));
+    const Vector3 measurement = RandomDirection(&generator) * norm(generator);
+
+    const Matrix3x3 analytic = SensorFusionEkfTestPeer::ComputeJacobian(
+        SensorFusionEkf::JacobianMode::kAnalytic, rotation, measurement);
+    const Matrix3x3 numeric = SensorFusionEkfTestPeer::ComputeJacobian(
+        SensorFusionEkf::JacobianMode::kNumeric, rotation, measurement);
+    const double error =
+        MaxAbs(analytic - numeric) / std::max(MaxAbs(numeric), 1.0);
+    max_error = std::max(max_error, error);
+    if (!(error <= kTolerance)) {
+      std::fprintf(stderr,
+                   "FAILED sample %d: relative Jacobian error is %g, "
+                   "expected at most %g\n",
+                   i, error, kTolerance);
+      ++failures;
+    }
+  }
+  std::printf("Largest relative Jacobian error: %g\n", max_error);
+}
+
+}  // namespace
+}  // namespace cardboard
+
+int main() {
+  cardboard::CheckAnalyticJacobian();
+  if (cardboard::failures == 0) {
+    std::printf("PASSED\n");
+  }
+  return cardboard::failures == 0 ? 0 : 1;
+}
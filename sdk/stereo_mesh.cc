@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "stereo_mesh.h"
+
+#include <cstddef>
+
+#include "compact_mesh.h"
+
+namespace cardboard {
+
+namespace {
+
+// Tells whether all the vertices of a compact mesh lie on the half of the
+// viewport of @p eye, where the per eye scissor would keep them.
+bool IsOnEyeHalf(const std::vector<int16_t>& vertices, CardboardEye eye) {
+  for (size_t i = 0; i < vertices.size(); i += 4) {
+    if ((eye == kLeft && vertices[i] > 0) ||
+        (eye == kRight && vertices[i] < 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+StereoMesh::StereoMesh() : position_scale_{1.0f, 1.0f} {}
+
+void StereoMesh::SetEyeMesh(CardboardEye eye,
+                            const CardboardCompactMesh& mesh) {
+  eye_vertices_[eye].assign(mesh.vertices, mesh.vertices + mesh.n_vertices * 4);
+  eye_indices_[eye].assign(mesh.indices, mesh.indices + mesh.n_indices);
+  position_scale_[eye] = mesh.position_scale;
+  Pack();
+}
+
+void StereoMesh::Pack() {
+  vertices_.clear();
+  indices_.clear();
+
+  const size_t left_vertex_count = eye_vertices_[kLeft].size() / 4;
+  const size_t right_vertex_count = eye_vertices_[kRight].size() / 4;
+  if (eye_indices_[kLeft].empty() || eye_indices_[kRight].empty() ||
+      left_vertex_count + right_vertex_count > CompactMesh::kMaxVertices ||
+      !IsOnEyeHalf(eye_vertices_[kLeft], kLeft) ||
+      !IsOnEyeHalf(eye_vertices_[kRight], kRight)) {
+    return;
+  }
+
+  vertices_.reserve((left_vertex_count + right_vertex_count) *
+                    kComponentsPerVertex);
+  for (CardboardEye eye : {kLeft, kRight}) {
+    const int16_t eye_component =
+        eye == kLeft ? 0 : static_cast<int16_t>(CompactMesh::kNormalizedOne);
+    const std::vector<int16_t>& eye_vertices = eye_vertices_[eye];
+    for (size_t i = 0; i < eye_vertices.size(); i += 4) {
+      vertices_.insert(vertices_.end(),
+                       {eye_vertices[i + 0], eye_vertices[i + 1],
+                        eye_vertices[i + 2], eye_vertices[i + 3],
+                        eye_component, 0});
+    }
+  }
+
+  // Repeating the last index of the left strip and the first index of the
+  // right strip only adds degenerate triangles, which produce no fragments.
+  // Face culling is disabled by the renderers, so the winding order of the
+  // right strip does not matter.
+  const std::vector<uint16_t>& left_indices = eye_indices_[kLeft];
+  const std::vector<uint16_t>& right_indices = eye_indices_[kRight];
+  const uint16_t right_offset = static_cast<uint16_t>(left_vertex_count);
+  indices_.reserve(left_indices.size() + right_indices.size() + 2);
+  indices_.insert(indices_.end(), left_indices.begin(), left_indices.end());
+  indices_.push_back(left_indices.back());
+  indices_.push_back(right_indices.front() + right_offset);
+  for (uint16_t index : right_indices) {
+    indices_.push_back(index + right_offset);
+  }
+}
+
+}  // namespace cardboard
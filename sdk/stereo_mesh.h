@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_STEREO_MESH_H_
+#define CARDBOARD_SDK_STEREO_MESH_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "include/cardboard.h"
+
+namespace cardboard {
+
+// Packs the compact distortion meshes of both eyes into a single vertex and
+// index buffer, so that the distortion pass is a single draw call.
+//
+// Each vertex has the x, y, u and v components of CardboardCompactMesh,
+// followed by an eye component, 0 for the left eye and
+// CompactMesh::kNormalizedOne for the right eye, and by a padding component
+// that keeps vertices 4-byte aligned. Positions keep the position scale of
+// their eye. The triangle strips of both eyes are joined with degenerate
+// triangles.
+class StereoMesh {
+ public:
+  // Number of 16-bit components per vertex.
+  static constexpr int kComponentsPerVertex = 6;
+  // Offset in bytes of the eye component of a vertex.
+  static constexpr int kEyeOffset = 4 * sizeof(int16_t);
+
+  StereoMesh();
+
+  // Copies the mesh of @p eye and packs both meshes again.
+  void SetEyeMesh(CardboardEye eye, const CardboardCompactMesh& mesh);
+
+  // Tells whether the meshes can be drawn with a single call. It is false
+  // until both meshes are set, when a mesh crosses the vertical center line of
+  // the viewport, so that the eyes must be drawn with their own scissor, or
+  // when the meshes have more vertices than 16-bit indices can address.
+  bool CanDrawInOnePass() const { return !indices_.empty(); }
+
+  const std::vector<int16_t>& GetVertices() const { return vertices_; }
+  const std::vector<uint16_t>& GetIndices() const { return indices_; }
+  float GetPositionScale(CardboardEye eye) const {
+    return position_scale_[eye];
+  }
+
+ private:
+  void Pack();
+
+  std::array<std::vector<int16_t>, 2> eye_vertices_;
+  std::array<std::vector<uint16_t>, 2> eye_indices_;
+  std::array<float, 2> position_scale_;
+
+  std::vector<int16_t> vertices_;
+  std::vector<uint16_t> indices_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_STEREO_MESH_H_
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// Checks ComputeReprojectionMatrix() and ReprojectTextureCoordinates() on the
+// texture coordinates of the Cardboard v1 distortion meshes, against the
+// exact rotation of the view direction of each vertex. Returns nonzero when a
+// check fails.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "include/cardboard.h"
+#include "lens_distortion.h"
+#include "qrcode/cardboard_v1/cardboard_v1.h"
+#include "reprojection.h"
+#include "util/rotation.h"
+#include "util/vector.h"
+
+namespace cardboard {
+namespace {
+
+constexpr int kDisplayWidth = 2400;
+constexpr int kDisplayHeight = 1080;
+constexpr int kNumOrientations = 100;
+// Largest head rotation between the render and display orientations, in
+// radians. It is about the motion of a fast head turn during a few frames.
+constexpr float kMaxDeltaAngle = 0.2f;
+// Largest difference allowed between the reprojected texture coordinates and
+// the exact ones. It is the float round-off error of the homography.
+constexpr float kTolerance = 1e-4f;
+// Largest difference allowed from the identity when the orientations are
+// equal.
+constexpr float kIdentityTolerance = 1e-6f;
+
+int failures = 0;
+
+void ExpectNear(float expected, float actual, float tolerance, const char* what,
+                const char* name) {
+  if (!(std::abs(expected - actual) <= tolerance)) {
+    std::fprintf(stderr, "FAILED %s: %s is %g, expected %g\n", name, what,
+                 actual, expected);
+    ++failures;
+  }
+}
+
+Vector3 RandomDirection(std::mt19937* generator) {
+  std::normal_distribution<double> normal;
+  Vector3 direction;
+  do {
+    direction.Set(normal(*generator), normal(*generator), normal(*generator));
+  } while (Length(direction) < 1e-3);
+  return direction / Length(direction);
+}
+
+void SetOrientation(const Rotation& rotation, float orientation[4]) {
+  const Vector4 quaternion = rotation.GetQuaternion();
+  for (int i = 0; i < 4; i++) {
+    orientation[i] = static_cast<float>(quaternion[i]);
+  }
+}
+
+// Returns the texture coordinates of the eye texture rendered with
+// @p render_orientation that are seen in the direction of @p uv at
+// @p display_orientation, by rotating the view direction.
+std::array<double, 2> ExactReprojection(const Rotation& render_orientation,
+                                        const Rotation& display_orientation,
+                                        const float field_of_view[4],
+                                        float u, float v) {
+  const double tan_left = std::tan(field_of_view[0]);
+  const double tan_bottom = std::tan(field_of_view[2]);
+  const double width = tan_left + std::tan(field_of_view[1]);
+  const double height = tan_bottom + std::tan(field_of_view[3]);
+  const Vector3 display_direction(u * width - tan_left,
+                                  v * height - tan_bottom, -1.0);
+  const Vector3 render_direction =
+      render_orientation * (-display_orientation * display_direction);
+  return {(render_direction[0] / -render_direction[2] + tan_left) / width,
+          (render_direction[1] / -render_direction[2] + tan_bottom) / height};
+}
+
+void CheckReprojection() {
+  const std::vector<uint8_t> device_params =
+      qrcode::getCardboardV1DeviceParams();
+  const LensDistortion lens_distortion(
+      device_params.data(), static_cast<int>(device_params.size()),
+      kDisplayWidth, kDisplayHeight);
+
+  std::mt19937 generator(2021);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::uniform_real_distribution<double> delta_angle(-kMaxDeltaAngle,
+                                                     kMaxDeltaAngle);
+  float max_error = 0.0f;
+  for (int i = 0; i < kNumOrientations; i++) {
+    const Rotation render_orientation = Rotation::FromAxisAndAngle(
+        RandomDirection(&generator), angle(generator));
+    const Rotation display_orientation =
+        Rotation::FromAxisAndAngle(RandomDirection(&generator),
+                                   delta_angle(generator)) *
+        render_orientation;
+    CardboardReprojection reprojection;
+    SetOrientation(render_orientation, reprojection.render_orientation);
+    SetOrientation(display_orientation, reprojection.display_orientation);
+
+    for (CardboardEye eye : {kLeft, kRight}) {
+      lens_distortion.GetEyeFieldOfView(eye, reprojection.field_of_view[eye]);
+      const CardboardMesh mesh = lens_distortion.GetDistortionMesh(eye);
+      // Warps a copy in place, which ReprojectTextureCoordinates() allows.
+      std::vector<float> uvs(mesh.uvs, mesh.uvs + 2 * mesh.n_vertices);
+      ReprojectTextureCoordinates(ComputeReprojectionMatrix(reprojection, eye),
+                                  uvs.data(), mesh.n_vertices, uvs.data());
+
+      for (int vertex = 0; vertex < mesh.n_vertices; vertex++) {
+        const std::array<double, 2> expected = ExactReprojection(
+            render_orientation, display_orientation,
+            reprojection.field_of_view[eye], mesh.uvs[2 * vertex],
+            mesh.uvs[2 * vertex + 1]);
+        for (int coordinate = 0; coordinate < 2; coordinate++) {
+          const float actual = uvs[2 * vertex + coordinate];
+          max_error = std::max(
+              max_error,
+              std::abs(static_cast<float>(expected[coordinate]) - actual));
+          ExpectNear(static_cast<float>(expected[coordinate]), actual,
+                     kTolerance, coordinate == 0 ? "u" : "v",
+                     "reprojected texture coordinates");
+        }
+      }
+    }
+  }
+  std::printf("Largest texture coordinate error: %g\n", max_error);
+}
+
+// Equal render and display orientations leave the texture coordinates
+// unchanged.
+void CheckIdentity() {
+  const std::vector<uint8_t> device_params =
+      qrcode::getCardboardV1DeviceParams();
+  const LensDistortion lens_distortion(
+      device_params.data(), static_cast<int>(device_params.size()),
+      kDisplayWidth, kDisplayHeight);
+
+  std::mt19937 generator(2022);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  for (int i = 0; i < kNumOrientations; i++) {
+    CardboardReprojection reprojection;
+    const Rotation orientation = Rotation::FromAxisAndAngle(
+        RandomDirection(&generator), angle(generator));
+    SetOrientation(orientation, reprojection.render_orientation);
+    SetOrientation(orientation, reprojection.display_orientation);
+
+    for (CardboardEye eye : {kLeft, kRight}) {
+      lens_distortion.GetEyeFieldOfView(eye, reprojection.field_of_view[eye]);
+      const std::array<float, 9> matrix =
+          ComputeReprojectionMatrix(reprojection, eye);
+      for (int element = 0; element < 9; element++) {
+        ExpectNear(kIdentityReprojectionMatrix[element], matrix[element],
+                   kIdentityTolerance, "matrix element",
+                   "identity reprojection matrix");
+      }
+
+      const CardboardMesh mesh = lens_distortion.GetDistortionMesh(eye);
+      std::vector<float> uvs(2 * mesh.n_vertices);
+      ReprojectTextureCoordinates(matrix, mesh.uvs, mesh.n_vertices,
+                                  uvs.data());
+      for (int j = 0; j < 2 * mesh.n_vertices; j++) {
+        ExpectNear(mesh.uvs[j], uvs[j], kIdentityTolerance,
+                   "texture coordinate", "identity reprojection");
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace cardboard
+
+int main() {
+  cardboard::CheckReprojection();
+  cardboard::CheckIdentity();
+  if (cardboard::failures == 0) {
+    std::printf("PASSED\n");
+  }
+  return cardboard::failures == 0 ? 0 : 1;
+}
@@ -170,6 +170,7 @@ void CardboardDisplayApi::UpdateDeviceParams() {
     case CardboardGraphicsApi::kVulkan:
       distortion_renderer_.reset(
           MakeCardboardVulkanDistortionRenderer(xr_interfaces_));
+      renderer_->PrepareDistortionRenderer(distortion_renderer_.get());
       break;
 #endif
     default:
@@ -181,17 +182,17 @@ void CardboardDisplayApi::UpdateDeviceParams() {
       break;
   }
 
-  CardboardLensDistortion_getDistortionMesh(
+  CardboardLensDistortion_getCompactDistortionMesh(
       lens_distortion, CardboardEye::kLeft,
       &eye_data_[CardboardEye::kLeft].distortion_mesh);
-  CardboardLensDistortion_getDistortionMesh(
+  CardboardLensDistortion_getCompactDistortionMesh(
       lens_distortion, CardboardEye::kRight,
       &eye_data_[CardboardEye::kRight].distortion_mesh);
 
-  CardboardDistortionRenderer_setMesh(
+  CardboardDistortionRenderer_setCompactMesh(
       distortion_renderer_.get(),
       &eye_data_[CardboardEye::kLeft].distortion_mesh, CardboardEye::kLeft);
-  CardboardDistortionRenderer_setMesh(
+  CardboardDistortionRenderer_setCompactMesh(
       distortion_renderer_.get(),
       &eye_data_[CardboardEye::kRight].distortion_mesh, CardboardEye::kRight);
 
@@ -211,7 +211,7 @@ class CardboardDisplayApi {
     float fov[4];
 
     // @brief Cardboard distortion mesh for the eye.
-    CardboardMesh distortion_mesh;
+    CardboardCompactMesh distortion_mesh;
 
     // @brief Cardboard texture description for the eye.
     CardboardEyeTextureDescription texture;
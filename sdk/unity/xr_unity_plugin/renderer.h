@@ -108,6 +108,13 @@ class Renderer {
   /// @param render_texture A RenderTexture to release its resources.
   virtual void DestroyRenderTexture(RenderTexture* render_texture) = 0;
 
+  /// @brief Prepares a newly created distortion renderer to render onto the
+  ///        display, e.g. by building its pipelines ahead of the first frame.
+  ///
+  /// @param[in] renderer Distortion renderer object pointer.
+  virtual void PrepareDistortionRenderer(
+      CardboardDistortionRenderer* /*renderer*/) {}
+
   /// @brief Renders eye textures onto the display.
   ///
   /// @param[in] renderer Distortion renderer object pointer.
@@ -364,6 +364,7 @@ class VulkanRenderer : public Renderer {
       return;
     }
 
+    BeginRenderPass();
     widget_renderer_->RenderWidgets(screen_params, widget_params,
                                     command_buffers_[image_index], image_index,
                                     render_pass_);
@@ -433,6 +434,12 @@ class VulkanRenderer : public Renderer {
     render_texture->depth_buffer = 0;
   }
 
+  void PrepareDistortionRenderer(
+      CardboardDistortionRenderer* renderer) override {
+    CardboardVulkanDistortionRenderer_prepareRenderPass(
+        renderer, reinterpret_cast<uint64_t>(&render_pass_));
+  }
+
   void RenderEyesToDisplay(
       CardboardDistortionRenderer* renderer, const ScreenParams& screen_params,
       const CardboardEyeTextureDescription* left_eye,
@@ -449,10 +456,13 @@ class VulkanRenderer : public Renderer {
         .swapchain_image_index = image_index,
     };
 
+    // Layout transitions are not allowed inside of a render pass, so they are
+    // recorded before it begins.
     current_image_left_ = reinterpret_cast<VkImage>(left_eye->texture);
     current_image_right_ = reinterpret_cast<VkImage>(right_eye->texture);
     TransitionEyeImagesLayoutFromUnityToDistortionRenderer(
         current_image_left_, current_image_right_);
+    BeginRenderPass();
 
     CardboardDistortionRenderer_renderEyeToDisplay(
         renderer, reinterpret_cast<uint64_t>(&target_config),
@@ -519,31 +529,14 @@ class VulkanRenderer : public Renderer {
     cardboard::rendering::vkBeginCommandBuffer(command_buffers_[image_index],
                                                &cmd_buffer_begin_info);
 
-    // Begin RenderPass
-    const VkClearValue clear_vals = {
-        .color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}};
-    const VkRenderPassBeginInfo render_pass_begin_info = {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .pNext = nullptr,
-        .renderPass = render_pass_,
-        .framebuffer = frame_buffers_[image_index],
-        .renderArea = {.offset =
-                           {
-                               .x = 0,
-                               .y = 0,
-                           },
-                       .extent =
-                           {
-                               .width =
-                                   static_cast<uint32_t>(screen_params.width),
-                               .height =
-                                   static_cast<uint32_t>(screen_params.height),
-                           }},
-        .clearValueCount = 1,
-        .pClearValues = &clear_vals};
-    cardboard::rendering::vkCmdBeginRenderPass(command_buffers_[image_index],
-                                               &render_pass_begin_info,
-                                               VK_SUBPASS_CONTENTS_INLINE);
+    // The render pass begins once the eye image layout transitions have been
+    // recorded. See BeginRenderPass().
+    render_area_extent_ = {
+        .width = static_cast<uint32_t>(screen_params.width),
+        .height = static_cast<uint32_t>(screen_params.height),
+    };
+    render_pass_active_ = false;
+    eye_images_transitioned_ = false;
   }
 
   void RunRenderingPostProcessing() override {
@@ -551,7 +544,20 @@ class VulkanRenderer : public Renderer {
       return;
     }
 
+    // Begins the render pass if nothing was drawn, so that the display is
+    // still cleared.
+    BeginRenderPass();
     cardboard::rendering::vkCmdEndRenderPass(command_buffers_[image_index]);
+    render_pass_active_ = false;
+
+    // Once the distortion renderer has sampled the eye images, set the layout
+    // that Unity uses to draw on them. Queue submission order guarantees that
+    // Unity's next commands on these images run after this transition.
+    if (eye_images_transitioned_) {
+      TransitionEyeImagesLayoutFromDistortionRendererToUnity(
+          current_image_left_, current_image_right_);
+      eye_images_transitioned_ = false;
+    }
     cardboard::rendering::vkEndCommandBuffer(command_buffers_[image_index]);
 
     // Submit recording command buffer.
@@ -577,11 +583,6 @@ class VulkanRenderer : public Renderer {
       CARDBOARD_LOGE("Failed to submit command buffer due to error code %d",
                      result);
     }
-
-    // Once the commands have been submited, set the layout that Unity uses to
-    // draw on the images.
-    TransitionEyeImagesLayoutFromDistortionRendererToUnity(
-        current_image_left_, current_image_right_);
   }
 
   void WaitForAllFences(uint64_t timeout_ns) {
@@ -601,9 +602,10 @@ class VulkanRenderer : public Renderer {
   // - Right: VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL.
   //
   // This set of methods and variables is a workaround for this unexpected
-  // behavior setting the layout that the. distortion renderer requires before
-  // passing the images to it and changing them to what. Unity requires after
-  // the command buffers are submitted to the queue.
+  // behavior setting the layout that the distortion renderer requires before
+  // passing the images to it and changing them to what Unity requires after
+  // the distortion renderer samples them. The transitions are recorded into
+  // the frame command buffer, so they do not stall the CPU.
   static const VkImageLayout kUnityLeftEyeImageLayout =
       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
   static const VkImageLayout kUnityRightEyeImageLayout =
@@ -621,10 +623,23 @@ class VulkanRenderer : public Renderer {
    */
   void TransitionEyeImagesLayoutFromUnityToDistortionRenderer(
       VkImage left_eye_image, VkImage right_eye_image) {
-    TransitionImageLayout(left_eye_image, kUnityLeftEyeImageLayout,
-                          kDistortionRendererEyeImagesLayout);
-    TransitionImageLayout(right_eye_image, kUnityRightEyeImageLayout,
-                          kDistortionRendererEyeImagesLayout);
+    // Unity drew on the images as color attachments.
+    const std::array<VkImageMemoryBarrier, 2> barriers{
+        CreateImageLayoutBarrier(left_eye_image, kUnityLeftEyeImageLayout,
+                                 kDistortionRendererEyeImagesLayout,
+                                 VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                 VK_ACCESS_SHADER_READ_BIT),
+        CreateImageLayoutBarrier(right_eye_image, kUnityRightEyeImageLayout,
+                                 kDistortionRendererEyeImagesLayout,
+                                 VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                 VK_ACCESS_SHADER_READ_BIT),
+    };
+    cardboard::rendering::vkCmdPipelineBarrier(
+        command_buffers_[image_index],
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+        barriers.size(), barriers.data());
+    eye_images_transitioned_ = true;
   }
 
   /**
@@ -637,10 +652,26 @@ class VulkanRenderer : public Renderer {
    */
   void TransitionEyeImagesLayoutFromDistortionRendererToUnity(
       VkImage left_eye_image, VkImage right_eye_image) {
-    TransitionImageLayout(left_eye_image, kDistortionRendererEyeImagesLayout,
-                          kUnityLeftEyeImageLayout);
-    TransitionImageLayout(right_eye_image, kDistortionRendererEyeImagesLayout,
-                          kUnityRightEyeImageLayout);
+    // The layouts Unity expects are for sampling the left eye image and for
+    // drawing on the right eye image.
+    const std::array<VkImageMemoryBarrier, 2> barriers{
+        CreateImageLayoutBarrier(left_eye_image,
+                                 kDistortionRendererEyeImagesLayout,
+                                 kUnityLeftEyeImageLayout,
+                                 VK_ACCESS_SHADER_READ_BIT,
+                                 VK_ACCESS_SHADER_READ_BIT),
+        CreateImageLayoutBarrier(right_eye_image,
+                                 kDistortionRendererEyeImagesLayout,
+                                 kUnityRightEyeImageLayout,
+                                 VK_ACCESS_SHADER_READ_BIT,
+                                 VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT),
+    };
+    cardboard::rendering::vkCmdPipelineBarrier(
+        command_buffers_[image_index], VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        0, 0, nullptr, 0, nullptr, barriers.size(), barriers.data());
   }
   // @}
 
@@ -671,18 +702,26 @@ class VulkanRenderer : public Renderer {
   }
 
   /**
-   * Changes the layout of the received image.
+   * Creates a barrier that changes the layout of the received image.
    *
    * @param image The image whose layout will be changed.
    * @param old_layout Current layout of the image.
    * @param new_layout New layout for the image.
+   * @param src_access_mask Accesses to the image that must complete before the
+   *        layout transition.
+   * @param dst_access_mask Accesses to the image that must wait for the layout
+   *        transition.
+   *
+   * @return The image memory barrier.
    */
-  void TransitionImageLayout(VkImage image, VkImageLayout old_layout,
-                             VkImageLayout new_layout) {
-    VkCommandBuffer command_buffer = BeginSingleTimeCommands();
-
-    VkImageMemoryBarrier barrier{
+  static VkImageMemoryBarrier CreateImageLayoutBarrier(
+      VkImage image, VkImageLayout old_layout, VkImageLayout new_layout,
+      VkAccessFlags src_access_mask, VkAccessFlags dst_access_mask) {
+    return VkImageMemoryBarrier{
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = src_access_mask,
+        .dstAccessMask = dst_access_mask,
         .oldLayout = old_layout,
         .newLayout = new_layout,
         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -697,69 +736,36 @@ class VulkanRenderer : public Renderer {
                 .layerCount = 1,
             },
     };
-
-    VkPipelineStageFlags source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    VkPipelineStageFlags destination_stage =
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    cardboard::rendering::vkCmdPipelineBarrier(command_buffer, source_stage,
-                                               destination_stage, 0, 0, nullptr,
-                                               0, nullptr, 1, &barrier);
-    EndSingleTimeCommands(command_buffer);
-  }
-
-  /**
-   * Creates a command buffer that is supossed to be used once and returns it.
-   *
-   * @return The command buffer.
-   */
-  VkCommandBuffer BeginSingleTimeCommands() {
-    VkCommandBufferAllocateInfo alloc_info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = command_pool_,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
-
-    VkCommandBuffer command_buffer;
-    cardboard::rendering::vkAllocateCommandBuffers(logical_device_, &alloc_info,
-                                                   &command_buffer);
-
-    VkCommandBufferBeginInfo begin_info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-    };
-
-    cardboard::rendering::vkBeginCommandBuffer(command_buffer, &begin_info);
-
-    return command_buffer;
   }
 
   /**
-   * Submits a single timme command buffer to the current queue and frees its
-   * memory.
-   *
-   * @param The command buffer.
+   * Begins the render pass on the frame command buffer, unless it is already
+   * active.
    */
-  void EndSingleTimeCommands(VkCommandBuffer command_buffer) {
-    cardboard::rendering::vkEndCommandBuffer(command_buffer);
-
-    VkSubmitInfo submit_info{
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &command_buffer,
-    };
-
-    UnityVulkanInstance vulkan_instance = vulkan_interface_->Instance();
-
-    cardboard::rendering::vkQueueSubmit(vulkan_instance.graphicsQueue, 1,
-                                        &submit_info, VK_NULL_HANDLE);
-    cardboard::rendering::vkQueueWaitIdle(vulkan_instance.graphicsQueue);
+  void BeginRenderPass() {
+    if (render_pass_active_) {
+      return;
+    }
 
-    cardboard::rendering::vkFreeCommandBuffers(logical_device_, command_pool_,
-                                               1, &command_buffer);
+    const VkClearValue clear_vals = {
+        .color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}};
+    const VkRenderPassBeginInfo render_pass_begin_info = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .pNext = nullptr,
+        .renderPass = render_pass_,
+        .framebuffer = frame_buffers_[image_index],
+        .renderArea = {.offset =
+                           {
+                               .x = 0,
+                               .y = 0,
+                           },
+                       .extent = render_area_extent_},
+        .clearValueCount = 1,
+        .pClearValues = &clear_vals};
+    cardboard::rendering::vkCmdBeginRenderPass(command_buffers_[image_index],
+                                               &render_pass_begin_info,
+                                               VK_SUBPASS_CONTENTS_INLINE);
+    render_pass_active_ = true;
   }
 
   // Variables created externally.
@@ -773,11 +779,14 @@ class VulkanRenderer : public Renderer {
   int swapchain_version_;
   VkImage current_image_left_;
   VkImage current_image_right_;
+  bool eye_images_transitioned_{false};
 
   // Variables created and maintained by the vulkan renderer.
   uint32_t swapchain_image_count_;
   uint32_t frames_to_update_count_;
   VkRenderPass render_pass_;
+  VkExtent2D render_area_extent_{};
+  bool render_pass_active_{false};
   VkCommandPool command_pool_;
   std::vector<VkFence> fences_;
   std::vector<VkSemaphore> semaphores_;
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_UTIL_HASH_H_
+#define CARDBOARD_SDK_UTIL_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cardboard {
+
+constexpr uint64_t kFnv1aOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnv1aPrime = 1099511628211ull;
+
+/// Computes the 64-bit FNV-1a hash of @p size bytes starting at @p data. The
+/// hash of a byte sequence split in several chunks can be computed by passing
+/// the hash of the previous chunks as @p hash.
+///
+/// @param[in]      data                    Bytes to hash.
+/// @param[in]      size                    Number of bytes.
+/// @param[in]      hash                    Initial hash value.
+/// @return         The hash of the bytes.
+inline uint64_t Fnv1aHash(const void* data, size_t size,
+                          uint64_t hash = kFnv1aOffsetBasis) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= kFnv1aPrime;
+  }
+  return hash;
+}
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_UTIL_HASH_H_
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "util/log_ring_buffer.h"
+
+#include <chrono>  // NOLINT
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include "util/logging.h"
+
+namespace cardboard {
+
+LogRingBuffer& LogRingBuffer::GetInstance() {
+  // Never destroyed, so that it can be used during static destruction.
+  static LogRingBuffer* instance = new LogRingBuffer();
+  return *instance;
+}
+
+LogRingBuffer::LogRingBuffer() : entries_(), count_(0) {}
+
+void LogRingBuffer::Append(const char* format, ...) {
+  Entry entry;
+  entry.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                           .count();
+  va_list args;
+  va_start(args, format);
+  vsnprintf(entry.text.data(), entry.text.size(), format, args);
+  va_end(args);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[count_ % kCapacity] = entry;
+  ++count_;
+}
+
+std::vector<LogRingBuffer::Message> LogRingBuffer::GetMessages() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return GetMessagesLocked();
+}
+
+void LogRingBuffer::Flush() {
+  std::vector<Message> messages;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages = GetMessagesLocked();
+    count_ = 0;
+  }
+  for (const Message& message : messages) {
+    CARDBOARD_LOGI("[%lld] %s", static_cast<long long>(message.timestamp_ns),
+                   message.text.c_str());
+  }
+}
+
+std::vector<LogRingBuffer::Message> LogRingBuffer::GetMessagesLocked() const {
+  const uint64_t begin = count_ > kCapacity ? count_ - kCapacity : 0;
+  std::vector<Message> messages;
+  messages.reserve(count_ - begin);
+  for (uint64_t i = begin; i < count_; ++i) {
+    const Entry& entry = entries_[i % kCapacity];
+    messages.push_back({entry.timestamp_ns, entry.text.data()});
+  }
+  return messages;
+}
+
+}  // namespace cardboard
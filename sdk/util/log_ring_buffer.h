@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_UTIL_LOG_RING_BUFFER_H_
+#define CARDBOARD_SDK_UTIL_LOG_RING_BUFFER_H_
+
+#include <array>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace cardboard {
+
+// In-memory sink for log messages. It keeps the latest kCapacity messages,
+// truncated to kMaxMessageLength characters, in preallocated storage. Appending
+// formats the message on the caller's stack and copies it under an
+// uncontended lock, so it neither allocates nor makes system calls, unlike the
+// system log. Messages are retrieved on demand, e.g. when a failure is
+// detected.
+//
+// Use it through the CARDBOARD_LOG_TO_RING_BUFFER macro of util/logging.h.
+class LogRingBuffer {
+ public:
+  static constexpr int kCapacity = 64;
+  static constexpr int kMaxMessageLength = 159;
+
+  // A message and the steady clock time at which it was appended.
+  struct Message {
+    int64_t timestamp_ns;
+    std::string text;
+  };
+
+  // Returns the process-wide instance.
+  static LogRingBuffer& GetInstance();
+
+  LogRingBuffer();
+
+  // Formats a message like printf() and appends it, replacing the oldest one
+  // when the buffer is full. Safe to call from any thread.
+  void Append(const char* format, ...)
+#if defined(__GNUC__)
+      __attribute__((format(printf, 2, 3)))
+#endif
+      ;
+
+  // Returns the messages kept, from the oldest to the newest.
+  std::vector<Message> GetMessages() const;
+
+  // Writes the messages kept to the system log and removes them.
+  void Flush();
+
+ private:
+  struct Entry {
+    int64_t timestamp_ns;
+    std::array<char, kMaxMessageLength + 1> text;
+  };
+
+  // Implementation of GetMessages(). mutex_ must be held.
+  std::vector<Message> GetMessagesLocked() const;
+
+  mutable std::mutex mutex_;
+  std::array<Entry, kCapacity> entries_;
+  // Number of messages appended since the last Flush().
+  uint64_t count_;
+
+  LogRingBuffer(const LogRingBuffer&) = delete;
+  LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_UTIL_LOG_RING_BUFFER_H_
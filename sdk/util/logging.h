@@ -16,37 +16,168 @@
 #ifndef CARDBOARD_SDK_UTIL_LOGGING_H_
 #define CARDBOARD_SDK_UTIL_LOGGING_H_
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "util/log_ring_buffer.h"
+
+// Log levels, in increasing order of severity.
+#define CARDBOARD_LOG_LEVEL_DEBUG 0
+#define CARDBOARD_LOG_LEVEL_INFO 1
+#define CARDBOARD_LOG_LEVEL_ERROR 2
+#define CARDBOARD_LOG_LEVEL_FATAL 3
+#define CARDBOARD_LOG_LEVEL_NONE 4
+
+// Messages below CARDBOARD_MIN_LOG_LEVEL are compiled out. It can be
+// overridden with a compiler flag, e.g.
+// -DCARDBOARD_MIN_LOG_LEVEL=CARDBOARD_LOG_LEVEL_ERROR. Debug messages are only
+// kept in debug builds by default.
+#ifndef CARDBOARD_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define CARDBOARD_MIN_LOG_LEVEL CARDBOARD_LOG_LEVEL_INFO
+#else
+#define CARDBOARD_MIN_LOG_LEVEL CARDBOARD_LOG_LEVEL_DEBUG
+#endif
+#endif
+
 #if defined(__APPLE__)
 
 #import <os/log.h>
 
-#define CARDBOARD_LOGI(...) os_log_info(OS_LOG_DEFAULT, __VA_ARGS__)
-#define CARDBOARD_LOGD(...) os_log_debug(OS_LOG_DEFAULT, __VA_ARGS__)
-#define CARDBOARD_LOGE(...) os_log_error(OS_LOG_DEFAULT, __VA_ARGS__)
-#define CARDBOARD_LOGF(...) os_log_fault(OS_LOG_DEFAULT, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_I(...) os_log_info(OS_LOG_DEFAULT, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_D(...) os_log_debug(OS_LOG_DEFAULT, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_E(...) os_log_error(OS_LOG_DEFAULT, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_F(...) os_log_fault(OS_LOG_DEFAULT, __VA_ARGS__)
 
 #elif defined(__ANDROID__)
 
 #include <android/log.h>
 
-#define CARDBOARD_LOGI(...) \
+#define CARDBOARD_LOG_IMPL_I(...) \
   __android_log_print(ANDROID_LOG_INFO, "CardboardSDK", __VA_ARGS__)
-#define CARDBOARD_LOGD(...) \
+#define CARDBOARD_LOG_IMPL_D(...) \
   __android_log_print(ANDROID_LOG_DEBUG, "CardboardSDK", __VA_ARGS__)
-#define CARDBOARD_LOGE(...) \
+#define CARDBOARD_LOG_IMPL_E(...) \
   __android_log_print(ANDROID_LOG_ERROR, "CardboardSDK", __VA_ARGS__)
-#define CARDBOARD_LOGF(...) \
+#define CARDBOARD_LOG_IMPL_F(...) \
   __android_log_print(ANDROID_LOG_FATAL, "CardboardSDK", __VA_ARGS__)
 
 #else
 
 #include <stdio.h>
 
-#define CARDBOARD_LOGI(...) fprintf(stdout, __VA_ARGS__)
-#define CARDBOARD_LOGD(...) fprintf(stdout, __VA_ARGS__)
-#define CARDBOARD_LOGE(...) fprintf(stderr, __VA_ARGS__)
-#define CARDBOARD_LOGF(...) fprintf(stderr, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_I(...) fprintf(stdout, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_D(...) fprintf(stdout, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_E(...) fprintf(stderr, __VA_ARGS__)
+#define CARDBOARD_LOG_IMPL_F(...) fprintf(stderr, __VA_ARGS__)
 
 #endif
 
+// Evaluates @p statement only if @p level is not compiled out. The statement
+// is still compiled, so that disabled messages keep being checked, but the
+// branch is removed by the optimizer.
+#define CARDBOARD_LOG_IF_ENABLED(level, statement) \
+  do {                                             \
+    if ((level) >= CARDBOARD_MIN_LOG_LEVEL) {      \
+      statement;                                   \
+    }                                              \
+  } while (0)
+
+#define CARDBOARD_LOGD(...)                           \
+  CARDBOARD_LOG_IF_ENABLED(CARDBOARD_LOG_LEVEL_DEBUG, \
+                           CARDBOARD_LOG_IMPL_D(__VA_ARGS__))
+#define CARDBOARD_LOGI(...)                          \
+  CARDBOARD_LOG_IF_ENABLED(CARDBOARD_LOG_LEVEL_INFO, \
+                           CARDBOARD_LOG_IMPL_I(__VA_ARGS__))
+#define CARDBOARD_LOGE(...)                           \
+  CARDBOARD_LOG_IF_ENABLED(CARDBOARD_LOG_LEVEL_ERROR, \
+                           CARDBOARD_LOG_IMPL_E(__VA_ARGS__))
+#define CARDBOARD_LOGF(...)                           \
+  CARDBOARD_LOG_IF_ENABLED(CARDBOARD_LOG_LEVEL_FATAL, \
+                           CARDBOARD_LOG_IMPL_F(__VA_ARGS__))
+
+// Rate limited variants of the macros above for hot paths. They keep their
+// state per call site and compile to nothing with their level.
+//
+// CARDBOARD_LOG?_EVERY_N(n, ...) logs the first time and then once every @p n
+// times the call site is reached.
+//
+// CARDBOARD_LOG?_EVERY_N_SEC(seconds, ...) logs at most once every @p seconds
+// seconds from the call site.
+#define CARDBOARD_LOG_EVERY_N_IMPL(level, log_impl, n, ...)      \
+  do {                                                           \
+    if ((level) >= CARDBOARD_MIN_LOG_LEVEL) {                    \
+      static std::atomic<uint32_t> cardboard_log_occurrences(0); \
+      if (cardboard::logging_internal::ShouldLogEveryN(          \
+              &cardboard_log_occurrences, (n))) {                \
+        log_impl(__VA_ARGS__);                                   \
+      }                                                          \
+    }                                                            \
+  } while (0)
+#define CARDBOARD_LOG_EVERY_N_SEC_IMPL(level, log_impl, seconds, ...) \
+  do {                                                                \
+    if ((level) >= CARDBOARD_MIN_LOG_LEVEL) {                         \
+      static std::atomic<int64_t> cardboard_log_next_time_ns(0);      \
+      if (cardboard::logging_internal::ShouldLogEveryNSeconds(        \
+              &cardboard_log_next_time_ns, (seconds))) {              \
+        log_impl(__VA_ARGS__);                                        \
+      }                                                               \
+    }                                                                 \
+  } while (0)
+
+#define CARDBOARD_LOGD_EVERY_N(n, ...)                  \
+  CARDBOARD_LOG_EVERY_N_IMPL(CARDBOARD_LOG_LEVEL_DEBUG, \
+                             CARDBOARD_LOG_IMPL_D, n, __VA_ARGS__)
+#define CARDBOARD_LOGI_EVERY_N(n, ...)                 \
+  CARDBOARD_LOG_EVERY_N_IMPL(CARDBOARD_LOG_LEVEL_INFO, \
+                             CARDBOARD_LOG_IMPL_I, n, __VA_ARGS__)
+#define CARDBOARD_LOGE_EVERY_N(n, ...)                  \
+  CARDBOARD_LOG_EVERY_N_IMPL(CARDBOARD_LOG_LEVEL_ERROR, \
+                             CARDBOARD_LOG_IMPL_E, n, __VA_ARGS__)
+#define CARDBOARD_LOGD_EVERY_N_SEC(seconds, ...)            \
+  CARDBOARD_LOG_EVERY_N_SEC_IMPL(CARDBOARD_LOG_LEVEL_DEBUG, \
+                                 CARDBOARD_LOG_IMPL_D, seconds, __VA_ARGS__)
+#define CARDBOARD_LOGI_EVERY_N_SEC(seconds, ...)           \
+  CARDBOARD_LOG_EVERY_N_SEC_IMPL(CARDBOARD_LOG_LEVEL_INFO, \
+                                 CARDBOARD_LOG_IMPL_I, seconds, __VA_ARGS__)
+#define CARDBOARD_LOGE_EVERY_N_SEC(seconds, ...)            \
+  CARDBOARD_LOG_EVERY_N_SEC_IMPL(CARDBOARD_LOG_LEVEL_ERROR, \
+                                 CARDBOARD_LOG_IMPL_E, seconds, __VA_ARGS__)
+
+// Formats a message into the in-memory LogRingBuffer instead of the system
+// log. It makes no system call, so it is suitable for hot path diagnostics.
+// Messages are compiled out only when logging is disabled altogether.
+#define CARDBOARD_LOG_TO_RING_BUFFER(...) \
+  CARDBOARD_LOG_IF_ENABLED(               \
+      CARDBOARD_LOG_LEVEL_FATAL,          \
+      cardboard::LogRingBuffer::GetInstance().Append(__VA_ARGS__))
+
+namespace cardboard {
+namespace logging_internal {
+
+// Returns true for the first occurrence and then once every @p n occurrences
+// counted by @p occurrences.
+inline bool ShouldLogEveryN(std::atomic<uint32_t>* occurrences, uint32_t n) {
+  return occurrences->fetch_add(1, std::memory_order_relaxed) % n == 0;
+}
+
+// Returns true if the current time is past @p next_time_ns, which is then
+// moved @p seconds into the future. Only one of concurrent callers gets true.
+inline bool ShouldLogEveryNSeconds(std::atomic<int64_t>* next_time_ns,
+                                   double seconds) {
+  const int64_t now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  int64_t next_ns = next_time_ns->load(std::memory_order_relaxed);
+  return now_ns >= next_ns &&
+         next_time_ns->compare_exchange_strong(
+             next_ns, now_ns + static_cast<int64_t>(seconds * 1e9),
+             std::memory_order_relaxed);
+}
+
+}  // namespace logging_internal
+}  // namespace cardboard
+
 #endif  // CARDBOARD_SDK_UTIL_LOGGING_H_
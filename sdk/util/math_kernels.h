@@ -0,0 +1,140 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_UTIL_MATH_KERNELS_H_
+#define CARDBOARD_SDK_UTIL_MATH_KERNELS_H_
+
+//
+// This file contains the innermost kernels of RotationT. They operate on raw
+// element pointers so that the scalar versions stay constexpr and the single
+// precision quaternion product can be replaced by SSE or NEON code. The other
+// kernels stay scalar because the compiler's code for them is faster than
+// the four wide versions. Define CARDBOARD_DISABLE_SIMD to force the scalar
+// versions.
+//
+
+#if !defined(CARDBOARD_DISABLE_SIMD) && \
+    (defined(__SSE2__) || defined(__ARM_NEON))
+#define CARDBOARD_MATH_SIMD 1
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace cardboard {
+
+// Whether the single precision kernels below use SIMD instructions.
+#if defined(CARDBOARD_MATH_SIMD)
+constexpr bool kMathSimdEnabled = true;
+#else
+constexpr bool kMathSimdEnabled = false;
+#endif
+
+// Computes the Hamilton product @p a * @p b of two quaternions stored as
+// (x, y, z, w) and writes it to @p out, which may alias either input.
+template <typename T>
+constexpr void QuaternionProduct(const T* a, const T* b, T* out) {
+  const T x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+  const T y = a[3] * b[1] + a[1] * b[3] + a[2] * b[0] - a[0] * b[2];
+  const T z = a[3] * b[2] + a[2] * b[3] + a[0] * b[1] - a[1] * b[0];
+  const T w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+  out[3] = w;
+}
+
+// Rotates the 3D vector @p v by the unit quaternion @p q and writes the result
+// to @p out, which must not alias @p v. Method borrowed from:
+// http://blog.molecular-matters.com/2013/05/24/a-faster-quaternion-vector-multiplication/
+template <typename T>
+constexpr void RotateVectorByQuaternion(const T* q, const T* v, T* out) {
+  // t = 2 * cross(q.xyz, v)
+  const T t0 = 2 * (q[1] * v[2] - q[2] * v[1]);
+  const T t1 = 2 * (q[2] * v[0] - q[0] * v[2]);
+  const T t2 = 2 * (q[0] * v[1] - q[1] * v[0]);
+  // out = v + q.w * t + cross(q.xyz, t)
+  out[0] = v[0] + q[3] * t0 + (q[1] * t2 - q[2] * t1);
+  out[1] = v[1] + q[3] * t1 + (q[2] * t0 - q[0] * t2);
+  out[2] = v[2] + q[3] * t2 + (q[0] * t1 - q[1] * t0);
+}
+
+#if defined(CARDBOARD_MATH_SIMD)
+
+#if defined(__SSE2__)
+
+// Single precision SSE version of the quaternion product.
+
+inline void QuaternionProduct(const float* a, const float* b, float* out) {
+  // Each lane of the result is a[3] * b plus a[0], a[1] and a[2] times a
+  // shuffled and partially negated copy of b:
+  //
+  //   a[0] * ( b[3], -b[2],  b[1], -b[0])
+  //   a[1] * ( b[2],  b[3], -b[0], -b[1])
+  //   a[2] * (-b[1],  b[0],  b[3], -b[2])
+  const __m128 sign0 = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+  const __m128 sign1 = _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f);
+  const __m128 sign2 = _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f);
+  const __m128 qa = _mm_loadu_ps(a);
+  const __m128 qb = _mm_loadu_ps(b);
+  const __m128 b0 =
+      _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(0, 1, 2, 3)), sign0);
+  const __m128 b1 =
+      _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(1, 0, 3, 2)), sign1);
+  const __m128 b2 =
+      _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(2, 3, 0, 1)), sign2);
+  __m128 result =
+      _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(3, 3, 3, 3)), qb);
+  result = _mm_add_ps(
+      result, _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(0, 0, 0, 0)), b0));
+  result = _mm_add_ps(
+      result, _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+  result = _mm_add_ps(
+      result, _mm_mul_ps(_mm_shuffle_ps(qa, qa, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+  _mm_storeu_ps(out, result);
+}
+
+#else  // defined(__ARM_NEON)
+
+// Single precision NEON version of the quaternion product.
+
+inline void QuaternionProduct(const float* a, const float* b, float* out) {
+  // See the SSE version for the lane layout.
+  static const float kSign0[4] = {1.0f, -1.0f, 1.0f, -1.0f};
+  static const float kSign1[4] = {1.0f, 1.0f, -1.0f, -1.0f};
+  static const float kSign2[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+  const float32x4_t qb = vld1q_f32(b);
+  // (b[2], b[3], b[0], b[1])
+  const float32x4_t b_zwxy = vextq_f32(qb, qb, 2);
+  // (b[3], b[2], b[1], b[0])
+  const float32x4_t b_wzyx = vrev64q_f32(b_zwxy);
+  // (b[1], b[0], b[3], b[2])
+  const float32x4_t b_yxwz = vrev64q_f32(qb);
+  float32x4_t result = vmulq_n_f32(qb, a[3]);
+  result = vmlaq_n_f32(result, vmulq_f32(b_wzyx, vld1q_f32(kSign0)), a[0]);
+  result = vmlaq_n_f32(result, vmulq_f32(b_zwxy, vld1q_f32(kSign1)), a[1]);
+  result = vmlaq_n_f32(result, vmulq_f32(b_yxwz, vld1q_f32(kSign2)), a[2]);
+  vst1q_f32(out, result);
+}
+
+#endif  // defined(__SSE2__)
+
+#endif  // defined(CARDBOARD_MATH_SIMD)
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_UTIL_MATH_KERNELS_H_
@@ -17,96 +17,187 @@
 #define CARDBOARD_SDK_UTIL_MATRIX_3X3_H_
 
 #include <array>
-#include <cstring>  // For memcpy().
 #include <istream>  // NOLINT
 #include <ostream>  // NOLINT
 
 namespace cardboard {
 
-// The Matrix3x3 class defines a square 3-dimensional matrix. Elements are
-// stored in row-major order.
+// The Matrix3x3T class defines a square 3-dimensional matrix, templated on the
+// scalar type. Elements are stored in row-major order. All operations are
+// constexpr.
 // TODO(b/135461889): Make this class consistent with Matrix4x4.
-class Matrix3x3 {
+template <typename T>
+class Matrix3x3T {
  public:
+  typedef T Scalar;
+
   // The default constructor zero-initializes all elements.
-  Matrix3x3();
+  constexpr Matrix3x3T() : elem_{} {}
 
   // Dimension-specific constructors that are passed individual element values.
-  Matrix3x3(double m00, double m01, double m02, double m10, double m11,
-            double m12, double m20, double m21, double m22);
+  constexpr Matrix3x3T(T m00, T m01, T m02, T m10, T m11, T m12, T m20, T m21,
+                       T m22)
+      : elem_{{{m00, m01, m02}, {m10, m11, m12}, {m20, m21, m22}}} {}
 
   // Constructor that reads elements from a linear array of the correct size.
-  explicit Matrix3x3(const double array[3 * 3]);
+  constexpr explicit Matrix3x3T(const T array[3 * 3]) : elem_{} {
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) elem_[row][col] = array[row * 3 + col];
+    }
+  }
+
+  // Converts a matrix of another scalar type, e.g. double to float.
+  template <typename U>
+  constexpr explicit Matrix3x3T(const Matrix3x3T<U>& m) : elem_{} {
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col)
+        elem_[row][col] = static_cast<T>(m(row, col));
+    }
+  }
 
-  // Returns a Matrix3x3 containing all zeroes.
-  static Matrix3x3 Zero();
+  // Returns a Matrix3x3T containing all zeroes.
+  static constexpr Matrix3x3T Zero() { return Matrix3x3T(); }
 
-  // Returns an identity Matrix3x3.
-  static Matrix3x3 Identity();
+  // Returns an identity Matrix3x3T.
+  static constexpr Matrix3x3T Identity() {
+    Matrix3x3T result;
+    for (int row = 0; row < 3; ++row) {
+      result.elem_[row][row] = 1;
+    }
+    return result;
+  }
 
   // Mutable element accessors.
-  double& operator()(int row, int col) { return elem_[row][col]; }
-  std::array<double, 3>& operator[](int row) { return elem_[row]; }
+  constexpr T& operator()(int row, int col) { return elem_[row][col]; }
+  constexpr std::array<T, 3>& operator[](int row) { return elem_[row]; }
 
   // Read-only element accessors.
-  const double& operator()(int row, int col) const { return elem_[row][col]; }
-  const std::array<double, 3>& operator[](int row) const { return elem_[row]; }
+  constexpr const T& operator()(int row, int col) const {
+    return elem_[row][col];
+  }
+  constexpr const std::array<T, 3>& operator[](int row) const {
+    return elem_[row];
+  }
 
   // Return a pointer to the data for interfacing with libraries.
-  double* Data() { return &elem_[0][0]; }
-  const double* Data() const { return &elem_[0][0]; }
+  constexpr T* Data() { return &elem_[0][0]; }
+  constexpr const T* Data() const { return &elem_[0][0]; }
 
   // Self-modifying multiplication operators.
-  void operator*=(double s) { MultiplyScalar(s); }
-  void operator*=(const Matrix3x3& m) { *this = Product(*this, m); }
+  constexpr void operator*=(T s) { MultiplyScalar(s); }
+  constexpr void operator*=(const Matrix3x3T& m) { *this = Product(*this, m); }
 
   // Unary operators.
-  Matrix3x3 operator-() const { return Negation(); }
+  constexpr Matrix3x3T operator-() const { return Negation(); }
 
   // Binary scale operators.
-  friend Matrix3x3 operator*(const Matrix3x3& m, double s) {
+  friend constexpr Matrix3x3T operator*(const Matrix3x3T& m, T s) {
     return Scale(m, s);
   }
-  friend Matrix3x3 operator*(double s, const Matrix3x3& m) {
+  friend constexpr Matrix3x3T operator*(T s, const Matrix3x3T& m) {
     return Scale(m, s);
   }
 
   // Binary matrix addition.
-  friend Matrix3x3 operator+(const Matrix3x3& lhs, const Matrix3x3& rhs) {
+  friend constexpr Matrix3x3T operator+(const Matrix3x3T& lhs,
+                                        const Matrix3x3T& rhs) {
     return Addition(lhs, rhs);
   }
 
   // Binary matrix subtraction.
-  friend Matrix3x3 operator-(const Matrix3x3& lhs, const Matrix3x3& rhs) {
+  friend constexpr Matrix3x3T operator-(const Matrix3x3T& lhs,
+                                        const Matrix3x3T& rhs) {
     return Subtraction(lhs, rhs);
   }
 
   // Binary multiplication operator.
-  friend Matrix3x3 operator*(const Matrix3x3& m0, const Matrix3x3& m1) {
+  friend constexpr Matrix3x3T operator*(const Matrix3x3T& m0,
+                                        const Matrix3x3T& m1) {
     return Product(m0, m1);
   }
 
   // Exact equality and inequality comparisons.
-  friend bool operator==(const Matrix3x3& m0, const Matrix3x3& m1) {
+  friend constexpr bool operator==(const Matrix3x3T& m0, const Matrix3x3T& m1) {
     return AreEqual(m0, m1);
   }
-  friend bool operator!=(const Matrix3x3& m0, const Matrix3x3& m1) {
+  friend constexpr bool operator!=(const Matrix3x3T& m0, const Matrix3x3T& m1) {
     return !AreEqual(m0, m1);
   }
 
  private:
   // These private functions implement most of the operators.
-  void MultiplyScalar(double s);
-  Matrix3x3 Negation() const;
-  static Matrix3x3 Addition(const Matrix3x3& lhs, const Matrix3x3& rhs);
-  static Matrix3x3 Subtraction(const Matrix3x3& lhs, const Matrix3x3& rhs);
-  static Matrix3x3 Scale(const Matrix3x3& m, double s);
-  static Matrix3x3 Product(const Matrix3x3& m0, const Matrix3x3& m1);
-  static bool AreEqual(const Matrix3x3& m0, const Matrix3x3& m1);
-
-  std::array<std::array<double, 3>, 3> elem_;
+  constexpr void MultiplyScalar(T s) {
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) elem_[row][col] *= s;
+    }
+  }
+
+  constexpr Matrix3x3T Negation() const {
+    Matrix3x3T result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col)
+        result.elem_[row][col] = -elem_[row][col];
+    }
+    return result;
+  }
+
+  static constexpr Matrix3x3T Addition(const Matrix3x3T& lhs,
+                                       const Matrix3x3T& rhs) {
+    Matrix3x3T result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col)
+        result.elem_[row][col] = lhs.elem_[row][col] + rhs.elem_[row][col];
+    }
+    return result;
+  }
+
+  static constexpr Matrix3x3T Subtraction(const Matrix3x3T& lhs,
+                                          const Matrix3x3T& rhs) {
+    Matrix3x3T result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col)
+        result.elem_[row][col] = lhs.elem_[row][col] - rhs.elem_[row][col];
+    }
+    return result;
+  }
+
+  static constexpr Matrix3x3T Scale(const Matrix3x3T& m, T s) {
+    Matrix3x3T result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col)
+        result.elem_[row][col] = m.elem_[row][col] * s;
+    }
+    return result;
+  }
+
+  static constexpr Matrix3x3T Product(const Matrix3x3T& m0,
+                                      const Matrix3x3T& m1) {
+    Matrix3x3T result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        result.elem_[row][col] = m0.elem_[row][0] * m1.elem_[0][col] +
+                                 m0.elem_[row][1] * m1.elem_[1][col] +
+                                 m0.elem_[row][2] * m1.elem_[2][col];
+      }
+    }
+    return result;
+  }
+
+  static constexpr bool AreEqual(const Matrix3x3T& m0, const Matrix3x3T& m1) {
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        if (m0.elem_[row][col] != m1.elem_[row][col]) return false;
+      }
+    }
+    return true;
+  }
+
+  std::array<std::array<T, 3>, 3> elem_;
 };
 
+typedef Matrix3x3T<double> Matrix3x3;
+typedef Matrix3x3T<float> Matrix3x3f;
+
 }  // namespace cardboard
 
 #endif  // CARDBOARD_SDK_UTIL_MATRIX_3X3_H_
@@ -79,6 +79,12 @@ Matrix4x4 Matrix4x4::Perspective(const std::array<float, 4>& fov, float zNear,
   return ret;
 }
 
+Matrix4x4 Matrix4x4::FromArray(const float* array) {
+  Matrix4x4 ret;
+  std::memcpy(&ret.m[0][0], array, 16 * sizeof(float));
+  return ret;
+}
+
 void Matrix4x4::ToArray(float* array) const {
   std::memcpy(array, &m[0][0], 16 * sizeof(float));
 }
@@ -48,6 +48,12 @@ class Matrix4x4 {
   static Matrix4x4 Perspective(const std::array<float, 4>& fov, float zNear,
                                float zFar);
 
+  // @brief Constructs a matrix from the contents of @p array, as written by
+  //        ToArray().
+  // @param array A pointer to a float array of size 16.
+  // @returns A matrix with the contents of @p array.
+  static Matrix4x4 FromArray(const float* array);
+
   // @brief Copies into @p array the contents of `this` matrix.
   // @param[out] array A pointer to a float array of size 16.
   void ToArray(float* array) const;
@@ -16,25 +16,34 @@
 #ifndef CARDBOARD_SDK_UTIL_ROTATION_H_
 #define CARDBOARD_SDK_UTIL_ROTATION_H_
 
+#include "util/math_kernels.h"
 #include "util/matrix_3x3.h"
 #include "util/vector.h"
 #include "util/vectorutils.h"
 
 namespace cardboard {
 
-// The Rotation class represents a rotation around a 3-dimensional axis. It
-// uses normalized quaternions internally to make the math robust.
-class Rotation {
+// The RotationT class represents a rotation around a 3-dimensional axis,
+// templated on the scalar type. It uses normalized quaternions internally to
+// make the math robust.
+template <typename T>
+class RotationT {
  public:
   // Convenience typedefs for vector of the correct type.
-  typedef Vector<3> VectorType;
-  typedef Vector<4> QuaternionType;
+  typedef T Scalar;
+  typedef Vector<3, T> VectorType;
+  typedef Vector<4, T> QuaternionType;
 
   // The default constructor creates an identity Rotation, which has no effect.
-  Rotation() { quat_.Set(0, 0, 0, 1); }
+  constexpr RotationT() : quat_(0, 0, 0, 1) {}
+
+  // Converts a Rotation of another scalar type, e.g. double to float.
+  template <typename U>
+  constexpr explicit RotationT(const RotationT<U>& r)
+      : quat_(r.GetQuaternion()) {}
 
   // Returns an identity Rotation, which has no effect.
-  static Rotation Identity() { return Rotation(); }
+  static constexpr RotationT Identity() { return RotationT(); }
 
   // Sets the Rotation from a quaternion (4D vector), which is first normalized.
   void SetQuaternion(const QuaternionType& quaternion) {
@@ -42,42 +51,42 @@ class Rotation {
   }
 
   // Returns the Rotation as a normalized quaternion (4D vector).
-  const QuaternionType& GetQuaternion() const { return quat_; }
+  constexpr const QuaternionType& GetQuaternion() const { return quat_; }
 
   // Sets the Rotation to rotate by the given angle around the given axis,
   // following the right-hand rule. The axis does not need to be unit
   // length. If it is zero length, this results in an identity Rotation.
-  void SetAxisAndAngle(const VectorType& axis, double angle);
+  void SetAxisAndAngle(const VectorType& axis, T angle);
 
   // Returns the right-hand rule axis and angle corresponding to the
   // Rotation. If the Rotation is the identity rotation, this returns the +X
   // axis and an angle of 0.
-  void GetAxisAndAngle(VectorType* axis, double* angle) const;
+  void GetAxisAndAngle(VectorType* axis, T* angle) const;
 
   // Convenience function that constructs and returns a Rotation given an axis
   // and angle.
-  static Rotation FromAxisAndAngle(const VectorType& axis, double angle) {
-    Rotation r;
+  static RotationT FromAxisAndAngle(const VectorType& axis, T angle) {
+    RotationT r;
     r.SetAxisAndAngle(axis, angle);
     return r;
   }
 
   // Convenience function that constructs and returns a Rotation given a
   // quaternion.
-  static Rotation FromQuaternion(const QuaternionType& quat) {
-    Rotation r;
+  static RotationT FromQuaternion(const QuaternionType& quat) {
+    RotationT r;
     r.SetQuaternion(quat);
     return r;
   }
 
   // Convenience function that constructs and returns a Rotation given a
   // rotation matrix R with $R^\top R = I && det(R) = 1$.
-  static Rotation FromRotationMatrix(const Matrix3x3& mat);
+  static RotationT FromRotationMatrix(const Matrix3x3T<T>& mat);
 
   // Convenience function that constructs and returns a Rotation given Euler
   // angles that are applied in the order of rotate-Z by roll, rotate-X by
   // pitch, rotate-Y by yaw (same as GetRollPitchYaw).
-  static Rotation FromRollPitchYaw(double roll, double pitch, double yaw) {
+  static RotationT FromRollPitchYaw(T roll, T pitch, T yaw) {
     VectorType x(1, 0, 0), y(0, 1, 0), z(0, 0, 1);
     return FromAxisAndAngle(z, roll) *
            (FromAxisAndAngle(x, pitch) * FromAxisAndAngle(y, yaw));
@@ -86,7 +95,7 @@ class Rotation {
   // Convenience function that constructs and returns a Rotation given Euler
   // angles that are applied in the order of rotate-Y by yaw, rotate-X by
   // pitch, rotate-Z by roll (same as GetYawPitchRoll).
-  static Rotation FromYawPitchRoll(double yaw, double pitch, double roll) {
+  static RotationT FromYawPitchRoll(T yaw, T pitch, T roll) {
     VectorType x(1, 0, 0), y(0, 1, 0), z(0, 0, 1);
     return FromAxisAndAngle(y, yaw) *
            (FromAxisAndAngle(x, pitch) * FromAxisAndAngle(z, roll));
@@ -95,36 +104,38 @@ class Rotation {
   // Constructs and returns a Rotation that rotates one vector to another along
   // the shortest arc. This returns an identity rotation if either vector has
   // zero length.
-  static Rotation RotateInto(const VectorType& from, const VectorType& to);
+  static RotationT RotateInto(const VectorType& from, const VectorType& to);
+
+  // Spherically interpolates between @p r0 and @p r1 along the shortest arc.
+  // @p t is 0 for @p r0 and 1 for @p r1.
+  static RotationT Slerp(const RotationT& r0, const RotationT& r1, T t);
 
   // The negation operator returns the inverse rotation.
-  friend Rotation operator-(const Rotation& r) {
+  friend constexpr RotationT operator-(const RotationT& r) {
     // Because we store normalized quaternions, the inverse is found by
     // negating the vector part.
-    return Rotation(-r.quat_[0], -r.quat_[1], -r.quat_[2], r.quat_[3]);
+    return RotationT(-r.quat_[0], -r.quat_[1], -r.quat_[2], r.quat_[3]);
   }
 
   // Appends a rotation to this one.
-  Rotation& operator*=(const Rotation& r) {
-    const QuaternionType& qr = r.quat_;
-    QuaternionType& qt = quat_;
-    SetQuaternion(QuaternionType(
-        qr[3] * qt[0] + qr[0] * qt[3] + qr[2] * qt[1] - qr[1] * qt[2],
-        qr[3] * qt[1] + qr[1] * qt[3] + qr[0] * qt[2] - qr[2] * qt[0],
-        qr[3] * qt[2] + qr[2] * qt[3] + qr[1] * qt[0] - qr[0] * qt[1],
-        qr[3] * qt[3] - qr[0] * qt[0] - qr[1] * qt[1] - qr[2] * qt[2]));
+  RotationT& operator*=(const RotationT& r) {
+    QuaternionType product;
+    QuaternionProduct(quat_.Data(), r.quat_.Data(), product.Data());
+    SetQuaternion(product);
     return *this;
   }
 
   // Binary multiplication operator - returns a composite Rotation.
-  friend const Rotation operator*(const Rotation& r0, const Rotation& r1) {
-    Rotation r = r0;
+  friend const RotationT operator*(const RotationT& r0, const RotationT& r1) {
+    RotationT r = r0;
     r *= r1;
     return r;
   }
 
   // Multiply a Rotation and a Vector to get a Vector.
-  VectorType operator*(const VectorType& v) const;
+  constexpr VectorType operator*(const VectorType& v) const {
+    return ApplyToVector(v);
+  }
 
   // @{ Functions that return the Yaw, Pitch and Roll angle from the current
   // value of quat_.
@@ -138,22 +149,20 @@ class Rotation {
   // @see https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles
   //
   // @return Angle in radians.
-  double GetYawAngle() const;
-  double GetPitchAngle() const;
-  double GetRollAngle() const;
+  T GetYawAngle() const;
+  T GetPitchAngle() const;
+  T GetRollAngle() const;
   // @}
 
  private:
   // Private constructor that builds a Rotation from quaternion components.
-  Rotation(double q0, double q1, double q2, double q3)
-      : quat_(q0, q1, q2, q3) {}
-
-  // Applies a Rotation to a Vector to rotate the Vector. Method borrowed from:
-  // http://blog.molecular-matters.com/2013/05/24/a-faster-quaternion-vector-multiplication/
-  VectorType ApplyToVector(const VectorType& v) const {
-    VectorType im(quat_[0], quat_[1], quat_[2]);
-    VectorType temp = 2.0 * Cross(im, v);
-    return v + quat_[3] * temp + Cross(im, temp);
+  constexpr RotationT(T q0, T q1, T q2, T q3) : quat_(q0, q1, q2, q3) {}
+
+  // Applies a Rotation to a Vector to rotate the Vector.
+  constexpr VectorType ApplyToVector(const VectorType& v) const {
+    VectorType result;
+    RotateVectorByQuaternion(quat_.Data(), v.Data(), result.Data());
+    return result;
   }
 
   // The rotation represented as a normalized quaternion. (Unit quaternions are
@@ -163,6 +172,9 @@ class Rotation {
   QuaternionType quat_;
 };
 
+typedef RotationT<double> Rotation;
+typedef RotationT<float> Rotationf;
+
 }  // namespace cardboard
 
 #endif  // CARDBOARD_SDK_UTIL_ROTATION_H_
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_UTIL_SEQLOCK_H_
+#define CARDBOARD_SDK_UTIL_SEQLOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace cardboard {
+
+// Publishes a value of a trivially copyable type from a single writer to any
+// number of readers without locks.
+//
+// Readers never block the writer and never take a lock: Load() copies the
+// value and retries if the writer was storing a new one concurrently. Writes
+// are not synchronized with each other, so callers must ensure there is only
+// one writer at a time.
+//
+// The value is kept in relaxed atomic words so that a read racing with a write
+// is well defined; torn copies are detected through the sequence counter and
+// discarded.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type.");
+
+ public:
+  explicit SeqLock(const T& value = T()) { Store(value); }
+
+  // Stores @p value. Must not be called concurrently with another Store().
+  void Store(const T& value) {
+    std::array<uint64_t, kWordCount> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    // An odd sequence tells readers a store is in progress.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < kWordCount; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Returns the last stored value. Safe to call from any thread.
+  T Load() const {
+    std::array<uint64_t, kWordCount> words;
+    uint32_t sequence_before;
+    uint32_t sequence_after;
+    do {
+      sequence_before = sequence_.load(std::memory_order_acquire);
+      for (int i = 0; i < kWordCount; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      sequence_after = sequence_.load(std::memory_order_relaxed);
+    } while ((sequence_before & 1) != 0 || sequence_before != sequence_after);
+
+    T value;
+    std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+    return value;
+  }
+
+ private:
+  static constexpr int kWordCount =
+      static_cast<int>((sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+  std::atomic<uint32_t> sequence_{0};
+  std::array<std::atomic<uint64_t>, kWordCount> words_;
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_UTIL_SEQLOCK_H_
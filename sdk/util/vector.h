@@ -20,203 +20,216 @@
 
 namespace cardboard {
 
-// Geometric N-dimensional Vector class.
-template <int Dimension>
+// Geometric N-dimensional Vector class, templated on the scalar type. All
+// operations are constexpr.
+template <int Dimension, typename T = double>
 class Vector {
  public:
+  typedef T Scalar;
+
   // The default constructor zero-initializes all elements.
-  Vector();
+  constexpr Vector() : elem_{} {}
 
   // Dimension-specific constructors that are passed individual element values.
-  constexpr Vector(double e0, double e1, double e2);
-  constexpr Vector(double e0, double e1, double e2, double e3);
+  constexpr Vector(T e0, T e1, T e2) : elem_{e0, e1, e2} {}
+  constexpr Vector(T e0, T e1, T e2, T e3) : elem_{e0, e1, e2, e3} {}
 
   // Constructor for a Vector of dimension N from a Vector of dimension N-1 and
   // a scalar of the correct type, assuming N is at least 2.
-  constexpr Vector(const Vector<Dimension - 1>& v, double s);
+  constexpr Vector(const Vector<Dimension - 1, T>& v, T s);
+
+  // Converts a Vector of another scalar type, e.g. double to float.
+  template <typename U>
+  constexpr explicit Vector(const Vector<Dimension, U>& v);
 
-  void Set(double e0, double e1, double e2);  // Only when Dimension == 3.
-  void Set(double e0, double e1, double e2,
-           double e3);  // Only when Dimension == 4.
+  constexpr void Set(T e0, T e1, T e2);  // Only when Dimension == 3.
+  constexpr void Set(T e0, T e1, T e2,
+                     T e3);  // Only when Dimension == 4.
 
   // Mutable element accessor.
-  double& operator[](int index) { return elem_[index]; }
+  constexpr T& operator[](int index) { return elem_[index]; }
 
   // Element accessor.
-  double operator[](int index) const { return elem_[index]; }
+  constexpr T operator[](int index) const { return elem_[index]; }
+
+  // Return a pointer to the data for interfacing with libraries.
+  constexpr T* Data() { return elem_.data(); }
+  constexpr const T* Data() const { return elem_.data(); }
 
   // Returns a Vector containing all zeroes.
-  static Vector Zero();
+  static constexpr Vector Zero() { return Vector(); }
 
   // Self-modifying operators.
-  void operator+=(const Vector& v) { Add(v); }
-  void operator-=(const Vector& v) { Subtract(v); }
-  void operator*=(double s) { Multiply(s); }
-  void operator/=(double s) { Divide(s); }
+  constexpr void operator+=(const Vector& v) { Add(v); }
+  constexpr void operator-=(const Vector& v) { Subtract(v); }
+  constexpr void operator*=(T s) { Multiply(s); }
+  constexpr void operator/=(T s) { Divide(s); }
 
   // Unary negation operator.
-  Vector operator-() const { return Negation(); }
+  constexpr Vector operator-() const { return Negation(); }
 
   // Binary operators.
-  friend Vector operator+(const Vector& v0, const Vector& v1) {
+  friend constexpr Vector operator+(const Vector& v0, const Vector& v1) {
     return Sum(v0, v1);
   }
-  friend Vector operator-(const Vector& v0, const Vector& v1) {
+  friend constexpr Vector operator-(const Vector& v0, const Vector& v1) {
     return Difference(v0, v1);
   }
-  friend Vector operator*(const Vector& v, double s) { return Scale(v, s); }
-  friend Vector operator*(double s, const Vector& v) { return Scale(v, s); }
-  friend Vector operator*(const Vector& v, const Vector& s) {
+  friend constexpr Vector operator*(const Vector& v, T s) {
+    return Scale(v, s);
+  }
+  friend constexpr Vector operator*(T s, const Vector& v) {
+    return Scale(v, s);
+  }
+  friend constexpr Vector operator*(const Vector& v, const Vector& s) {
     return Product(v, s);
   }
-  friend Vector operator/(const Vector& v, double s) { return Divide(v, s); }
+  friend constexpr Vector operator/(const Vector& v, T s) {
+    return Divide(v, s);
+  }
 
   // Self-modifying addition.
-  void Add(const Vector& v);
+  constexpr void Add(const Vector& v);
   // Self-modifying subtraction.
-  void Subtract(const Vector& v);
+  constexpr void Subtract(const Vector& v);
   // Self-modifying multiplication by a scalar.
-  void Multiply(double s);
+  constexpr void Multiply(T s);
   // Self-modifying division by a scalar.
-  void Divide(double s);
+  constexpr void Divide(T s);
 
   // Unary negation.
-  Vector Negation() const;
+  constexpr Vector Negation() const;
 
   // Binary component-wise multiplication.
-  static Vector Product(const Vector& v0, const Vector& v1);
+  static constexpr Vector Product(const Vector& v0, const Vector& v1);
   // Binary component-wise addition.
-  static Vector Sum(const Vector& v0, const Vector& v1);
+  static constexpr Vector Sum(const Vector& v0, const Vector& v1);
   // Binary component-wise subtraction.
-  static Vector Difference(const Vector& v0, const Vector& v1);
+  static constexpr Vector Difference(const Vector& v0, const Vector& v1);
   // Binary multiplication by a scalar.
-  static Vector Scale(const Vector& v, double s);
+  static constexpr Vector Scale(const Vector& v, T s);
   // Binary division by a scalar.
-  static Vector Divide(const Vector& v, double s);
+  static constexpr Vector Divide(const Vector& v, T s);
 
  private:
-  std::array<double, Dimension> elem_;
+  std::array<T, Dimension> elem_;
 };
 //------------------------------------------------------------------------------
 
-template <int Dimension>
-Vector<Dimension>::Vector() {
-  for (int i = 0; i < Dimension; i++) {
-    elem_[i] = 0;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T>::Vector(const Vector<Dimension - 1, T>& v, T s)
+    : elem_{} {
+  for (int i = 0; i < Dimension - 1; i++) {
+    elem_[i] = v[i];
   }
+  elem_[Dimension - 1] = s;
 }
 
-template <int Dimension>
-constexpr Vector<Dimension>::Vector(double e0, double e1, double e2)
-    : elem_{e0, e1, e2} {}
-
-template <int Dimension>
-constexpr Vector<Dimension>::Vector(double e0, double e1, double e2, double e3)
-    : elem_{e0, e1, e2, e3} {}
-
-template <>
-constexpr Vector<4>::Vector(const Vector<3>& v, double s)
-    : elem_{v[0], v[1], v[2], s} {}
+template <int Dimension, typename T>
+template <typename U>
+constexpr Vector<Dimension, T>::Vector(const Vector<Dimension, U>& v)
+    : elem_{} {
+  for (int i = 0; i < Dimension; i++) {
+    elem_[i] = static_cast<T>(v[i]);
+  }
+}
 
-template <int Dimension>
-void Vector<Dimension>::Set(double e0, double e1, double e2) {
+template <int Dimension, typename T>
+constexpr void Vector<Dimension, T>::Set(T e0, T e1, T e2) {
   elem_[0] = e0;
   elem_[1] = e1;
   elem_[2] = e2;
 }
 
-template <int Dimension>
-void Vector<Dimension>::Set(double e0, double e1, double e2, double e3) {
+template <int Dimension, typename T>
+constexpr void Vector<Dimension, T>::Set(T e0, T e1, T e2, T e3) {
   elem_[0] = e0;
   elem_[1] = e1;
   elem_[2] = e2;
   elem_[3] = e3;
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Zero() {
-  Vector<Dimension> v;
-  return v;
-}
-
-template <int Dimension>
-void Vector<Dimension>::Add(const Vector& v) {
+template <int Dimension, typename T>
+constexpr void Vector<Dimension, T>::Add(const Vector& v) {
   for (int i = 0; i < Dimension; i++) {
     elem_[i] += v[i];
   }
 }
 
-template <int Dimension>
-void Vector<Dimension>::Subtract(const Vector& v) {
+template <int Dimension, typename T>
+constexpr void Vector<Dimension, T>::Subtract(const Vector& v) {
   for (int i = 0; i < Dimension; i++) {
     elem_[i] -= v[i];
   }
 }
 
-template <int Dimension>
-void Vector<Dimension>::Multiply(double s) {
+template <int Dimension, typename T>
+constexpr void Vector<Dimension, T>::Multiply(T s) {
   for (int i = 0; i < Dimension; i++) {
     elem_[i] *= s;
   }
 }
 
-template <int Dimension>
-void Vector<Dimension>::Divide(double s) {
+template <int Dimension, typename T>
+constexpr void Vector<Dimension, T>::Divide(T s) {
   for (int i = 0; i < Dimension; i++) {
     elem_[i] /= s;
   }
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Negation() const {
-  Vector<Dimension> ret;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T> Vector<Dimension, T>::Negation() const {
+  Vector ret;
   for (int i = 0; i < Dimension; i++) {
     ret.elem_[i] = -elem_[i];
   }
   return ret;
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Product(const Vector& v0,
-                                             const Vector& v1) {
-  Vector<Dimension> ret;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T> Vector<Dimension, T>::Product(const Vector& v0,
+                                                             const Vector& v1) {
+  Vector ret;
   for (int i = 0; i < Dimension; i++) {
     ret.elem_[i] = v0[i] * v1[i];
   }
   return ret;
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Sum(const Vector& v0, const Vector& v1) {
-  Vector<Dimension> ret;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T> Vector<Dimension, T>::Sum(const Vector& v0,
+                                                         const Vector& v1) {
+  Vector ret;
   for (int i = 0; i < Dimension; i++) {
     ret.elem_[i] = v0[i] + v1[i];
   }
   return ret;
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Difference(const Vector& v0,
-                                                const Vector& v1) {
-  Vector<Dimension> ret;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T> Vector<Dimension, T>::Difference(
+    const Vector& v0, const Vector& v1) {
+  Vector ret;
   for (int i = 0; i < Dimension; i++) {
     ret.elem_[i] = v0[i] - v1[i];
   }
   return ret;
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Scale(const Vector& v, double s) {
-  Vector<Dimension> ret;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T> Vector<Dimension, T>::Scale(const Vector& v,
+                                                           T s) {
+  Vector ret;
   for (int i = 0; i < Dimension; i++) {
     ret.elem_[i] = v[i] * s;
   }
   return ret;
 }
 
-template <int Dimension>
-Vector<Dimension> Vector<Dimension>::Divide(const Vector& v, double s) {
-  Vector<Dimension> ret;
+template <int Dimension, typename T>
+constexpr Vector<Dimension, T> Vector<Dimension, T>::Divide(const Vector& v,
+                                                            T s) {
+  Vector ret;
   for (int i = 0; i < Dimension; i++) {
     ret.elem_[i] = v[i] / s;
   }
@@ -225,6 +238,8 @@ Vector<Dimension> Vector<Dimension>::Divide(const Vector& v, double s) {
 
 typedef Vector<3> Vector3;
 typedef Vector<4> Vector4;
+typedef Vector<3, float> Vector3f;
+typedef Vector<4, float> Vector4f;
 
 }  // namespace cardboard
 
@@ -17,21 +17,20 @@
 
 namespace cardboard {
 
-// Returns the dot (inner) product of two Vectors.
-double Dot(const Vector<3>& v0, const Vector<3>& v1) {
-  return v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2];
-}
-
-// Returns the dot (inner) product of two Vectors.
-double Dot(const Vector<4>& v0, const Vector<4>& v1) {
-  return v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2] + v0[3] * v1[3];
-}
-
-// Returns the 3-dimensional cross product of 2 Vectors. Note that this is
-// defined only for 3-dimensional Vectors.
-Vector<3> Cross(const Vector<3>& v0, const Vector<3>& v1) {
-  return Vector<3>(v0[1] * v1[2] - v0[2] * v1[1], v0[2] * v1[0] - v0[0] * v1[2],
-                   v0[0] * v1[1] - v0[1] * v1[0]);
-}
+// The functions are defined in the header so that they can be inlined and
+// evaluated at compile time. They are instantiated here for the scalar types
+// used by the SDK so that both precisions are compiled with the library.
+template double Dot(const Vector<3, double>& v0, const Vector<3, double>& v1);
+template double Dot(const Vector<4, double>& v0, const Vector<4, double>& v1);
+template float Dot(const Vector<3, float>& v0, const Vector<3, float>& v1);
+template float Dot(const Vector<4, float>& v0, const Vector<4, float>& v1);
+template Vector<3, double> Cross(const Vector<3, double>& v0,
+                                 const Vector<3, double>& v1);
+template Vector<3, float> Cross(const Vector<3, float>& v0,
+                                const Vector<3, float>& v1);
+template Vector<3, double> Normalized(const Vector<3, double>& v);
+template Vector<4, double> Normalized(const Vector<4, double>& v);
+template Vector<3, float> Normalized(const Vector<3, float>& v);
+template Vector<4, float> Normalized(const Vector<4, float>& v);
 
 }  // namespace cardboard
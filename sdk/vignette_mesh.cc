@@ -0,0 +1,276 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vignette_mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include "compact_mesh.h"
+
+namespace cardboard {
+
+namespace {
+
+float Cross(const std::array<float, 2>& a, const std::array<float, 2>& b) {
+  return a[0] * b[1] - a[1] * b[0];
+}
+
+float Dot(const std::array<float, 2>& a, const std::array<float, 2>& b) {
+  return a[0] * b[0] + a[1] * b[1];
+}
+
+std::array<float, 2> Subtract(const std::array<float, 2>& a,
+                              const std::array<float, 2>& b) {
+  return {a[0] - b[0], a[1] - b[1]};
+}
+
+// Returns the vertices of the boundary of the triangle strip @p indices in
+// order along it, or an empty vector when the boundary is not a single loop.
+// An edge is on the boundary when it belongs to a single triangle.
+std::vector<uint16_t> TraceBoundary(const uint16_t* indices, int n_indices) {
+  const auto edge_key = [](uint16_t a, uint16_t b) {
+    return a < b ? (static_cast<uint32_t>(a) << 16) | b
+                 : (static_cast<uint32_t>(b) << 16) | a;
+  };
+  std::unordered_map<uint32_t, int> edge_triangle_count;
+  for (int i = 2; i < n_indices; i++) {
+    const uint16_t a = indices[i - 2];
+    const uint16_t b = indices[i - 1];
+    const uint16_t c = indices[i];
+    // Degenerate triangles join the rows of the strip.
+    if (a == b || b == c || a == c) {
+      continue;
+    }
+    edge_triangle_count[edge_key(a, b)]++;
+    edge_triangle_count[edge_key(b, c)]++;
+    edge_triangle_count[edge_key(c, a)]++;
+  }
+
+  std::unordered_map<uint16_t, std::vector<uint16_t>> neighbors;
+  size_t boundary_edge_count = 0;
+  for (const auto& [key, count] : edge_triangle_count) {
+    if (count != 1) {
+      continue;
+    }
+    const uint16_t a = static_cast<uint16_t>(key >> 16);
+    const uint16_t b = static_cast<uint16_t>(key & 0xFFFF);
+    neighbors[a].push_back(b);
+    neighbors[b].push_back(a);
+    boundary_edge_count++;
+  }
+  if (neighbors.empty()) {
+    return {};
+  }
+  for (const auto& [vertex, vertex_neighbors] : neighbors) {
+    if (vertex_neighbors.size() != 2) {
+      return {};
+    }
+  }
+
+  std::vector<uint16_t> boundary{neighbors.begin()->first};
+  uint16_t previous = boundary.front();
+  uint16_t current = neighbors.at(previous)[0];
+  while (current != boundary.front()) {
+    if (boundary.size() == boundary_edge_count) {
+      return {};
+    }
+    boundary.push_back(current);
+    const std::vector<uint16_t>& current_neighbors = neighbors.at(current);
+    const uint16_t next = current_neighbors[0] == previous
+                              ? current_neighbors[1]
+                              : current_neighbors[0];
+    previous = current;
+    current = next;
+  }
+  if (boundary.size() != boundary_edge_count) {
+    return {};
+  }
+  return boundary;
+}
+
+// Returns the normalized short of the position component @p value in the
+// position scale @p scale.
+int16_t Normalize(float value, float scale) {
+  return static_cast<int16_t>(
+      std::lround(std::min(std::max(value / scale, -1.0f), 1.0f) *
+                  CompactMesh::kNormalizedOne));
+}
+
+// Builds the vignette of @p eye. Returns false when @p mesh does not lie on
+// the half of the viewport of @p eye or is not star-shaped around the
+// centroid of its boundary.
+bool BuildEyeVignette(CardboardEye eye, const CardboardCompactMesh& mesh,
+                      std::vector<int16_t>* vertices,
+                      std::vector<uint16_t>* indices) {
+  std::vector<uint16_t> boundary = TraceBoundary(mesh.indices, mesh.n_indices);
+  if (boundary.size() < 3) {
+    return false;
+  }
+
+  const float x_min = eye == kLeft ? -1.0f : 0.0f;
+  const float x_max = eye == kLeft ? 0.0f : 1.0f;
+  const float y_min = -1.0f;
+  const float y_max = 1.0f;
+
+  // The points are only used to lay out the vignette. Its boundary vertices
+  // are copied from the mesh.
+  const float scale = mesh.position_scale / CompactMesh::kNormalizedOne;
+  std::vector<std::array<float, 2>> points(boundary.size());
+  std::array<float, 2> center{0.0f, 0.0f};
+  for (size_t i = 0; i < boundary.size(); i++) {
+    points[i] = {mesh.vertices[boundary[i] * 4] * scale,
+                 mesh.vertices[boundary[i] * 4 + 1] * scale};
+    if (points[i][0] < x_min || points[i][0] > x_max ||
+        points[i][1] < y_min || points[i][1] > y_max) {
+      return false;
+    }
+    center[0] += points[i][0];
+    center[1] += points[i][1];
+  }
+  center[0] /= points.size();
+  center[1] /= points.size();
+
+  // The boundary is walked counterclockwise, and every edge of it must turn
+  // counterclockwise around the center for the rays to not cross the mesh
+  // boundary more than once.
+  float twice_area = 0.0f;
+  for (size_t i = 0; i < points.size(); i++) {
+    twice_area += Cross(points[i], points[(i + 1) % points.size()]);
+  }
+  if (twice_area < 0.0f) {
+    std::reverse(boundary.begin(), boundary.end());
+    std::reverse(points.begin(), points.end());
+  }
+  std::vector<std::array<float, 2>> rays(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    rays[i] = Subtract(points[i], center);
+  }
+  for (size_t i = 0; i < rays.size(); i++) {
+    if (Cross(rays[i], rays[(i + 1) % rays.size()]) <= 0.0f) {
+      return false;
+    }
+  }
+
+  // The corners of the half of the viewport come first, followed by each
+  // boundary vertex and the point where its ray leaves the half. Compact
+  // meshes have a position scale of at least 1, so the points on the border of
+  // the half are in range.
+  const int16_t eye_component =
+      eye == kLeft ? 0 : static_cast<int16_t>(CompactMesh::kNormalizedOne);
+  const auto add_point = [&](const std::array<float, 2>& point) {
+    vertices->insert(vertices->end(),
+                     {Normalize(point[0], mesh.position_scale),
+                      Normalize(point[1], mesh.position_scale), eye_component,
+                      0});
+  };
+  const std::array<std::array<float, 2>, 4> corners{{{x_min, y_min},
+                                                     {x_max, y_min},
+                                                     {x_max, y_max},
+                                                     {x_min, y_max}}};
+  vertices->clear();
+  for (const std::array<float, 2>& corner : corners) {
+    add_point(corner);
+  }
+  for (size_t i = 0; i < points.size(); i++) {
+    vertices->insert(vertices->end(), {mesh.vertices[boundary[i] * 4],
+                                       mesh.vertices[boundary[i] * 4 + 1],
+                                       eye_component, 0});
+    const std::array<float, 2>& ray = rays[i];
+    float t = std::numeric_limits<float>::infinity();
+    if (ray[0] != 0.0f) {
+      t = std::min(t, ((ray[0] > 0.0f ? x_max : x_min) - center[0]) / ray[0]);
+    }
+    if (ray[1] != 0.0f) {
+      t = std::min(t, ((ray[1] > 0.0f ? y_max : y_min) - center[1]) / ray[1]);
+    }
+    add_point({center[0] + t * ray[0], center[1] + t * ray[1]});
+  }
+
+  // Between two consecutive rays, the vignette is the convex polygon bounded
+  // by the boundary edge, the rays and the border of the half, which is
+  // triangulated as a fan around the first boundary vertex.
+  indices->clear();
+  for (size_t i = 0; i < points.size(); i++) {
+    const size_t j = (i + 1) % points.size();
+    std::vector<std::pair<float, uint16_t>> wedge_corners;
+    for (uint16_t k = 0; k < corners.size(); k++) {
+      const std::array<float, 2> corner_ray = Subtract(corners[k], center);
+      if (Cross(rays[i], corner_ray) > 0.0f &&
+          Cross(corner_ray, rays[j]) > 0.0f) {
+        wedge_corners.emplace_back(std::atan2(Cross(rays[i], corner_ray),
+                                              Dot(rays[i], corner_ray)),
+                                   k);
+      }
+    }
+    std::sort(wedge_corners.begin(), wedge_corners.end());
+
+    const uint16_t boundary_i = static_cast<uint16_t>(4 + 2 * i);
+    const uint16_t boundary_j = static_cast<uint16_t>(4 + 2 * j);
+    std::vector<uint16_t> fan{static_cast<uint16_t>(boundary_i + 1)};
+    for (const auto& [angle, corner] : wedge_corners) {
+      fan.push_back(corner);
+    }
+    fan.push_back(static_cast<uint16_t>(boundary_j + 1));
+    fan.push_back(boundary_j);
+    for (size_t k = 1; k < fan.size(); k++) {
+      indices->insert(indices->end(), {boundary_i, fan[k - 1], fan[k]});
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+VignetteMesh::VignetteMesh() : position_scale_{1.0f, 1.0f} {}
+
+void VignetteMesh::SetEyeMesh(CardboardEye eye,
+                              const CardboardCompactMesh& mesh) {
+  if (!BuildEyeVignette(eye, mesh, &eye_vertices_[eye], &eye_indices_[eye])) {
+    eye_vertices_[eye].clear();
+    eye_indices_[eye].clear();
+  }
+  position_scale_[eye] = mesh.position_scale;
+  Pack();
+}
+
+void VignetteMesh::Pack() {
+  vertices_.clear();
+  indices_.clear();
+
+  const size_t left_vertex_count =
+      eye_vertices_[kLeft].size() / kComponentsPerVertex;
+  const size_t right_vertex_count =
+      eye_vertices_[kRight].size() / kComponentsPerVertex;
+  if (eye_indices_[kLeft].empty() || eye_indices_[kRight].empty() ||
+      left_vertex_count + right_vertex_count > CompactMesh::kMaxVertices) {
+    return;
+  }
+
+  vertices_ = eye_vertices_[kLeft];
+  vertices_.insert(vertices_.end(), eye_vertices_[kRight].begin(),
+                   eye_vertices_[kRight].end());
+  const uint16_t right_offset = static_cast<uint16_t>(left_vertex_count);
+  indices_ = eye_indices_[kLeft];
+  for (uint16_t index : eye_indices_[kRight]) {
+    indices_.push_back(index + right_offset);
+  }
+}
+
+}  // namespace cardboard
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CARDBOARD_SDK_VIGNETTE_MESH_H_
+#define CARDBOARD_SDK_VIGNETTE_MESH_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "include/cardboard.h"
+
+namespace cardboard {
+
+// Builds the triangles that cover the part of the viewport that the compact
+// distortion meshes of both eyes do not cover, so that the distortion pass
+// can fill it with black instead of clearing the whole viewport.
+//
+// The vignette of an eye joins each vertex of the boundary of its mesh to the
+// point where the ray from the center of the mesh through the vertex leaves
+// the half of the viewport of the eye. It requires the mesh to lie on that
+// half and to be star-shaped around its center, which holds for the meshes of
+// radial distortions. Indices are triangles, both eyes packed together.
+//
+// Each vertex has x and y normalized short components in the position scale
+// of its eye, like the vertices of StereoMesh, followed by an eye component,
+// 0 for the left eye and CompactMesh::kNormalizedOne for the right eye, and by
+// a padding component that keeps vertices 4-byte aligned. The boundary
+// vertices are copied from the compact meshes, so that a shader that computes
+// positions like the one of StereoMesh draws the edges they share with the
+// meshes exactly over the mesh edges.
+class VignetteMesh {
+ public:
+  // Number of 16-bit components per vertex.
+  static constexpr int kComponentsPerVertex = 4;
+  // Offset in bytes of the eye component of a vertex.
+  static constexpr int kEyeOffset = 2 * sizeof(int16_t);
+
+  VignetteMesh();
+
+  // Builds the vignette of @p eye from @p mesh and packs both eyes again.
+  void SetEyeMesh(CardboardEye eye, const CardboardCompactMesh& mesh);
+
+  // Tells whether the vignette covers what the meshes do not. It is false
+  // until both meshes are set, or when the vignette of a mesh cannot be built.
+  bool IsValid() const { return !indices_.empty(); }
+
+  const std::vector<int16_t>& GetVertices() const { return vertices_; }
+  const std::vector<uint16_t>& GetIndices() const { return indices_; }
+  float GetPositionScale(CardboardEye eye) const {
+    return position_scale_[eye];
+  }
+
+ private:
+  void Pack();
+
+  std::array<std::vector<int16_t>, 2> eye_vertices_;
+  std::array<std::vector<uint16_t>, 2> eye_indices_;
+  std::array<float, 2> position_scale_;
+
+  std::vector<int16_t> vertices_;
+  std::vector<uint16_t> indices_;
+};
+
+}  // namespace cardboard
+
+#endif  // CARDBOARD_SDK_VIGNETTE_MESH_H_